@@ -1,6 +1,8 @@
 #pragma once
 
+#include <stdarg.h>
 #include <stdint.h>
+#include <stdio.h>
 
 #include "tracy/Tracy.hpp"
 #include "glm/gtx/matrix_transform_2d.hpp"
@@ -14,15 +16,28 @@
         statement;           \
     } while (false)
 
-#if BF_DEBUG
+#if BF_DEBUG && defined(_MSC_VER)
 #    define BREAKPOINT STATEMENT({ __debugbreak(); })
+#elif BF_DEBUG
+#    define BREAKPOINT STATEMENT({ __builtin_trap(); })
 #else
 #    define BREAKPOINT ((void*)0)
 #endif
 
+// NOTE: На linux `sys/param.h` (тянется через tracy) определяет свои MIN / MAX.
+#undef MAX
+#undef MIN
 #define MAX(a, b) (((a) > (b)) ? (a) : (b))
 #define MIN(a, b) (((a) < (b)) ? (a) : (b))
 
+// NOTE: SSE2 есть на любом x86-64. На остальных платформах работает скалярный код.
+#if defined(__SSE2__) || defined(_M_X64)
+#    define BF_SSE2 1
+#    include <emmintrin.h>
+#else
+#    define BF_SSE2 0
+#endif
+
 #if BF_DEBUG
 static constexpr auto DEBUG_MAX_LEN = 512;
 
@@ -36,7 +51,11 @@ void DEBUG_Error(const char* text, ...) {
     buf[MIN(n, DEBUG_MAX_LEN - 1)]     = '\n';
     buf[MIN(n + 1, DEBUG_MAX_LEN - 1)] = '\0';
 
+#if _WIN32
     ::OutputDebugStringA(buf);
+#else
+    fputs(buf, stderr);
+#endif
     va_end(args);
 }
 
@@ -50,7 +69,11 @@ void DEBUG_Print(const char* text, ...) {
     buf[MIN(n, DEBUG_MAX_LEN - 1)]     = '\n';
     buf[MIN(n + 1, DEBUG_MAX_LEN - 1)] = '\0';
 
+#if _WIN32
     ::OutputDebugStringA(buf);
+#else
+    fputs(buf, stderr);
+#endif
     va_end(args);
 }
 
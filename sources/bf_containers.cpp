@@ -75,47 +75,197 @@ struct Fixed_Size_Slice {
     }
 };
 
+// NOTE: Кольцевой буфер поверх заранее выделенной памяти.
+// `max_count` должен быть степенью двойки.
+// Элемент `i` лежит в `base[(head + i) & (max_count - 1)]`.
 template <typename T>
 struct Fixed_Size_Queue {
+    i32 count     = 0;
+    u32 head      = 0;
+    u32 max_count = 0;
+    T*  base      = nullptr;
+
+    T* Enqueue() {
+        Assert(Is_Power_Of_2(max_count));
+        Assert((u32)count < max_count);
+
+        auto result = base + ((head + count) & (max_count - 1));
+        count++;
+        return result;
+    }
+
+    T Dequeue() {
+        Assert(base != nullptr);
+        Assert(count > 0);
+
+        T result = base[head];
+        head     = (head + 1) & (max_count - 1);
+        count--;
+
+        return result;
+    }
+};
+
+// NOTE: Бинарная min-куча поверх заранее выделенной памяти.
+// Для `T` должен быть определён `operator<`.
+template <typename T>
+struct Fixed_Size_Binary_Heap {
     size_t memory_size = 0;
     i32    count       = 0;
     T*     base        = nullptr;
 
-    T* Enqueue() {
+    void Push(const T& value) {
         Assert(memory_size >= (count + 1) * sizeof(T));
-        auto result = base + count;
+
+        auto i = count;
         count++;
+
+        while (i > 0) {
+            auto parent = (i - 1) / 2;
+            if (!(value < base[parent]))
+                break;
+
+            base[i] = base[parent];
+            i       = parent;
+        }
+
+        base[i] = value;
+    }
+
+    T Pop() {
+        Assert(base != nullptr);
+        Assert(count > 0);
+
+        T result = base[0];
+        count--;
+
+        if (count > 0) {
+            T   last = base[count];
+            i32 i    = 0;
+
+            while (true) {
+                auto child = 2 * i + 1;
+                if (child >= count)
+                    break;
+
+                if (child + 1 < count && base[child + 1] < base[child])
+                    child++;
+
+                if (!(base[child] < last))
+                    break;
+
+                base[i] = base[child];
+                i       = child;
+            }
+
+            base[i] = last;
+        }
+
         return result;
     }
+};
 
-    // PERF: Переписать на ring buffer! Много memmove происходит.
-    T Dequeue() {
+// NOTE: Бинарная min-куча с уменьшением ключа.
+// У `T` должны быть `operator<` и поле `id` - индекс в `positions`.
+// Каждый id лежит в куче не больше одного раза, поэтому `max_count` - число id.
+// Лежит ли id в куче, знает вызывающий: `positions` для остальных id не валидны.
+template <typename T>
+struct Indexed_Binary_Heap {
+    i32  max_count = 0;
+    i32  count     = 0;
+    T*   base      = nullptr;
+    i32* positions = nullptr;
+
+    void Push(const T& value) {
+        Assert(count < max_count);
+        Sift_Up(count, value);
+        count++;
+    }
+
+    // NOTE: `value` должен быть не больше того, что лежит в куче под этим id.
+    void Decrease(const T& value) {
+        auto i = positions[value.id];
+        Assert(i >= 0);
+        Assert(i < count);
+        Assert(base[i].id == value.id);
+        Assert(!(base[i] < value));
+
+        Sift_Up(i, value);
+    }
+
+    T Pop() {
         Assert(base != nullptr);
         Assert(count > 0);
 
-        T result = *base;
+        T result = base[0];
         count--;
-        if (count > 0)
-            memmove((void*)base, (void*)(base + 1), sizeof(T) * count);
+
+        if (count > 0) {
+            T   last = base[count];
+            i32 i    = 0;
+
+            while (true) {
+                auto child = 2 * i + 1;
+                if (child >= count)
+                    break;
+
+                if (child + 1 < count && base[child + 1] < base[child])
+                    child++;
+
+                if (!(base[child] < last))
+                    break;
+
+                Set(i, base[child]);
+                i = child;
+            }
+
+            Set(i, last);
+        }
 
         return result;
     }
+
+private:
+    void Set(i32 i, const T& value) {
+        base[i]             = value;
+        positions[value.id] = i;
+    }
+
+    void Sift_Up(i32 i, const T& value) {
+        while (i > 0) {
+            auto parent = (i - 1) / 2;
+            if (!(value < base[parent]))
+                break;
+
+            Set(i, base[parent]);
+            i = parent;
+        }
+
+        Set(i, value);
+    }
 };
 
-// PERF: Переписать на ring buffer!
+// NOTE: Кольцевой буфер. `max_count` - всегда степень двойки.
+// Элемент `i` лежит в `base[(head + i) & (max_count - 1)]`.
 template <typename T>
 struct Queue {
     T*  base      = nullptr;
     i32 count     = 0;
     u32 max_count = 0;
+    u32 head      = 0;
 
     Allocator_function((*allocator_)) = nullptr;
     void* allocator_data_             = nullptr;
 
+    T& At(i32 i) {
+        Assert(i >= 0);
+        Assert(i < count);
+        return base[(head + i) & (max_count - 1)];
+    }
+
     i32 Index_Of(const T& value) {
         FOR_RANGE (i32, i, count) {
-            auto& v = base[i];
-            if (v == value)
+            if (At(i) == value)
                 return i;
         }
 
@@ -129,74 +279,76 @@ struct Queue {
             Assert(max_count == 0);
             Assert(count == 0);
             max_count = 8;
+            head      = 0;
             base      = (T*)ALLOC(sizeof(T) * max_count);
         }
-        else if (max_count == count) {
+        else if (max_count == (u32)count) {
             u32 new_max_count = max_count * 2;
             Assert(max_count < new_max_count);  // NOTE: Ловим overflow
 
-            auto new_base = (T*)ALLOC(sizeof(T) * new_max_count);
-            memcpy((void*)new_base, (void*)base, sizeof(T) * max_count);
-            FREE(base, sizeof(T) * max_count);
-
-            base      = new_base;
-            max_count = new_max_count;
+            Reallocate_Linearly(new_max_count, allocator, allocator_data);
         }
 
         count++;
-        return base + (count - 1);
+        return base + ((head + count - 1) & (max_count - 1));
     }
 
+    // NOTE: Возвращает `values_count` подряд идущих слотов.
+    // Если хвост упирается в конец буфера, элементы сдвигаются в его начало.
     T* Bulk_Enqueue(const u32 values_count, MCTX) {
         CONTAINER_MEMBER_ALLOCATOR;
 
-        // TODO: Test!
         if (base == nullptr) {
             Assert(max_count == 0);
             Assert(count == 0);
 
             max_count = MAX(Ceil_To_Power_Of_2(values_count), 8);
+            head      = 0;
             base      = (T*)ALLOC(sizeof(T) * max_count);
         }
         else if (max_count < count + values_count) {
             u32 new_max_count = Ceil_To_Power_Of_2(max_count + values_count);
             Assert(max_count < new_max_count);  // NOTE: Ловим overflow
 
-            auto new_base = (T*)ALLOC(sizeof(T) * new_max_count);
-            memcpy((void*)new_base, (void*)base, sizeof(T) * count);
-            FREE(base, sizeof(T) * max_count);
-
-            base      = new_base;
-            max_count = new_max_count;
+            Reallocate_Linearly(new_max_count, allocator, allocator_data);
         }
+        else if (count == 0)
+            head = 0;
+        else if (((head + count) & (max_count - 1)) + values_count > max_count)
+            Linearize();
 
+        auto result = base + ((head + count) & (max_count - 1));
         count += values_count;
 
-        return base + (count - values_count);
+        return result;
     }
 
-    // PERF: Много memmove происходит
     T Dequeue() {
         Assert(base != nullptr);
         Assert(count > 0);
 
-        T result = *base;
+        T result = base[head];
+        head     = (head + 1) & (max_count - 1);
         count--;
-        if (count > 0)
-            memmove(base, base + 1, sizeof(T) * count);
 
         return result;
     }
 
+    // NOTE: Порядок остальных элементов сохраняется.
+    // Сдвигается меньшая из двух частей очереди.
     void Remove_At(i32 i) {
         Assert(i >= 0);
         Assert(i < count);
 
-        i32 delta_count = count - i - 1;
-        Assert(delta_count >= 0);
+        if (i < count / 2) {
+            for (i32 k = i; k > 0; k--)
+                At(k) = At(k - 1);
 
-        if (delta_count > 0) {
-            memmove(base + i, base + i + 1, sizeof(T) * delta_count);
+            head = (head + 1) & (max_count - 1);
+        }
+        else {
+            for (i32 k = i; k < count - 1; k++)
+                At(k) = At(k + 1);
         }
 
         count--;
@@ -204,6 +356,39 @@ struct Queue {
 
     void Reset() {
         count = 0;
+        head  = 0;
+    }
+
+private:
+    // NOTE: Сдвигает элементы так, чтобы `head` стал 0.
+    void Linearize() {
+        if (head == 0)
+            return;
+
+        // NOTE: Поворот массива на `head` тремя разворотами.
+        Array_Reverse(base, (i32)head);
+        Array_Reverse(base + head, (i32)(max_count - head));
+        Array_Reverse(base, (i32)max_count);
+        head = 0;
+    }
+
+    void Reallocate_Linearly(
+        u32                  new_max_count,
+        Allocator_function_t allocator,
+        void*                allocator_data
+    ) {
+        auto new_base = (T*)ALLOC(sizeof(T) * new_max_count);
+
+        auto first_part = MIN((u32)count, max_count - head);
+        memcpy((void*)new_base, (void*)(base + head), sizeof(T) * first_part);
+        memcpy(
+            (void*)(new_base + first_part), (void*)base, sizeof(T) * (count - first_part)
+        );
+        FREE(base, sizeof(T) * max_count);
+
+        base      = new_base;
+        max_count = new_max_count;
+        head      = 0;
     }
 };
 
@@ -419,19 +604,89 @@ struct Memory_Buffer {
     }
 };
 
+// NOTE: Младшие биты id - индекс слота сущности, старшие - поколение слота
+// (см. `Entity_Slots`). Разреженные индексы строятся по индексу слота.
+#define SPARSE_INDEX_BITS 22
+
+BF_FORCE_INLINE u32 Sparse_Index_Of(u32 id) {
+    return id & ((1u << SPARSE_INDEX_BITS) - 1);
+}
+
+// NOTE: Номер сущности -> позиция её id в плотном массиве.
+// При удалении записи не чистятся. Позиция считается валидной,
+// только если в плотном массиве по ней лежит тот же id.
+struct Sparse_Index {
+    i32* slots     = nullptr;
+    u32  max_count = 0;
+
+    template <typename T>
+    i32 Find(const T id, const T* ids, i32 count) const {
+        auto index = Sparse_Index_Of(id);
+        if (index >= max_count)
+            return -1;
+
+        auto slot = slots[index];
+        if (slot < 0 || slot >= count || ids[slot] != id)
+            return -1;
+
+        return slot;
+    }
+
+    template <typename T>
+    void Set(const T id, i32 slot, MCTX) {
+        auto index = Sparse_Index_Of(id);
+        if (index >= max_count)
+            Enlarge(index + 1, ctx);
+
+        slots[index] = slot;
+    }
+
+    void Enlarge(u32 min_count, MCTX) {
+        CTX_ALLOCATOR;
+
+        u32 new_max_count = MAX(Ceil_To_Power_Of_2(min_count), 64);
+        Assert(max_count < new_max_count);
+
+        auto new_slots = rcast<i32*>(ALLOC(sizeof(i32) * new_max_count));
+        memset(new_slots, 0xFF, sizeof(i32) * new_max_count);
+
+        if (slots != nullptr) {
+            memcpy(new_slots, slots, sizeof(i32) * max_count);
+            FREE(slots, sizeof(i32) * max_count);
+        }
+
+        slots     = new_slots;
+        max_count = new_max_count;
+    }
+
+    void Deinit(MCTX) {
+        CTX_ALLOCATOR;
+
+        if (slots != nullptr)
+            FREE(slots, sizeof(i32) * max_count);
+
+        slots     = nullptr;
+        max_count = 0;
+    }
+};
+
 template <typename T>
 struct Sparse_Array_Of_Ids {
     T*  ids       = nullptr;
     i32 count     = 0;
     i32 max_count = 0;
 
-    T* Add(MCTX) {
+    Sparse_Index sparse = {};
+
+    void Add(const T id, MCTX) {
+        Assert(!Contains(id));
+
         if (max_count == count)
             Enlarge(ctx);
 
-        auto result = ids + count;
+        ids[count] = id;
+        sparse.Set(id, count, ctx);
         count++;
-        return result;
     }
 
     T Pop() {
@@ -441,24 +696,19 @@ struct Sparse_Array_Of_Ids {
     }
 
     void Unstable_Remove(const T id) {
-        FOR_RANGE (i32, i, count) {
-            if (ids[i] == id) {
-                if (i != count - 1)
-                    std::swap(ids[i], ids[count - 1]);
+        auto i = sparse.Find(id, ids, count);
+        Assert(i >= 0);
 
-                count--;
-                return;
-            }
+        if (i != count - 1) {
+            ids[i]                                = ids[count - 1];
+            sparse.slots[Sparse_Index_Of(ids[i])] = i;
         }
-        Assert(false);
+
+        count--;
     }
 
     bool Contains(const T& id) {
-        FOR_RANGE (int, i, count) {
-            if (ids[i] == id)
-                return true;
-        }
-        return false;
+        return sparse.Find(id, ids, count) >= 0;
     }
 
     void Enlarge(MCTX) {
@@ -488,6 +738,8 @@ struct Sparse_Array_Of_Ids {
     }
 };
 
+// NOTE: Плотные массивы `ids` и `base` + разреженный индекс по номеру сущности.
+// `Find`, `Contains` и `Unstable_Remove` работают за O(1).
 template <typename T, typename U>
 struct Sparse_Array {
     T*  ids       = nullptr;
@@ -495,24 +747,29 @@ struct Sparse_Array {
     i32 count     = 0;
     i32 max_count = 0;
 
-    std::tuple<T*, U*> Add(MCTX) {
+    Sparse_Index sparse = {};
+
+    std::tuple<T*, U*> Add(const T id, MCTX) {
         Assert(count >= 0);
         Assert(max_count >= 0);
+        Assert(!Contains(id));
 
         if (max_count == count)
             Enlarge(ctx);
 
+        ids[count] = id;
+        sparse.Set(id, count, ctx);
+
         std::tuple<T*, U*> result = {ids + count, base + count};
         count++;
         return result;
     }
 
     U* Find(const T id) {
-        FOR_RANGE (i32, i, count) {
-            if (ids[i] == id)
-                return base + i;
-        }
-        return nullptr;
+        auto i = sparse.Find(id, ids, count);
+        if (i < 0)
+            return nullptr;
+        return base + i;
     }
 
     // TODO: Подумать о целесообразности.
@@ -528,25 +785,22 @@ struct Sparse_Array {
     }
 
     void Unstable_Remove(const T id) {
-        FOR_RANGE (i32, i, count) {
-            if (ids[i] == id) {
-                if (i != count - 1) {
-                    ids[i]  = ids[count - 1];
-                    base[i] = base[count - 1];
-                }
-                count--;
-                return;
-            }
+        auto i = sparse.Find(id, ids, count);
+        if (i < 0) {
+            INVALID_PATH;
+            return;
         }
-        INVALID_PATH;
+
+        if (i != count - 1) {
+            ids[i]                                = ids[count - 1];
+            base[i]                               = base[count - 1];
+            sparse.slots[Sparse_Index_Of(ids[i])] = i;
+        }
+        count--;
     }
 
     bool Contains(const T id) {
-        FOR_RANGE (int, i, count) {
-            if (ids[i] == id)
-                return true;
-        }
-        return false;
+        return sparse.Find(id, ids, count) >= 0;
     }
 
     void Enlarge(MCTX) {
@@ -586,9 +840,9 @@ struct Sparse_Array {
 // ----- Array Functions -----
 
 template <typename T>
-i32 Array_Find(T* values, u32 n, T& value) {
+i32 Array_Find(T* values, u32 n, const T& value) {
     FOR_RANGE (u32, i, n) {
-        auto& v = *(values + n);
+        auto& v = *(values + i);
         if (v == value)
             return i;
     }
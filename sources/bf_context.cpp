@@ -1,3 +1,5 @@
+struct Arena;
+
 struct Context {
     u32 thread_index = {};
 
@@ -7,6 +9,8 @@ struct Context {
     void*     logger_data          = {};
     void_func logger_routine       = {};  // NOTE: Logger_function_t
     void_func logger_scope_routine = {};  // NOTE: Logger_Scope_function_t
+
+    Arena* scratch_arena = {};  // NOTE: Своя у каждого воркера джоб системы.
 };
 
 #define MCTX Context* ctx
@@ -8,8 +8,13 @@ Debug_Load_File(const char* filename, u8* output, size_t output_max_bytes, MCTX)
 
     const auto path = filename;
 
-    FILE* file   = nullptr;
-    auto  failed = fopen_s(&file, path, "rb");
+    FILE* file = nullptr;
+#if _WIN32
+    auto failed = fopen_s(&file, path, "rb");
+#else
+    file        = fopen(path, "rb");
+    auto failed = file == nullptr;
+#endif
 
     Assert(!failed);
     if (failed) {
@@ -36,6 +41,9 @@ Debug_Load_File(const char* filename, u8* output, size_t output_max_bytes, MCTX)
 
 Debug_Load_File_Result
 Debug_Load_File_To_Arena(const char* filename, Arena& arena, MCTX) {
+    // NOTE: Файл читается прямо в свободное место арены.
+    Assert(arena.virtual_memory == nullptr);
+
     auto res = Debug_Load_File(
         filename, arena.base + arena.used, arena.size - arena.used, ctx
     );
@@ -1,17 +1,29 @@
-#include "imgui.h"
-#include "imgui_impl_opengl3.h"
-#include "imgui_impl_win32.h"
+#if BF_CLIENT
+#    include "imgui.h"
+#    include "imgui_impl_opengl3.h"
+#    include "imgui_impl_win32.h"
+#endif
 #ifndef WIN32_LEAN_AND_MEAN
 #    define WIN32_LEAN_AND_MEAN
 #endif
 
+#include <cstdarg>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <limits>
 #include <source_location>
 #include <memory>
 #include <concepts>
+#include <algorithm>
+#include <atomic>
+#include <bit>
 
-#include "glew.h"
-#include "wglew.h"
+#if BF_CLIENT
+#    include "glew.h"
+#    include "wglew.h"
+#endif
 
 #include "bf_base.h"
 #include "bf_game.h"
@@ -50,6 +62,7 @@ Library_Integration_Data* global_library_integration_data = nullptr;
 #endif
 // NOLINTEND(bugprone-suspicious-include)
 
+#if BF_CLIENT
 bool UI_Clicked(Game& game) {
     auto& world    = game.world;
     auto& renderer = *game.renderer;
@@ -262,15 +275,33 @@ void Process_Events(
         }
     }
 }
+#endif
+
+// NOTE: Адресное пространство дешёвое, так что резервируем с запасом,
+// чтобы виртуальным аренам хватало на карты любого размера.
+#define VIRTUAL_ARENA_RESERVE_SIZE Gigabytes((size_t)8)
 
+// NOTE: При переинициализации с тем же размером мира арены ложатся на те же адреса,
+// и `zeroed_size` остаётся верным. Если же арена сдвинулась, там может лежать
+// что угодно от соседних арен.
 void Map_Arena(Arena& root_arena, Arena& arena_to_map, size_t size) {
-    arena_to_map.base = Allocate_Array(root_arena, u8, size);
+    auto base = Allocate_Cache_Aligned_Array(root_arena, u8, size);
+    if (arena_to_map.base != base || arena_to_map.size != size)
+        arena_to_map.zeroed_size = 0;
+
+    arena_to_map.base = base;
     arena_to_map.size = size;
 }
 
+// NOTE: Обнуляется только то, куда писали с прошлого сброса (см. `zeroed_size`).
+// Память виртуальной арены выше `keep_committed` вместо этого отдаётся OS
+// и при следующем коммите приходит уже нулевой.
 void Reset_Arena(Arena& arena) {
-    memset(arena.base, 0, arena.size);
     arena.used = 0;
+    Trim_Arena(arena);
+
+    memset(arena.base, 0, arena.size - arena.zeroed_size);
+    arena.zeroed_size = arena.size;
 }
 
 const BFGame::Game_Library*
@@ -286,10 +317,14 @@ Load_Game_Library(Arena* arena_p, Arena* trash_arena_p, MCTX) {
     return result;
 }
 
+// NOTE: Рендер перерисует клетку, когда заберёт снапшот с ней.
 On_Item_Built_function(On_Item_Built) {
-#if BF_CLIENT
-    Renderer_OnItemBuilt(game, pos, item, ctx);
-#endif
+    UNUSED(item);
+
+    if (game.render_snapshots != nullptr) {
+        auto tile = Make_Render_Dirty_Tile(game.world, pos);
+        Add_Render_Snapshot_Dirty_Tile(*game.render_snapshots, tile, ctx);
+    }
 }
 
 On_Human_Created_function(On_Human_Created) {
@@ -304,6 +339,209 @@ On_Human_Removed_function(On_Human_Removed) {
 #endif
 }
 
+// NOTE: (Пере)инициализация мира. Используется как `Game_Update_And_Render`,
+// так и хостами, которые гоняют симуляцию без рендера.
+void Initialize_Game(
+    Game_Memory& memory,
+    Arena&       root_arena,
+    bool         first_time_initializing,
+    MCTX
+) {
+    CTX_LOGGER;
+
+    auto& game        = memory.game;
+    auto& editor_data = game.editor_data;
+
+    editor_data.changed = false;
+
+    // NOTE: Сколько воркеров джоб системы хоста может занять игра (`Parallel_For`).
+    game.threads_count = 1;
+    if (global_library_integration_data != nullptr) {
+        auto workers_count = global_library_integration_data->jobs_workers_count;
+        game.threads_count = MAX((u32)1, workers_count);
+    }
+
+    const auto gsize       = editor_data.world_size;
+    const auto tiles_count = (size_t)gsize.x * gsize.y;
+
+    // NOTE: Тайлы мира, состояние `Find_Path` и буферы обхода графа (`graph_trace`)
+    // живут в `non_persistent_arena`. В `trash_arena` `Update_Tiles` кладёт
+    // только списки сегментов. На дефолтной карте 32x24 обе арены по мегабайту.
+    auto trash_arena_size = MAX(
+        Megabytes((size_t)1), tiles_count * (4 * sizeof(Graph_Segment) + 64)
+    );
+    auto non_persistent_arena_size = MAX(Megabytes((size_t)1), tiles_count * 256);
+
+    // NOTE: `arena` remains the same after hot reloading. Others get reset
+    auto& arena                = game.arena;
+    auto& non_persistent_arena = game.non_persistent_arena;
+    auto& trash_arena          = game.trash_arena;
+
+    // NOTE: Если хост умеет резервировать память, `non_persistent_arena` и
+    // `trash_arena` растут сами, а оценки выше - лишь то, что остаётся закоммиченным
+    // после сброса. Иначе они нарезаются из `root_arena` ровно по оценкам.
+    const OS_Virtual_Memory* virtual_memory = nullptr;
+    if (global_library_integration_data != nullptr)
+        virtual_memory = global_library_integration_data->virtual_memory;
+
+    if (virtual_memory != nullptr) {
+        Map_Arena(
+            root_arena, arena, root_arena.size - root_arena.used - CACHE_LINE_ALIGNMENT
+        );
+
+        if (non_persistent_arena.virtual_memory == nullptr) {
+            Reserve_Virtual_Arena(
+                non_persistent_arena, *virtual_memory, VIRTUAL_ARENA_RESERVE_SIZE, 0
+            );
+            Reserve_Virtual_Arena(
+                trash_arena, *virtual_memory, VIRTUAL_ARENA_RESERVE_SIZE, 0
+            );
+        }
+        non_persistent_arena.keep_committed = non_persistent_arena_size;
+        trash_arena.keep_committed          = trash_arena_size;
+    }
+    else {
+        // NOTE: Каждая арена начинается с cache line, на padding оставляем запас.
+        auto arena_size = root_arena.size - root_arena.used - non_persistent_arena_size
+                          - trash_arena_size - 3 * CACHE_LINE_ALIGNMENT;
+
+        Map_Arena(root_arena, arena, arena_size);
+        Map_Arena(root_arena, non_persistent_arena, non_persistent_arena_size);
+        Map_Arena(root_arena, trash_arena, trash_arena_size);
+    }
+
+    if (first_time_initializing)
+        game.gamelib = Load_Game_Library(&arena, &trash_arena, ctx);
+
+    Reset_Arena(non_persistent_arena);
+    Reset_Arena(trash_arena);
+
+    game.arena.debug_name           = "arena";
+    non_persistent_arena.debug_name = Text_Format_To_Arena(
+        non_persistent_arena, "non_persistent_arena_%d", game.dll_reloads_count
+    );
+    trash_arena.debug_name = Text_Format_To_Arena(
+        non_persistent_arena, "trash_arena_%d", game.dll_reloads_count
+    );
+
+    Initialize_As_Zeros<World>(game.world);
+    game.world.size = gsize;
+
+    game.world.terrain_tiles
+        = Allocate_Zeros_Array(non_persistent_arena, Terrain_Tile, tiles_count);
+    game.world.terrain_resources
+        = Allocate_Zeros_Array(non_persistent_arena, Terrain_Resource, tiles_count);
+    game.world.element_tiles
+        = Allocate_Zeros_Array(non_persistent_arena, Element_Tile, tiles_count);
+    game.world.segment_owners
+        = Allocate_Array(non_persistent_arena, Graph_Segment_ID, 4 * tiles_count);
+    FOR_RANGE (size_t, i, 4 * tiles_count) {
+        game.world.segment_owners[i] = Graph_Segment_ID_Missing;
+    }
+
+    if (first_time_initializing) {
+        auto resources = game.gamelib->resources();
+
+        auto new_resources
+            = Allocate_Array(arena, Scriptable_Resource, resources->size());
+
+        FOR_RANGE (int, i, resources->size()) {
+            auto  resource     = resources->Get(i);
+            auto& new_resource = new_resources[i];
+            new_resource.code  = resource->code()->c_str();
+        }
+
+        game.scriptable_resources_count = resources->size();
+        game.scriptable_resources       = new_resources;
+    }
+
+    // Инициализация scriptable_buildings.
+    auto s = game.gamelib->buildings()->size();
+    game.scriptable_buildings
+        = Allocate_Zeros_Array(non_persistent_arena, Scriptable_Building, s);
+    game.scriptable_buildings_count = s;
+    FOR_RANGE (int, i, s) {
+        auto& building    = game.scriptable_buildings[i];
+        auto& libbuilding = *game.gamelib->buildings()->Get(i);
+
+        building.code                 = libbuilding.code()->c_str();
+        building.type                 = (Building_Type)libbuilding.type();
+        building.harvestable_resource = nullptr;
+
+        building.human_spawning_delay  //
+            = libbuilding.human_spawning_delay();
+        building.construction_points  //
+            = libbuilding.construction_points();
+
+        building.can_be_built = libbuilding.can_be_built();
+
+        if (libbuilding.construction_resources() != nullptr) {
+            FOR_RANGE (int, i, libbuilding.construction_resources()->size()) {
+                auto resource = libbuilding.construction_resources()->Get(i);
+                auto code     = resource->resource_code()->c_str();
+                auto count    = resource->count();
+
+                Scriptable_Resource* scriptable_resource = nullptr;
+                FOR_RANGE (int, k, game.scriptable_resources_count) {
+                    auto res = game.scriptable_resources + k;
+                    if (strcmp(res->code, code) == 0) {
+                        scriptable_resource = res;
+                        break;
+                    }
+                }
+
+                Assert(scriptable_resource != nullptr);
+                *building.construction_resources.Vector_Occupy_Slot(ctx)
+                    = {scriptable_resource, count};
+            }
+        }
+    }
+
+    Init_World(
+        first_time_initializing, game.hot_reloaded, game, non_persistent_arena, ctx
+    );
+#if BF_CLIENT
+    if (first_time_initializing) {
+        game.render_snapshots = Allocate_For(arena, Render_Snapshots);
+        Init_Render_Snapshots(*game.render_snapshots);
+    }
+
+    Init_Renderer(
+        first_time_initializing,
+        game.hot_reloaded,
+        game,
+        arena,
+        non_persistent_arena,
+        trash_arena,
+        ctx
+    );
+#endif
+
+    Regenerate_Terrain_Tiles(
+        game, game.world, non_persistent_arena, trash_arena, 0, editor_data, ctx
+    );
+    Regenerate_Element_Tiles(
+        game, game.world, non_persistent_arena, trash_arena, 0, editor_data, ctx
+    );
+
+    Post_Init_World(
+        first_time_initializing, game.hot_reloaded, game, non_persistent_arena, ctx
+    );
+#if BF_CLIENT
+    Post_Init_Renderer(
+        first_time_initializing,
+        game.hot_reloaded,
+        game,
+        arena,
+        non_persistent_arena,
+        trash_arena,
+        ctx
+    );
+#endif
+
+    memory.is_initialized = true;
+}
+
 // f32                       dt
 // void*                     memory_ptr
 // size_t                    memory_size
@@ -324,6 +562,10 @@ extern "C" GAME_LIBRARY_EXPORT Game_Update_And_Render_function(Game_Update_And_R
     ZoneScoped;
     global_library_integration_data = &library_integration_data;
 
+    // NOTE: Симуляция получает полный `dt` кадра (см. `Simulation_Clock`),
+    // остальное (ввод, рендер) - ограниченный.
+    auto frame_dt = dt;
+
     const float MAX_DT = 1.0f / (f32)10;
     if (dt > MAX_DT)
         dt = MAX_DT;
@@ -348,19 +590,24 @@ extern "C" GAME_LIBRARY_EXPORT Game_Update_And_Render_function(Game_Update_And_R
         std::construct_at(root_allocator);
     }
 
+#if BF_CLIENT
     if (!library_integration_data.game_context_set) {
         SCOPED_LOG_INIT("Setting ImGui context");
 
         ImGui::SetCurrentContext(library_integration_data.imgui_context);
         library_integration_data.game_context_set = true;
     }
+#endif
 
     auto& editor_data = game.editor_data;
 
     // --- IMGUI ---
-    if (first_time_initializing)
+    if (first_time_initializing) {
         editor_data = Default_Editor_Data();
+        game.clock  = Default_Simulation_Clock();
+    }
 
+#if BF_CLIENT
     if (!first_time_initializing) {
         auto& renderer = Assert_Deref(game.renderer);
         ImGui::Text("Mouse %d.%d", renderer.mouse_pos.x, renderer.mouse_pos.y);
@@ -417,7 +664,12 @@ extern "C" GAME_LIBRARY_EXPORT Game_Update_And_Render_function(Game_Update_And_R
         if (ImGui::SliderInt("Forest MaxAmount", &editor_data.forest_max_amount, 1, 35)) {
             editor_data.changed = true;
         }
+
+        auto speed = (int)game.clock.speed;
+        if (ImGui::SliderInt("Simulation Speed", &speed, 1, 16))
+            game.clock.speed = (u32)speed;
     }
+#endif
     // --- IMGUI END ---
 
     if (!first_time_initializing && game.hot_reloaded) {
@@ -429,142 +681,10 @@ extern "C" GAME_LIBRARY_EXPORT Game_Update_And_Render_function(Game_Update_And_R
         SCOPED_LOG_INIT(
             "first_time_initializing || editor_data.changed || game.hot_reloaded"
         );
-        editor_data.changed = false;
-
-        auto trash_arena_size          = Megabytes((size_t)1);
-        auto non_persistent_arena_size = Megabytes((size_t)1);
-        auto arena_size = root_arena.size - root_arena.used - non_persistent_arena_size
-                          - trash_arena_size;
-
-        // NOTE: `arena` remains the same after hot reloading. Others get reset
-        auto& arena                = game.arena;
-        auto& non_persistent_arena = game.non_persistent_arena;
-        auto& trash_arena          = game.trash_arena;
-
-        Map_Arena(root_arena, arena, arena_size);
-        Map_Arena(root_arena, non_persistent_arena, non_persistent_arena_size);
-        Map_Arena(root_arena, trash_arena, trash_arena_size);
-
-        if (first_time_initializing)
-            game.gamelib = Load_Game_Library(&arena, &trash_arena, ctx);
-
-        Reset_Arena(non_persistent_arena);
-        Reset_Arena(trash_arena);
-
-        game.arena.debug_name           = "arena";
-        non_persistent_arena.debug_name = Text_Format_To_Arena(
-            non_persistent_arena, "non_persistent_arena_%d", game.dll_reloads_count
-        );
-        trash_arena.debug_name = Text_Format_To_Arena(
-            non_persistent_arena, "trash_arena_%d", game.dll_reloads_count
-        );
-
-        Initialize_As_Zeros<World>(game.world);
-        game.world.size = {32, 24};
-        auto& gsize     = game.world.size;
-
-        auto tiles_count = (size_t)gsize.x * gsize.y;
-        game.world.terrain_tiles
-            = Allocate_Zeros_Array(non_persistent_arena, Terrain_Tile, tiles_count);
-        game.world.terrain_resources
-            = Allocate_Zeros_Array(non_persistent_arena, Terrain_Resource, tiles_count);
-        game.world.element_tiles
-            = Allocate_Zeros_Array(non_persistent_arena, Element_Tile, tiles_count);
-
-        if (first_time_initializing) {
-            auto resources = game.gamelib->resources();
-
-            auto new_resources
-                = Allocate_Array(arena, Scriptable_Resource, resources->size());
-
-            FOR_RANGE (int, i, resources->size()) {
-                auto  resource     = resources->Get(i);
-                auto& new_resource = new_resources[i];
-                new_resource.code  = resource->code()->c_str();
-            }
-
-            game.scriptable_resources_count = resources->size();
-            game.scriptable_resources       = new_resources;
-        }
-
-        // Инициализация scriptable_buildings.
-        auto s = game.gamelib->buildings()->size();
-        game.scriptable_buildings
-            = Allocate_Zeros_Array(non_persistent_arena, Scriptable_Building, s);
-        game.scriptable_buildings_count = s;
-        FOR_RANGE (int, i, s) {
-            auto& building    = game.scriptable_buildings[i];
-            auto& libbuilding = *game.gamelib->buildings()->Get(i);
-
-            building.code                 = libbuilding.code()->c_str();
-            building.type                 = (Building_Type)libbuilding.type();
-            building.harvestable_resource = nullptr;
-
-            building.human_spawning_delay  //
-                = libbuilding.human_spawning_delay();
-            building.construction_points  //
-                = libbuilding.construction_points();
-
-            building.can_be_built = libbuilding.can_be_built();
-
-            if (libbuilding.construction_resources() != nullptr) {
-                FOR_RANGE (int, i, libbuilding.construction_resources()->size()) {
-                    auto resource = libbuilding.construction_resources()->Get(i);
-                    auto code     = resource->resource_code()->c_str();
-                    auto count    = resource->count();
-
-                    Scriptable_Resource* scriptable_resource = nullptr;
-                    FOR_RANGE (int, k, game.scriptable_resources_count) {
-                        auto res = game.scriptable_resources + k;
-                        if (strcmp(res->code, code) == 0) {
-                            scriptable_resource = res;
-                            break;
-                        }
-                    }
-
-                    Assert(scriptable_resource != nullptr);
-                    *building.construction_resources.Vector_Occupy_Slot(ctx)
-                        = {scriptable_resource, count};
-                }
-            }
-        }
-
-        Init_World(
-            first_time_initializing, game.hot_reloaded, game, non_persistent_arena, ctx
-        );
-        Init_Renderer(
-            first_time_initializing,
-            game.hot_reloaded,
-            game,
-            arena,
-            non_persistent_arena,
-            trash_arena,
-            ctx
-        );
-
-        Regenerate_Terrain_Tiles(
-            game, game.world, non_persistent_arena, trash_arena, 0, editor_data, ctx
-        );
-        Regenerate_Element_Tiles(
-            game, game.world, non_persistent_arena, trash_arena, 0, editor_data, ctx
-        );
-
-        Post_Init_World(
-            first_time_initializing, game.hot_reloaded, game, non_persistent_arena, ctx
-        );
-        Post_Init_Renderer(
-            first_time_initializing,
-            game.hot_reloaded,
-            game,
-            arena,
-            non_persistent_arena,
-            trash_arena,
-            ctx
-        );
-
-        memory.is_initialized = true;
+        Initialize_Game(memory, root_arena, first_time_initializing, ctx);
     }
 
+#if BF_CLIENT
     if (game.renderer != nullptr && game.renderer->shaders_compilation_failed)
         ImGui::Text("ERROR: Shaders compilation failed!");
 
@@ -609,11 +729,35 @@ extern "C" GAME_LIBRARY_EXPORT Game_Update_And_Render_function(Game_Update_And_R
             (*pixel++) = (blue << 0) | (green << 8) | (red << 0);
         }
     }
+#endif
 
     auto& trash_arena = game.trash_arena;
+
+    // NOTE: Разовый всплеск (например, перестройка графа на большой карте)
+    // не должен держать память вечно. Порог вдвое выше `keep_committed`,
+    // чтобы не коммитить и не декоммитить одно и то же каждый кадр.
+    if (trash_arena.committed > 2 * Arena_Commit_Size(trash_arena.keep_committed))
+        Trim_Arena(trash_arena);
+
     TEMP_USAGE(trash_arena);
 
+#if BF_CLIENT
     Process_Events(game, (u8*)input_events_bytes_ptr, input_events_count, dt, ctx);
-    Update_World(game, dt, ctx);
+#endif
+
+    auto ticks   = Advance_Simulation_Clock(game.clock, frame_dt);
+    auto tick_dt = Simulation_Tick_Duration(game.clock);
+    FOR_RANGE (u32, _, ticks) {
+        TEMP_USAGE(trash_arena);
+        Update_World(game, tick_dt, ctx);
+    }
+
+    // NOTE: Симуляция и рендер пока в одном потоке - хватает снапшота раз за кадр.
+    if (game.render_snapshots != nullptr)
+        Publish_World_Snapshot(game, ctx);
+
+#if BF_CLIENT
+    Show_World_Debug_Info(game);
     Render(game, dt, ctx);
+#endif
 }
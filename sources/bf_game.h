@@ -1,4 +1,6 @@
 #pragma once
+#include <atomic>
+
 #include "bf_base.h"
 
 #define Kilobytes(value) ((value) * 1024)
@@ -53,6 +55,62 @@ struct ImGuiContext;
 #define OS_Get_Time_function(name_) double name_() noexcept
 #define OS_Die_function(name_) void name_() noexcept
 
+// --- VIRTUAL MEMORY START ---
+// NOTE: Резервирование адресов без физической памяти и (де)коммит страниц в них.
+// Используется виртуальными аренами (см. `Reserve_Virtual_Arena`).
+// Адреса и размеры в Commit/Decommit кратны `ARENA_COMMIT_GRANULARITY`.
+// После Decommit и повторного Commit страницы снова заполнены нулями.
+#define OS_Reserve_Memory_function(name_) void* name_(size_t size) noexcept
+#define OS_Commit_Memory_function(name_) bool name_(void* address, size_t size) noexcept
+#define OS_Decommit_Memory_function(name_) \
+    void name_(void* address, size_t size) noexcept
+#define OS_Release_Memory_function(name_) void name_(void* address, size_t size) noexcept
+
+struct OS_Virtual_Memory {
+    OS_Reserve_Memory_function((*Reserve))   = {};
+    OS_Commit_Memory_function((*Commit))     = {};
+    OS_Decommit_Memory_function((*Decommit)) = {};
+    OS_Release_Memory_function((*Release))   = {};
+};
+// --- VIRTUAL MEMORY END ---
+
+// --- JOBS START ---
+// NOTE: Джоб система живёт в хосте (см. `bf_jobs.cpp`).
+// Игра обязана дождаться всех своих задач до выхода из `Game_Update_And_Render`,
+// т.к. `routine` указывает в код DLL, которая может перезагрузиться.
+struct Context;
+struct Job_System;
+
+// NOTE: Обрабатывает элементы [begin, end).
+// `ctx` - контекст воркера со своим `thread_index` и `scratch_arena`.
+// Аллоцировать через `ctx` нельзя - отладочный аллокатор не потокобезопасен.
+#define Job_function(name_) \
+    void name_(void* data, u32 begin, u32 end, Context* ctx) noexcept
+
+// NOTE: Сколько элементов ещё не обработано.
+struct Job_Counter {
+    std::atomic<i32> value = 0;
+};
+
+// NOTE: Раздаёт [0, count) кусками не больше `grain` по воркерам.
+// Задача не начнётся, пока `dependency` (если задана) не обнулится.
+// `dependency` должен жить, пока задача не выполнится.
+#define Jobs_Submit_function(name_)      \
+    void name_(                          \
+        Job_System* system,              \
+        Job_function((*routine)),        \
+        void*        data,               \
+        u32          count,              \
+        u32          grain,              \
+        Job_Counter* counter,            \
+        Job_Counter* dependency          \
+    ) noexcept
+
+// NOTE: Вызывающий поток выполняет задачи, пока `counter` не обнулится.
+#define Jobs_Wait_function(name_) \
+    void name_(Job_System* system, Job_Counter* counter) noexcept
+// --- JOBS END ---
+
 struct GAME_LIBRARY_EXPORT Library_Integration_Data {
     bool          game_context_set  = {};
     ImGuiContext* imgui_context     = {};
@@ -66,6 +124,15 @@ struct GAME_LIBRARY_EXPORT Library_Integration_Data {
     OS_Write_To_File_function((*Write_To_File)) = {};
     OS_Get_Time_function((*Get_Time))           = {};
     OS_Die_function((*Die))                     = {};
+
+    Job_System* jobs               = {};
+    u32         jobs_workers_count = {};  // NOTE: Вместе с главным потоком.
+
+    Jobs_Submit_function((*Jobs_Submit)) = {};
+    Jobs_Wait_function((*Jobs_Wait))     = {};
+
+    // NOTE: Если хост его не задал, все арены нарезаются из `memory_ptr`.
+    const OS_Virtual_Memory* virtual_memory = {};
 };
 
 // --- EVENTS START ---
@@ -13,23 +13,76 @@ struct Renderer;
 struct Loaded_Texture;
 #endif
 
+struct World_Resource;
+struct Graph_Segment;
+
+// NOTE: Id сущности - хендл слота в `Entity_Slots`.
+// Младшие `ENTITY_INDEX_BITS` бит - индекс слота, следующие - поколение слота.
+// Поколение растёт при освобождении слота, так что протухшие id
+// не совпадают с id нового владельца слота.
+// Старший бит зарезервирован под `Entity_ID_Missing`.
+#define ENTITY_INDEX_BITS 22
+#define ENTITY_GENERATION_BITS 9
+
+// NOTE: Освободившиеся слоты переиспользуются не сразу, а только когда их
+// накопится столько. Иначе поколение одного слота быстро переполняется.
+#define ENTITY_SLOTS_MIN_FREE 1024
+
 using Entity_ID                   = u32;
 const Entity_ID Entity_ID_Missing = 1 << 31;
 
-constexpr Entity_ID Component_Mask(Entity_ID component_number) {
-    return component_number << 22;
+static_assert(ENTITY_INDEX_BITS + ENTITY_GENERATION_BITS == 31);
+// NOTE: `Sparse_Array` индексирует сущности по индексу слота.
+static_assert(ENTITY_INDEX_BITS == SPARSE_INDEX_BITS);
+
+constexpr u32 Entity_Index(Entity_ID id) {
+    return id & ((1u << ENTITY_INDEX_BITS) - 1);
+}
+
+constexpr u32 Entity_Generation(Entity_ID id) {
+    return (id >> ENTITY_INDEX_BITS) & ((1u << ENTITY_GENERATION_BITS) - 1);
+}
+
+constexpr Entity_ID Make_Entity_ID(u32 index, u32 generation) {
+    return index | (generation << ENTITY_INDEX_BITS);
+}
+
+// NOTE: Типизированный id, чтобы нельзя было перепутать,
+// например, id чувачка с id сегмента.
+template <typename T>
+struct Entity_Handle {
+    Entity_ID id = {};
+
+    bool operator==(const Entity_Handle& other) const = default;
+};
+
+template <typename T>
+BF_FORCE_INLINE u32 Sparse_Index_Of(Entity_Handle<T> handle) {
+    return Sparse_Index_Of(handle.id);
 }
 
+// NOTE: Слоты сущностей всех типов мира.
+// Индексы общие для всех типов - по ним живут, например, спрайты рендерера.
+struct Entity_Slots {
+    // NOTE: Текущее поколение каждого слота. 0 не используется,
+    // поэтому id `{}` никогда не бывает живым.
+    u16* generations = {};
+    u32  count       = {};
+    u32  max_count   = {};
+
+    Queue<u32> free = {};
+};
+
 using Player_ID = u8;
 
-using Human_ID                  = Entity_ID;
-const Human_ID Human_ID_Missing = Entity_ID_Missing;
+using Human_ID                  = Entity_Handle<Human>;
+const Human_ID Human_ID_Missing = {Entity_ID_Missing};
 
 using Human_Constructor_ID                              = Human_ID;
-const Human_Constructor_ID Human_Constructor_ID_Missing = Entity_ID_Missing;
+const Human_Constructor_ID Human_Constructor_ID_Missing = Human_ID_Missing;
 
-using Building_ID                     = Entity_ID;
-const Building_ID Building_ID_Missing = Entity_ID_Missing;
+using Building_ID                     = Entity_Handle<Building>;
+const Building_ID Building_ID_Missing = {Entity_ID_Missing};
 
 using Texture_ID                        = u32;
 constexpr Texture_ID Texture_ID_Missing = std::numeric_limits<Texture_ID>::max();
@@ -73,12 +126,18 @@ Direction Opposite(Direction dir) {
     return (Direction)(((u8)(dir) + 2) % 4);
 }
 
+// NOTE: Кратчайшие пути от вершинных клеток сегмента (флагов, зданий)
+// до каждой клетки его графа. Чувачки ходят только между вершинами и центром,
+// поэтому храним k×n строк, а не n×n (k - количество вершин, n - клеток).
 struct Calculated_Graph_Data {
+    u16 vertices_count = {};
+
+    // NOTE: Строка `vertex` - `dist[vertex * n + node]`.
     i16* dist = {};
+    // NOTE: Предыдущая клетка на кратчайшем пути от `vertex` до `node`.
     i16* prev = {};
 
-    std::unordered_map<u16, v2i16> node_index_2_pos = {};
-    std::unordered_map<v2i16, u16> pos_2_node_index = {};
+    v2i16* node_index_2_pos = {};  // NOTE: Позиции клеток относительно `graph.offset`.
 
     v2i16 center = {};
 };
@@ -172,7 +231,11 @@ const wchar_t* Graph_To_String(Graph& graph, Arena& arena) {
 void DEBUG_Print_Graph(Graph& graph, Arena& arena) {
     TEMP_USAGE(arena);
     auto res = Graph_To_String(graph, arena);
+#if _WIN32
     ::OutputDebugStringW(res);
+#else
+    fputws(res, stderr);
+#endif
 }
 
 BF_FORCE_INLINE bool Graph_Contains(const Graph& graph, v2i16 pos) {
@@ -198,11 +261,11 @@ struct Graph_Segment;
 // using World_Resource_ID = Bucket_Locator;
 // const World_Resource_ID No_World_Resource_ID(-1, -1);
 
-using Graph_Segment_ID                          = Entity_ID;
-const Graph_Segment_ID Graph_Segment_ID_Missing = Entity_ID_Missing;
+using Graph_Segment_ID                          = Entity_Handle<Graph_Segment>;
+const Graph_Segment_ID Graph_Segment_ID_Missing = {Entity_ID_Missing};
 
-using World_Resource_ID                           = Entity_ID;
-const World_Resource_ID World_Resource_ID_Missing = Entity_ID_Missing;
+using World_Resource_ID                           = Entity_Handle<World_Resource>;
+const World_Resource_ID World_Resource_ID_Missing = {Entity_ID_Missing};
 
 using World_Resource_Booking_ID                                   = u16;
 const World_Resource_Booking_ID World_Resource_Booking_ID_Missing = 0;
@@ -213,15 +276,11 @@ enum class World_Resource_Booking_Type {
 };
 
 struct World_Resource_Booking {
-    static const Entity_ID component_mask = Component_Mask(4);
-
     World_Resource_Booking_Type type        = {};
     Building_ID                 building_id = {};
 };
 
 struct World_Resource {
-    static const Entity_ID component_mask = Component_Mask(3);
-
     Scriptable_Resource* scriptable = {};
 
     v2i16 pos = {};
@@ -272,11 +331,7 @@ struct World_Resource {
 // 9)  BrFrB - это уже 2 разных сегмента. Первый - BrF, второй - FrB.
 //             При замене флага (F) на дорогу (r) эти 2 сегмента сольются в один - BrrrB.
 //
-using Graph_Segment_ID = u32;
-
 struct Graph_Segment {
-    static const Entity_ID component_mask = Component_Mask(1);
-
     u16 vertices_count = {};
     v2i16* vertices = {};  // NOTE: Вершинные клетки графа (флаги, здания)
 
@@ -288,6 +343,22 @@ struct Graph_Segment {
     Queue<World_Resource> resources_to_transport = {};
 };
 
+// NOTE: Сегменты, в вершинах которых есть клетка `pos`.
+// Из клетки выходит не больше 4 сегментов - по одному на направление.
+struct Vertex_Segments {
+    v2i16            pos         = {};
+    u8               count       = {};
+    Graph_Segment_ID segments[4] = {};
+};
+
+// NOTE: Хеш-таблица вершина -> сегменты. Открытая адресация,
+// линейное пробирование. Слот свободен, если в нём `count == 0`.
+struct Vertex_Segments_Index {
+    u32              count     = {};
+    u32              max_count = {};  // NOTE: Степень двойки.
+    Vertex_Segments* slots     = {};
+};
+
 struct Graph_Segment_Precalculated_Data {
     // TODO: Reimplement `CalculatedGraphPathData` calculation from the old repo
 };
@@ -332,7 +403,6 @@ void Graph_Update(Graph& graph, v2i16 pos, Direction dir, bool value) {
 }
 
 using Player_ID = u8;
-using Human_ID  = u32;
 
 enum class Building_Type {
     Undefined = 0,
@@ -367,6 +437,33 @@ enum class Human_Type {
     Employee,
 };
 
+// NOTE: Пути чувачков хранятся в `Path_Pool` цепочками блоков
+// по 2 бита (`Direction`) на шаг. Индекс блока 0 - "блока нет".
+#define PATH_BLOCK_BYTES 12
+#define PATH_BLOCK_STEPS (PATH_BLOCK_BYTES * 4)
+
+struct Path_Block {
+    u32 next                    = {};
+    u8  steps[PATH_BLOCK_BYTES] = {};
+};
+
+struct Path_Pool {
+    Path_Block* blocks    = {};
+    u32         count     = {};
+    u32         max_count = {};
+    u32         free_list = {};
+};
+
+// NOTE: Путь чувачка и курсор чтения по нему.
+// `Dequeue_Path_Tile` двигает только сам курсор, пул не меняется.
+struct Human_Path {
+    u32   first = {};  // NOTE: Начало цепочки блоков, для освобождения.
+    u32   block = {};  // NOTE: Блок с шагом от `next` до следующей клетки.
+    u32   step  = {};  // NOTE: Номер этого шага в блоке.
+    v2i16 next  = {};  // NOTE: Клетка, которую вернёт `Dequeue_Path_Tile`.
+    i32   count = {};  // NOTE: Сколько клеток осталось.
+};
+
 struct Human_Moving_Component {
     v2i16 pos      = {};
     f32   elapsed  = {};
@@ -374,7 +471,12 @@ struct Human_Moving_Component {
     v2f   from     = {};
 
     std::optional<v2i16> to   = {};
-    Queue<v2i16>         path = {};
+    Human_Path           path = {};
+
+    // NOTE: Используются при `Human_Movement_Backend::Timer_Wheel`.
+    // Тики `Human_Timer_Wheel`. `arrives_at` 0 - приход на `to` не запланирован.
+    u64 departed_at = {};
+    u64 arrives_at  = {};
 };
 
 enum class Moving_In_The_World_State {
@@ -552,8 +654,6 @@ struct Human_State {
 global_var Human_State human_states[(int)Human_States::COUNT] = {};
 
 struct Human {
-    static const Entity_ID component_mask = Component_Mask(1);
-
     Human_Moving_Component moving = {};
 
     Player_ID  player_id = {};
@@ -566,9 +666,70 @@ struct Human {
     Building_ID      building_id = {};
 };
 
-struct Building {
-    static const Entity_ID component_mask = Component_Mask(2);
+// NOTE: Горячие поля перемещения чувачков по колонкам (SoA),
+// используются только при `Human_Movement_Backend::Columns`.
+// i-й элемент каждой колонки относится к `world.humans.base[i]`.
+//
+// Каноничными остаются поля `Human::moving`, колонки - их теневая копия.
+// `Advance_Human_Movement` продвигает по ним сразу всех идущих чувачков,
+// а в `Human` результат переносится при обновлении чувачка.
+// Кто меняет `Human::moving` вне `Update_Humans`, ставит `dirty`.
+//
+// TODO: Чтобы колонки окупались, они должны стать единственным владельцем
+// `elapsed` и `progress`, а после ядра обновляться должны только дошедшие
+// до тайла чувачки. Для этого индекс колонки придётся протащить
+// через все колбэки состояний чувачков. Пока этого нет, бэкенд не дефолтный.
+struct Human_Movement_Columns {
+    f32* elapsed  = {};
+    f32* progress = {};
+    u32* moving   = {};  // NOTE: ~0u, если у чувачка есть `moving.to`.
+    u32* crossed  = {};  // NOTE: ~0u, если на этом тике чувачок дошёл до `moving.to`.
+
+    i32  count     = {};
+    i32  max_count = {};
+    bool dirty     = {};
+};
+
+enum class Human_Movement_Backend {
+    Scalar,       // NOTE: Каждый идущий чувачок продвигается в своём `Update_Human`.
+    Columns,      // NOTE: Каждый тик `Advance_Human_Movement` по всем идущим чувачкам.
+    Timer_Wheel,  // NOTE: Приход на следующий тайл - событие в `Human_Timer_Wheel`.
+};
+
+// NOTE: Иерархическое колесо таймеров прихода чувачков на следующий тайл.
+// Время идёт целыми тиками по `HUMAN_TIMER_WHEEL_TICK` секунд.
+//
+// Слот уровня `l` покрывает `HUMAN_TIMER_WHEEL_SLOTS^l` тиков. Таймер лежит
+// на самом нижнем уровне, в блоке которого находится и `now`. Когда `now`
+// заходит в слот верхнего уровня, его таймеры раскладываются по нижним.
+//
+// Таймеры не отменяются. Сработавший таймер сверяется
+// с `Human_Moving_Component::arrives_at`, устаревшие выбрасываются.
+// Индекс таймера 0 - "таймера нет".
+#define HUMAN_TIMER_WHEEL_TICK (1.0f / 1000.0f)
+#define HUMAN_TIMER_WHEEL_SLOTS_BITS 6
+#define HUMAN_TIMER_WHEEL_SLOTS (1 << HUMAN_TIMER_WHEEL_SLOTS_BITS)
+#define HUMAN_TIMER_WHEEL_LEVELS 4
+
+struct Human_Timer {
+    u32      next = {};
+    Human_ID id   = {};
+    u64      tick = {};
+};
+
+struct Human_Timer_Wheel {
+    u64 now       = {};
+    f32 remainder = {};  // NOTE: Доля тика, не вошедшая в `now`.
+
+    Human_Timer* timers    = {};
+    u32          count     = {};
+    u32          max_count = {};
+    u32          free_list = {};
 
+    u32 slots[HUMAN_TIMER_WHEEL_LEVELS][HUMAN_TIMER_WHEEL_SLOTS] = {};
+};
+
+struct Building {
     v2i16                pos        = {};
     Scriptable_Building* scriptable = {};
     Player_ID            player_id  = {};
@@ -585,22 +746,190 @@ struct World_Data {
     f32 human_moving_one_tile_duration = {};
 };
 
+struct Path_Find_Node {
+    i32   f   = {};
+    i32   g   = {};
+    v2i16 pos = {};
+
+    // NOTE: При равных `f` первым достаём узел, который дальше от старта.
+    bool operator<(const Path_Find_Node& other) const {
+        if (f != other.f)
+            return f < other.f;
+        return g > other.g;
+    }
+};
+
+// NOTE: Состояние `Find_Path`, которое переживает запросы.
+// Вместо очистки массивов перед каждым запросом увеличивается `generation`:
+//     stamps[i] <  generation     - тайл в текущем запросе не трогали
+//     stamps[i] == generation     - тайл в открытом списке
+//     stamps[i] == generation + 1 - тайл закрыт
+// `g` и `parents` валидны только для тронутых тайлов.
+struct Path_Find_Workspace {
+    u32  generation = {};
+    u32* stamps     = {};
+    i32* g          = {};
+    u8*  parents    = {};  // NOTE: 2 бита на тайл - `Direction` к родителю.
+
+    Fixed_Size_Binary_Heap<Path_Find_Node> open = {};
+};
+
+using Dir_v2i16 = std::tuple<Direction, v2i16>;
+
+// NOTE: Состояние трассировки сегментов (`Update_Tiles`), которое переживает вызовы.
+// Как и в `Path_Find_Workspace`, `visited` не очищается перед вызовом:
+// значение клетки валидно, только если `stamps[i] == generation`, иначе оно 0.
+//
+// `nodes` и `vertex_marks` между сегментами всегда нулевые - после каждого
+// сегмента зануляются только его клетки (по `segment_tiles` и `vertices`).
+// Очереди растут по мере надобности и не сжимаются,
+// так что их размер определяется самой большой правкой, а не картой.
+struct Graph_Trace_Workspace {
+    u32  generation = {};
+    u32* stamps     = {};
+    u8*  visited    = {};  // NOTE: Битовая маска пройденных `Direction`.
+
+    u8*    nodes         = {};
+    bool*  vertex_marks  = {};
+    v2i16* vertices      = {};
+    v2i16* segment_tiles = {};
+
+    Queue<Dir_v2i16> big_queue = {};
+    Queue<Dir_v2i16> queue     = {};
+};
+
+// NOTE: Поле расстояний до ближайшего из источников (Dijkstra от целей по всей карте).
+// С любого тайла следующий шаг к цели читается за O(1) из `directions`.
+struct Flow_Field {
+    v2i16 destination = {};
+    u32   version     = {};  // NOTE: `Flow_Field_Cache.version` на момент построения.
+    u32   last_used   = {};
+    i32*  dist        = {};  // NOTE: i32_max - цель недостижима.
+    u8*   directions  = {};  // NOTE: 2 бита на тайл - `Direction` следующего шага.
+};
+
+#define FLOW_FIELDS_CACHE_SIZE 8
+#define FLOW_FIELDS_MISSES_SIZE 32
+#define FLOW_FIELD_BUILD_AFTER_MISSES 3
+
+struct Flow_Field_Miss {
+    v2i16 destination = {};
+    i32   count       = {};
+};
+
+// NOTE: Поля для часто используемых целей (центры сегментов, стройки)
+// и одно общее поле до всех ратуш. Поля, построенные на старой `version`,
+// считаются невалидными и перестраиваются при следующем запросе.
+//
+// Поле строится по всей карте, поэтому пока к цели ходят редко,
+// дешевле ходить A*. Поле строится после `FLOW_FIELD_BUILD_AFTER_MISSES` промахов.
+struct Flow_Field_Cache {
+    u32 version = {};
+    u32 uses    = {};
+
+    Flow_Field city_halls                     = {};
+    Flow_Field fields[FLOW_FIELDS_CACHE_SIZE] = {};
+
+    u32             misses_version                  = {};
+    i32             misses_count                    = {};
+    Flow_Field_Miss misses[FLOW_FIELDS_MISSES_SIZE] = {};
+};
+
+enum class Path_Find_Backend {
+    Flat,          // NOTE: A* по тайлам всей карты.
+    Hierarchical,  // NOTE: HPA* по кластерам, см. `Path_Hierarchy`.
+};
+
+#define PATH_CLUSTER_SIZE 16
+#define PATH_CLUSTER_MAX_NODES 32
+
+// NOTE: Тайл на границе кластера, с которого можно перейти в соседний кластер.
+// На каждый непрерывный участок проходимой границы приходится один переход
+// (посередине участка), с обеих сторон границы.
+struct Path_Cluster_Node {
+    v2i16 pos   = {};
+    u8    exits = {};  // NOTE: Битовая маска `Direction` переходов в соседние кластеры.
+};
+
+struct Path_Cluster {
+    bool dirty       = {};
+    i32  nodes_count = {};
+
+    Path_Cluster_Node nodes[PATH_CLUSTER_MAX_NODES] = {};
+
+    // NOTE: Стоимость пути внутри кластера от `nodes[i]` до `nodes[j]`
+    // лежит в `costs[i * PATH_CLUSTER_MAX_NODES + j]`. u16_max - недостижимо.
+    u16 costs[PATH_CLUSTER_MAX_NODES * PATH_CLUSTER_MAX_NODES] = {};
+};
+
+struct Path_Abstract_Node {
+    i32 f  = {};
+    i32 g  = {};
+    u32 id = {};
+
+    bool operator<(const Path_Abstract_Node& other) const {
+        if (f != other.f)
+            return f < other.f;
+        return g > other.g;
+    }
+};
+
+// NOTE: Абстрактный граф переходов между кластерами для HPA*.
+// Узел `i` кластера `c` имеет id `c * PATH_CLUSTER_MAX_NODES + i`.
+// Начало и конец запроса получают два id после всех узлов кластеров.
+//
+// Кластеры, тайлы которых поменялись, помечаются `dirty`
+// и пересчитываются перед следующим запросом.
+struct Path_Hierarchy {
+    v2i16         clusters_size = {};
+    Path_Cluster* clusters      = {};
+
+    i32  dirty_count = {};
+    i32* dirty       = {};
+
+    // NOTE: Состояние поиска по абстрактному графу. См. `Path_Find_Workspace`.
+    u32  generation = {};
+    u32* stamps     = {};
+    i32* g          = {};
+    u32* parents    = {};
+
+    Indexed_Binary_Heap<Path_Abstract_Node> open = {};
+};
+
 struct World {
-    Entity_ID last_entity_id = {};
+    Entity_Slots entities = {};
 
     v2i16             size              = {};
     Terrain_Tile*     terrain_tiles     = {};
     Terrain_Resource* terrain_resources = {};
     Element_Tile*     element_tiles     = {};
 
+    // NOTE: Сегмент, которому принадлежит ребро графа, выходящее из клетки
+    // в направлении `dir` - `segment_owners[4 * tile_index + dir]`.
+    // В клетке-дороге все рёбра принадлежат одному сегменту,
+    // у вершинной клетки каждое направление может вести в свой сегмент.
+    Graph_Segment_ID* segment_owners = {};
+
     World_Data  data       = {};
     Human_Data* human_data = {};
 
+    Path_Find_Backend   path_find_backend   = {};
+    Path_Find_Workspace path_find_workspace = {};
+    Path_Hierarchy      path_hierarchy      = {};
+    Flow_Field_Cache    flow_fields         = {};
+
+    Vertex_Segments_Index vertex_segments = {};
+    Graph_Trace_Workspace graph_trace     = {};
+
     Sparse_Array<Graph_Segment_ID, Graph_Segment> segments                  = {};
     Sparse_Array<Building_ID, Building>           buildings                 = {};
     Sparse_Array_Of_Ids<Building_ID>              not_constructed_buildings = {};
     Sparse_Array<Building_ID, City_Hall>          city_halls                = {};
     Sparse_Array<Human_ID, Human>                 humans                    = {};
+    Human_Movement_Backend                        human_movement_backend    = {};
+    Human_Movement_Columns                        human_movement            = {};
+    Human_Timer_Wheel                             human_timers              = {};
+    Path_Pool                                     human_paths               = {};
     Sparse_Array_Of_Ids<Human_ID>                 humans_going_to_city_hall = {};
     // Sparse_Array<Human_ID, Human_Transporter>           transporters = {};
     // Sparse_Array<Human_ID, Human_Constructor>           constructors = {};
@@ -630,6 +959,8 @@ On_Human_Removed_function(On_Human_Removed);
 struct Editor_Data {
     bool changed = {};
 
+    v2i16 world_size = {};
+
     Perlin_Params terrain_perlin     = {};
     int           terrain_max_height = {};
 
@@ -641,6 +972,8 @@ struct Editor_Data {
 Editor_Data Default_Editor_Data() {
     Editor_Data result{};
 
+    result.world_size = {32, 24};
+
     result.terrain_perlin.octaves      = 9;
     result.terrain_perlin.scaling_bias = 2.0f;
     result.terrain_perlin.seed         = 0;
@@ -655,15 +988,98 @@ Editor_Data Default_Editor_Data() {
     return result;
 }
 
+// NOTE: Спрайт чувачка на момент тика. `progress` на время после тика
+// рендер досчитывает по `progress_per_second`.
+struct Human_Render_Transform {
+    Human_ID id                  = {};
+    v2i16    pos                 = {};
+    v2i16    to                  = {};  // NOTE: Совпадает с `pos`, если чувачок стоит.
+    f32      progress            = {};
+    f32      progress_per_second = {};
+};
+
+// NOTE: Клетка, на которой что-то построили, в том виде,
+// в каком она была сразу после постройки.
+struct Render_Dirty_Tile {
+    v2i16        pos  = {};
+    Element_Tile tile = {};
+
+    // NOTE: Только у зданий.
+    Scriptable_Building* scriptable         = {};
+    bool                 under_construction = {};
+};
+
+// NOTE: Всё, что рендеру нужно от симуляции за тик. Рендер его только читает.
+struct Render_Snapshot {
+    u64 version = {};  // NOTE: Номер публикации, растёт с каждым снапшотом.
+    f32 ahead   = {};  // NOTE: Сколько секунд прошло после тика к моменту публикации.
+
+    Human_Render_Transform* humans           = {};
+    i32                     humans_count     = {};
+    i32                     humans_max_count = {};
+
+    // NOTE: Клетки, на которых что-то построили после снапшота,
+    // который рендер забрал в прошлый раз. Идут в порядке постройки,
+    // рендер применяет их по очереди. Могут повторяться.
+    Render_Dirty_Tile* dirty_tiles           = {};
+    i32                dirty_tiles_count     = {};
+    i32                dirty_tiles_max_count = {};
+};
+
+// NOTE: Тройной буфер снапшотов между симуляцией (писатель) и рендером (читатель).
+// У писателя и читателя по своему буферу, третий лежит в `latest`.
+// Публикация и чтение - обмен своего буфера с `latest`, никто никого не ждёт.
+// Бит `RENDER_SNAPSHOT_FRESH` в `latest` - читатель этот снапшот ещё не забирал.
+#define RENDER_SNAPSHOT_FRESH 4u
+#define RENDER_SNAPSHOT_INDEX_MASK 3u
+
+struct Render_Snapshots {
+    Render_Snapshot buffers[3] = {};
+
+    std::atomic<u32> latest = {};
+    u32              write  = {};  // NOTE: Трогает только писатель.
+    u32              read   = {};  // NOTE: Трогает только читатель.
+};
+
+// NOTE: Симуляция идёт фиксированными тиками независимо от частоты кадров.
+// Кадр копит реальное время в `accumulator` и отрабатывает столько тиков,
+// сколько в нём набралось, но не больше `max_ticks_per_frame * speed`.
+// Время сверх этого выбрасывается - симуляция замедляется,
+// а не догоняет лавиной тиков.
+struct Simulation_Clock {
+    u32 ticks_per_second    = {};
+    u32 max_ticks_per_frame = {};
+    u32 speed               = {};  // NOTE: Ускорение - во сколько раз тиков больше.
+
+    f32 accumulator = {};  // NOTE: В тиках.
+    f32 alpha       = {};  // NOTE: Доля следующего тика, уже прошедшая к кадру.
+    u64 ticks       = {};
+};
+
+Simulation_Clock Default_Simulation_Clock() {
+    Simulation_Clock result{};
+
+    result.ticks_per_second    = 60;
+    result.max_ticks_per_frame = 8;
+    result.speed               = 1;
+
+    return result;
+}
+
 struct Game {
     bool hot_reloaded      = {};
     u16  dll_reloads_count = {};
+    u32  threads_count     = {};
 
     f32 offset_x = {};
     f32 offset_y = {};
 
-    v2f   player_pos = {};
-    World world      = {};
+    v2f              player_pos = {};
+    World            world      = {};
+    Simulation_Clock clock      = {};
+
+    // NOTE: Если задан, `Publish_World_Snapshot` пишет сюда снапшоты для рендера.
+    Render_Snapshots* render_snapshots = {};
 
     Editor_Data editor_data = {};
 
@@ -861,6 +1277,10 @@ struct Renderer {
     Texture_ID road_textures[16]            = {};
     Texture_ID flag_textures[4]             = {};
 
+    // NOTE: Тайлы мира глазами рендера. После инициализации
+    // меняются только по `Render_Snapshot::dirty_tiles`.
+    Element_Tile* element_tiles = {};
+
     Atlas atlas = {};
 
     int sprites_shader_gl2w_location = {};
@@ -0,0 +1,337 @@
+// NOTE: Джоб система с воровством задач.
+//
+// Живёт в хосте (win32_platform, linux_headless, tests), игре передаётся
+// через `Library_Integration_Data`. Потоки создаёт и держит хост,
+// поэтому перезагрузку DLL они переживают.
+//
+// У каждого воркера своя очередь. Владелец кладёт и берёт задачи с конца,
+// остальные воруют с начала. Диапазон длиннее `grain` лениво делится пополам:
+// верхняя половина уходит в очередь, где её может украсть простаивающий воркер.
+//
+// Воркер с индексом 0 - поток, который вызвал `Init_Job_System`.
+// Своего потока у него нет, он выполняет задачи внутри `Jobs_Wait`.
+//
+// Каждая положенная в очередь задача будит не больше одного спящего потока.
+// Поток, которому нечего украсть, засыпает на `wake` - и воркер,
+// и ждущий в `Jobs_Wait`. Последний будится ещё и обнулением своего счётчика.
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define JOB_DEQUE_MAX_COUNT 4096
+
+struct Job {
+    Job_function((*routine)) = {};
+    void*        data        = {};
+    u32          begin       = {};
+    u32          end         = {};
+    u32          grain       = {};
+    Job_Counter* counter     = {};
+};
+
+struct Job_Deque {
+    std::mutex mutex  = {};
+    Job*       jobs   = {};
+    u64        top    = {};  // NOTE: Отсюда воруют.
+    u64        bottom = {};  // NOTE: Сюда кладёт и отсюда берёт владелец.
+};
+
+struct Job_Worker {
+    Job_System* system        = {};
+    std::thread thread        = {};
+    Context     ctx           = {};
+    Arena       scratch_arena = {};
+    Job_Deque   deque         = {};
+};
+
+struct Pending_Job {
+    Job          job        = {};
+    Job_Counter* dependency = {};
+};
+
+struct Job_System {
+    u32         workers_count = {};
+    Job_Worker* workers       = {};
+
+    std::atomic<bool> quit         = {};
+    std::atomic<u32>  queued_count = {};
+
+    std::mutex              sleep_mutex    = {};
+    std::condition_variable wake           = {};
+    std::atomic<u32>        sleeping_count = {};
+
+    // NOTE: Задачи, чья зависимость ещё не обнулилась.
+    std::mutex               pending_mutex = {};
+    std::vector<Pending_Job> pending       = {};
+};
+
+thread_local u32 jobs_thread_index = 0;
+
+bool Job_Deque_Push(Job_Deque& deque, const Job& job) {
+    std::lock_guard lock(deque.mutex);
+    if (deque.bottom - deque.top >= JOB_DEQUE_MAX_COUNT)
+        return false;
+
+    deque.jobs[deque.bottom % JOB_DEQUE_MAX_COUNT] = job;
+    deque.bottom++;
+    return true;
+}
+
+bool Job_Deque_Pop(Job_Deque& deque, Job& job) {
+    std::lock_guard lock(deque.mutex);
+    if (deque.bottom == deque.top)
+        return false;
+
+    deque.bottom--;
+    job = deque.jobs[deque.bottom % JOB_DEQUE_MAX_COUNT];
+    return true;
+}
+
+bool Job_Deque_Steal(Job_Deque& deque, Job& job) {
+    std::lock_guard lock(deque.mutex);
+    if (deque.bottom == deque.top)
+        return false;
+
+    job = deque.jobs[deque.top % JOB_DEQUE_MAX_COUNT];
+    deque.top++;
+    return true;
+}
+
+// NOTE: Вызывается после изменения `queued_count` или счётчика задачи.
+// Спящий сначала увеличивает `sleeping_count`, потом проверяет условие,
+// а мы - наоборот, так что хотя бы один из нас увидит изменение другого.
+// Мьютекс берём, чтобы не потерять пробуждение потока,
+// который уже проверил условие, но ещё не уснул.
+void Jobs_Wake(Job_System& system, bool all) {
+    if (!system.sleeping_count.load())
+        return;
+
+    { std::lock_guard lock(system.sleep_mutex); }
+    if (all)
+        system.wake.notify_all();
+    else
+        system.wake.notify_one();
+}
+
+// NOTE: Засыпает, пока `predicate` ложен.
+template <typename T>
+void Jobs_Sleep(Job_System& system, T predicate) {
+    std::unique_lock lock(system.sleep_mutex);
+    system.sleeping_count.fetch_add(1);
+    system.wake.wait(lock, predicate);
+    system.sleeping_count.fetch_sub(1);
+}
+
+void Jobs_Execute(Job_System& system, Job_Worker& worker, Job job);
+
+// NOTE: Если очередь переполнена, задача выполняется на месте.
+void Jobs_Push(Job_System& system, Job_Worker& worker, const Job& job) {
+    system.queued_count.fetch_add(1);
+    if (Job_Deque_Push(worker.deque, job)) {
+        Jobs_Wake(system, false);
+        return;
+    }
+
+    system.queued_count.fetch_sub(1);
+    Jobs_Execute(system, worker, job);
+}
+
+// NOTE: Отпускает задачи, ждавшие обнулившийся `counter`.
+// Сам `counter` не разыменовывается - его владелец мог уже выйти из `Jobs_Wait`.
+void Jobs_Release_Pending(Job_System& system, Job_Worker& worker, Job_Counter* counter) {
+    std::vector<Job> ready{};
+    {
+        std::lock_guard lock(system.pending_mutex);
+        for (size_t i = 0; i < system.pending.size();) {
+            if (system.pending[i].dependency != counter) {
+                i++;
+                continue;
+            }
+
+            ready.push_back(system.pending[i].job);
+            system.pending[i] = system.pending.back();
+            system.pending.pop_back();
+        }
+    }
+
+    for (auto& job : ready)
+        Jobs_Push(system, worker, job);
+}
+
+void Jobs_Execute(Job_System& system, Job_Worker& worker, Job job) {
+    // NOTE: Ленивое деление диапазона.
+    while (job.end - job.begin > job.grain) {
+        auto upper  = job;
+        upper.begin = job.begin + (job.end - job.begin) / 2;
+
+        system.queued_count.fetch_add(1);
+        if (!Job_Deque_Push(worker.deque, upper)) {
+            system.queued_count.fetch_sub(1);
+            break;
+        }
+
+        Jobs_Wake(system, false);
+        job.end = upper.begin;
+    }
+
+    // NOTE: Всё, что задача взяла из scratch арены, освобождается после неё.
+    auto scratch_used = worker.scratch_arena.used;
+    job.routine(job.data, job.begin, job.end, &worker.ctx);
+    Assert(worker.scratch_arena.used >= scratch_used);
+    worker.scratch_arena.used = scratch_used;
+
+    // NOTE: Кто именно ждёт `counter`, неизвестно, поэтому будим всех спящих.
+    // Это происходит один раз на `Jobs_Submit`, а не на каждую половину диапазона.
+    auto counter = job.counter;
+    auto done    = (i32)(job.end - job.begin);
+    if (counter->value.fetch_sub(done) == done) {
+        Jobs_Release_Pending(system, worker, counter);
+        Jobs_Wake(system, true);
+    }
+}
+
+bool Jobs_Try_Execute_One(Job_System& system, Job_Worker& worker) {
+    Job job{};
+    bool found = Job_Deque_Pop(worker.deque, job);
+
+    auto index = (u32)(&worker - system.workers);
+    for (u32 i = 1; !found && i < system.workers_count; i++) {
+        auto& victim = system.workers[(index + i) % system.workers_count];
+        found        = Job_Deque_Steal(victim.deque, job);
+    }
+
+    if (!found)
+        return false;
+
+    system.queued_count.fetch_sub(1);
+    Jobs_Execute(system, worker, job);
+    return true;
+}
+
+void Jobs_Worker_Loop(Job_Worker& worker) {
+    auto& system      = *worker.system;
+    jobs_thread_index = worker.ctx.thread_index;
+
+    while (!system.quit.load()) {
+        if (Jobs_Try_Execute_One(system, worker))
+            continue;
+
+        Jobs_Sleep(system, [&system]() {
+            return system.queued_count.load() > 0 || system.quit.load();
+        });
+    }
+}
+
+Jobs_Submit_function(Jobs_Submit) {
+    Assert(routine != nullptr);
+    Assert(counter != nullptr);
+    Assert(jobs_thread_index < system->workers_count);
+
+    if (!count)
+        return;
+
+    counter->value.fetch_add((i32)count);
+
+    Job job{};
+    job.routine = routine;
+    job.data    = data;
+    job.begin   = 0;
+    job.end     = count;
+    job.grain   = MAX(grain, (u32)1);
+    job.counter = counter;
+
+    auto& worker = system->workers[jobs_thread_index];
+
+    if (dependency != nullptr) {
+        std::lock_guard lock(system->pending_mutex);
+        if (dependency->value.load() != 0) {
+            system->pending.push_back({job, dependency});
+            return;
+        }
+    }
+
+    Jobs_Push(*system, worker, job);
+}
+
+Jobs_Wait_function(Jobs_Wait) {
+    Assert(counter != nullptr);
+    Assert(jobs_thread_index < system->workers_count);
+
+    auto& worker = system->workers[jobs_thread_index];
+    while (counter->value.load() > 0) {
+        if (Jobs_Try_Execute_One(*system, worker))
+            continue;
+
+        Jobs_Sleep(*system, [system, counter]() {
+            return counter->value.load() <= 0 || system->queued_count.load() > 0;
+        });
+    }
+}
+
+// NOTE: `workers_count` учитывает и вызывающий поток.
+// Контексты воркеров - копии `ctx` со своим `thread_index` и `scratch_arena`.
+void Init_Job_System(
+    Job_System& system,
+    u32         workers_count,
+    size_t      scratch_arena_size,
+    MCTX
+) {
+    Assert(workers_count > 0);
+
+    system.workers_count = workers_count;
+    system.workers       = new Job_Worker[workers_count];
+
+    FOR_RANGE (u32, i, workers_count) {
+        auto& worker            = system.workers[i];
+        worker.system           = &system;
+        worker.ctx              = *ctx;
+        worker.ctx.thread_index = i;
+
+        worker.scratch_arena.debug_name = "job_worker_scratch_arena";
+        worker.scratch_arena.size       = scratch_arena_size;
+        worker.scratch_arena.base       = new u8[scratch_arena_size];
+        worker.ctx.scratch_arena        = &worker.scratch_arena;
+
+        worker.deque.jobs = new Job[JOB_DEQUE_MAX_COUNT];
+
+        // NOTE: Воркеры не логируют - логгер хоста не потокобезопасен.
+        if (i > 0) {
+            worker.ctx.logger_data          = nullptr;
+            worker.ctx.logger_routine       = nullptr;
+            worker.ctx.logger_scope_routine = nullptr;
+        }
+    }
+
+    jobs_thread_index = 0;
+
+    for (u32 i = 1; i < workers_count; i++) {
+        auto& worker  = system.workers[i];
+        worker.thread = std::thread(Jobs_Worker_Loop, std::ref(worker));
+    }
+}
+
+void Deinit_Job_System(Job_System& system) {
+    system.quit.store(true);
+    Jobs_Wake(system, true);
+
+    FOR_RANGE (u32, i, system.workers_count) {
+        auto& worker = system.workers[i];
+        if (worker.thread.joinable())
+            worker.thread.join();
+
+        delete[] worker.scratch_arena.base;
+        delete[] worker.deque.jobs;
+    }
+
+    delete[] system.workers;
+    system.workers       = nullptr;
+    system.workers_count = 0;
+}
+
+void Set_Job_System(Library_Integration_Data& data, Job_System& system) {
+    data.jobs               = &system;
+    data.jobs_workers_count = system.workers_count;
+    data.Jobs_Submit        = Jobs_Submit;
+    data.Jobs_Wait          = Jobs_Wait;
+}
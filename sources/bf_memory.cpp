@@ -561,7 +561,8 @@ private:
 // Если block_size ==  64 => аллоцирует 16384 байт (256 блоков)
 // Если block_size == 128 => аллоцирует 65536 байт (512 блоков)
 //
-// 1 блок (последний) всегда уходит на bookkeeping
+// 1 блок (последний) всегда уходит на bookkeeping:
+// в первой его половине биты занятости блоков, во второй - биты начала аллокаций.
 //
 //
 // Из презентации Andrei Alexandrescu:
@@ -573,58 +574,53 @@ private:
 //     - 1 bit/block sole overhead (!)
 //     - Multithreading tenuous (needs full interlocking for >1 block)
 //
-//     TODO: Я хз, как Andrei Alexandrescu бы это реализовывал
-//
-//     TODO: Зачекать paper https://arxiv.org/pdf/2110.10357.pdf
-//     "Fast Bitmap Fit: A CPU Cache Line friendly
-//      memory allocator for single object allocations"
+// NOTE: Свободные блоки ищутся по 64 бита за раз, как в paper
+// https://arxiv.org/pdf/2110.10357.pdf
+// "Fast Bitmap Fit: A CPU Cache Line friendly
+//  memory allocator for single object allocations".
+// Для аллокаций в один блок (основной случай) это один `countr_zero`
+// на каждые 64 блока. Для нескольких блоков подряд поиск прыгает
+// от начала свободного отрезка к его концу, тоже пословно.
 //
 template <class A, size_t block_size>
-class Bitmapped_Allocator {
+struct Bitmapped_Allocator {
+    static_assert(Is_Power_Of_2(block_size));
+    // NOTE: Каждая половина bookkeeping блока - целое число u64 слов.
+    static_assert(block_size >= 16);
+
     Blk Allocate(size_t n) {
-        static_assert(Is_Power_Of_2(block_size));
+        if (n == 0)
+            return Blk(nullptr, 0);
 
-        if (_blocks == nullptr) {
-            _blocks          = _parent.Allocate(Total_Blocks_Count());
-            _occupied        = _blocks + Last_Block_Offset();
-            _allocation_bits = _occupied + block_size / 2;
-            memset(_occupied, 0, block_size);
-        }
+        if (_blocks == nullptr && !Initialize())
+            return Blk(nullptr, 0);
 
         size_t required_blocks = Ceiled_Division(n, block_size);
 
-        size_t location = 0;
-        while (location <= Total_Blocks_Count() - required_blocks) {
-            size_t available = 0;
-            FOR_RANGE (size_t, i, required_blocks) {
-                if (QUERY_BIT(_occupied, i))
-                    break;
-
-                available++;
-            }
-
-            if (available == required_blocks) {
-                void* ptr = (void*)((u8*)_blocks + block_size * location);
+        auto location = Find_Bit(_occupied, 0, false);
+        while (location + required_blocks <= Last_Block_Offset()) {
+            auto run_end = location + 1;
+            if (required_blocks > 1)
+                run_end = Find_Bit(_occupied, location, true);
 
-                Assert(!QUERY_BIT(_allocation_bits, location));
-                MARK_BIT(_allocation_bits, location);
+            if (run_end - location >= required_blocks) {
+                Assert(!Query_Bit(_allocation_bits, location));
+                Mark_Bits(_allocation_bits, location, 1, true);
+                Mark_Bits(_occupied, location, required_blocks, true);
 
-                FOR_RANGE (size_t, i, required_blocks) {
-                    Assert(!QUERY_BIT(_occupied, location + i));
-                    MARK_BIT(_occupied, location + i);
-                }
-
-                return Blk(ptr, n);
+                return Blk(_blocks + block_size * location, n);
             }
-            else
-                location = location + available + 1;
+
+            location = Find_Bit(_occupied, run_end, false);
         }
 
         return Blk(nullptr, 0);
     }
 
     bool Owns(Blk b) {
-        return (b.ptr >= _blocks) && (b.ptr < _blocks + Last_Block_Offset());
+        auto ptr = (u8*)b.ptr;
+        return (_blocks != nullptr) && (ptr >= _blocks)
+               && (ptr < _blocks + block_size * Last_Block_Offset());
     }
 
     void Deallocate(Blk b) {
@@ -633,51 +629,131 @@ class Bitmapped_Allocator {
             return;
         }
 
-        size_t block = (b.ptr - _blocks) / block_size;
-        Assert(block < Total_Blocks_Count());
+        auto offset = (size_t)((u8*)b.ptr - _blocks);
+        auto block  = offset / block_size;
+        Assert(Owns(b));
 
         // Ensure this is the start of the allocation.
-        Assert(b.ptr % block_size == 0);
-        Assert(QUERY_BIT(_allocation_bits, block));
+        Assert(offset % block_size == 0);
+        Assert(Query_Bit(_allocation_bits, block));
+
+        auto blocks_count = Ceiled_Division(b.length, block_size);
+        Assert(Find_Bit(_allocation_bits, block + 1, true) >= block + blocks_count);
+        Assert(Find_Bit(_occupied, block, false) >= block + blocks_count);
 
-        // Unmarking allocation bit.
-        UNMARK_BIT(_allocation_bits, block);
+        Mark_Bits(_allocation_bits, block, 1, false);
+        Mark_Bits(_occupied, block, blocks_count, false);
+    }
 
-        // Unmarking occupied bits.
-        FOR_RANGE (size_t, i, Ceiled_Division(b.length, block_size)) {
-            Assert(QUERY_BIT(_occupied, block + i));
-            UNMARK_BIT(_occupied, block + i);
+    void Deallocate_All() {
+        if (_blocks == nullptr)
+            return;
 
-            Assert(!QUERY_BIT(_allocation_bits, block + i));
+        memset(_occupied, 0, block_size);
+        Mark_Bits(_occupied, Last_Block_Offset(), 1, true);
+    }
+
+    // NOTE: Сколько блоков занято аллокациями (без bookkeeping блока).
+    size_t Occupied_Blocks_Count() {
+        if (_blocks == nullptr)
+            return 0;
+
+        size_t result = 0;
+        FOR_RANGE (size_t, i, Words_Count()) {
+            result += std::popcount(_occupied[i]);
         }
+        return result - 1;
     }
 
     bool Sanity_Check() {
+        if (_blocks == nullptr)
+            return true;
+
         // У блоков, отмеченных в качестве начальных для аллокаций,
         // обязательно должно стоять значение в _occupied бите.
-        FOR_RANGE (size_t, i, Total_Blocks_Count()) {
-            if (QUERY_BIT(_allocation_bits, i)) {
-                Assert(QUERY_BIT(_occupied, i));
+        FOR_RANGE (size_t, i, Words_Count()) {
+            if (_allocation_bits[i] & ~_occupied[i]) {
+                INVALID_PATH;
                 return false;
             }
         }
 
-        return true;
+        auto sane = Query_Bit(_occupied, Last_Block_Offset())
+                    && !Query_Bit(_allocation_bits, Last_Block_Offset());
+        Assert(sane);
+        return sane;
     }
 
 private:
-    consteval size_t Last_Block_Offset() {
+    static consteval size_t Last_Block_Offset() {
         return block_size * 4 - 1;
     }
-    consteval size_t Total_Blocks_Count() {
+    static consteval size_t Total_Blocks_Count() {
         return block_size * 4;
     }
+    static consteval size_t Words_Count() {
+        return Total_Blocks_Count() / 64;
+    }
+
+    bool Initialize() {
+        auto blk = _parent.Allocate(block_size * Total_Blocks_Count());
+        if (blk.ptr == nullptr)
+            return false;
+
+        _blocks          = (u8*)blk.ptr;
+        _occupied        = (u64*)(_blocks + block_size * Last_Block_Offset());
+        _allocation_bits = _occupied + Words_Count();
+        Assert((size_t)_occupied % alignof(u64) == 0);
+
+        memset(_occupied, 0, block_size);
+        Mark_Bits(_occupied, Last_Block_Offset(), 1, true);
+        return true;
+    }
+
+    static bool Query_Bit(const u64* words, size_t bit) {
+        return words[bit / 64] & ((u64)1 << (bit % 64));
+    }
+
+    // NOTE: Индекс первого бита `bit >= from` со значением `value`.
+    // Если такого нет - `Total_Blocks_Count()`.
+    static size_t Find_Bit(const u64* words, size_t from, bool value) {
+        if (from >= Total_Blocks_Count())
+            return Total_Blocks_Count();
+
+        auto w    = from / 64;
+        auto word = (value ? words[w] : ~words[w]) & (~(u64)0 << (from % 64));
+        while (word == 0) {
+            w++;
+            if (w >= Words_Count())
+                return Total_Blocks_Count();
+
+            word = value ? words[w] : ~words[w];
+        }
+
+        return w * 64 + std::countr_zero(word);
+    }
+
+    static void Mark_Bits(u64* words, size_t from, size_t count, bool value) {
+        while (count > 0) {
+            auto bit  = from % 64;
+            auto take = MIN(count, 64 - bit);
+            auto mask = (take == 64) ? ~(u64)0 : ((((u64)1 << take) - 1) << bit);
+
+            if (value)
+                words[from / 64] |= mask;
+            else
+                words[from / 64] &= ~mask;
+
+            from += take;
+            count -= take;
+        }
+    }
 
-    A _parent;  // Аллокатор для аллокации памяти под блоки.
+    A _parent = {};  // Аллокатор для аллокации памяти под блоки.
 
-    void* _blocks;
-    u8* _occupied;  // NOTE: Если бит = 1, значит, этот блок занят.
-    u8* _allocation_bits;  // NOTE: Если бит = 1, значит, это начало новой аллокации.
+    u8*  _blocks          = nullptr;
+    u64* _occupied        = nullptr;  // NOTE: Если бит = 1, значит, этот блок занят.
+    u64* _allocation_bits = nullptr;  // NOTE: Если бит = 1, это начало аллокации.
 };
 
 //
@@ -4,40 +4,116 @@ struct Arena {
     u8*    base;
 
     const char* debug_name;
+
+    // NOTE: Если задан - арена виртуальная (см. `Reserve_Virtual_Arena`).
+    // Зарезервировано `size` байт адресов, закоммичены только первые `committed`.
+    // `Trim_Arena` возвращает OS всё, что выше `keep_committed` и `used`.
+    const OS_Virtual_Memory* virtual_memory;
+    size_t                   committed;
+    size_t                   keep_committed;
+
+    // NOTE: Последние `zeroed_size` байт арены гарантированно нулевые - туда ещё
+    // ничего не писали. `Allocate_Zeros_` не обнуляет их повторно,
+    // а `Reset_Arena` обнуляет только то, что перед ними.
+    // 0 (по умолчанию) - про содержимое арены ничего не известно.
+    size_t zeroed_size;
 };
 
-#define Allocate_For(arena, type) rcast<type*>(Allocate_(arena, sizeof(type)))
+#define ARENA_COMMIT_GRANULARITY Kilobytes((size_t)64)
+
+// NOTE: Выравнивание для данных, которые читают/пишут разные потоки
+// (чтобы не было false sharing), и для буферов под векторные кернелы.
+#define CACHE_LINE_ALIGNMENT 64
+#define SIMD_ALIGNMENT 32
+
+#define Allocate_For(arena, type) \
+    rcast<type*>(Allocate_(arena, sizeof(type), alignof(type)))
 #define Allocate_Array(arena, type, count) \
-    rcast<type*>(Allocate_(arena, sizeof(type) * (count)))
+    rcast<type*>(Allocate_(arena, sizeof(type) * (count), alignof(type)))
 
-#define Allocate_Zeros_For(arena, type) rcast<type*>(Allocate_Zeros_(arena, sizeof(type)))
+#define Allocate_Zeros_For(arena, type) \
+    rcast<type*>(Allocate_Zeros_(arena, sizeof(type), alignof(type)))
 #define Allocate_Zeros_Array(arena, type, count) \
-    rcast<type*>(Allocate_Zeros_(arena, sizeof(type) * (count)))
+    rcast<type*>(Allocate_Zeros_(arena, sizeof(type) * (count), alignof(type)))
+
+#define Allocate_Aligned_Array(arena, type, count, alignment)                  \
+    rcast<type*>(Allocate_(                                                    \
+        arena, sizeof(type) * (count), MAX((size_t)(alignment), alignof(type)) \
+    ))
+#define Allocate_Zeros_Aligned_Array(arena, type, count, alignment)            \
+    rcast<type*>(Allocate_Zeros_(                                              \
+        arena, sizeof(type) * (count), MAX((size_t)(alignment), alignof(type)) \
+    ))
+
+#define Allocate_Cache_Aligned_Array(arena, type, count) \
+    Allocate_Aligned_Array(arena, type, count, CACHE_LINE_ALIGNMENT)
+#define Allocate_SIMD_Aligned_Array(arena, type, count) \
+    Allocate_Aligned_Array(arena, type, count, SIMD_ALIGNMENT)
+#define Allocate_Zeros_SIMD_Aligned_Array(arena, type, count) \
+    Allocate_Zeros_Aligned_Array(arena, type, count, SIMD_ALIGNMENT)
 
 #define Allocate_Array_And_Initialize(arena, type, count)                    \
     [&]() {                                                                  \
         /* NOLINTNEXTLINE(bugprone-macro-parentheses) */                     \
-        auto ptr = rcast<type*>(Allocate_((arena), sizeof(type) * (count))); \
+        auto ptr = Allocate_Array((arena), type, (count));                   \
         FOR_RANGE (int, i, (count)) {                                        \
             std::construct_at(ptr + i);                                      \
         }                                                                    \
         return ptr;                                                          \
     }()
 
-#define Deallocate_Array(arena, type, count) Deallocate_(arena, sizeof(type) * (count))
+#define Deallocate_Array(arena, ptr, type, count) \
+    Deallocate_(arena, rcast<u8*>(ptr), sizeof(type) * (count))
+
+[[nodiscard]] BF_FORCE_INLINE u8* Align_Forward(u8* ptr, size_t alignment) noexcept {
+    const auto addr         = rcast<size_t>(ptr);
+    const auto aligned_addr = (addr + (alignment - 1)) & -alignment;
+    return rcast<u8*>(aligned_addr);
+}
+
+BF_FORCE_INLINE size_t Arena_Commit_Size(size_t size) {
+    return (size + ARENA_COMMIT_GRANULARITY - 1) & ~(ARENA_COMMIT_GRANULARITY - 1);
+}
+
+// NOTE: Коммитит страницы виртуальной арены так, чтобы хватило на `required` байт.
+BF_NO_INLINE void Commit_Arena(Arena& arena, size_t required) {
+    Assert(arena.virtual_memory != nullptr);
+    Assert(required <= arena.size);
+
+    auto committed = MIN(arena.size, Arena_Commit_Size(required));
+    if (committed <= arena.committed)
+        return;
+
+    auto success = arena.virtual_memory->Commit(
+        arena.base + arena.committed, committed - arena.committed
+    );
+    Assert(success);
+    arena.committed = committed;
+}
 
 //
-// TODO: Introduce the notion of `alignment` here!
-// NOTE: Refer to Casey's memory allocation functions
+// NOTE: Выравнивается абсолютный адрес, а не `used`, так что `base` арены
+// может быть любым. Padding перед аллокацией учитывается в `used`.
+// Refer to Casey's memory allocation functions
 // https://youtu.be/MvDUe2evkHg?list=PLEMXAbCVnmY6Azbmzj3BiC3QRYHE9QoG7&t=2121
 //
-u8* Allocate_(Arena& arena, size_t size) {
+u8* Allocate_(Arena& arena, size_t size, size_t alignment = 1) {
     Assert(size > 0);
+    Assert(alignment > 0);
+    Assert((alignment & (alignment - 1)) == 0);
+
+    u8*  result  = Align_Forward(arena.base + arena.used, alignment);
+    auto padding = (size_t)(result - (arena.base + arena.used));
     Assert(arena.size >= size);
     Assert(arena.used <= arena.size - size);
+    Assert(padding <= arena.size - size - arena.used);
 
-    u8* result = arena.base + arena.used;
-    arena.used += size;
+    auto used = arena.used + padding + size;
+    if (arena.virtual_memory != nullptr && used > arena.committed) [[unlikely]]
+        Commit_Arena(arena, used);
+
+    arena.used        = used;
+    arena.zeroed_size = MIN(arena.zeroed_size, arena.size - used);
 
 #ifdef PROFILING
     // TODO: Изучить способы того, как можно прикрутить профилирование памяти с
@@ -51,16 +127,24 @@ u8* Allocate_(Arena& arena, size_t size) {
     return result;
 }
 
-u8* Allocate_Zeros_(Arena& arena, size_t size) {
-    auto result = Allocate_(arena, size);
-    memset(result, 0, size);
+u8* Allocate_Zeros_(Arena& arena, size_t size, size_t alignment = 1) {
+    auto dirty_size = arena.size - arena.zeroed_size;
+
+    auto result = Allocate_(arena, size, alignment);
+    auto offset = (size_t)(result - arena.base);
+    if (offset < dirty_size)
+        memset(result, 0, MIN(size, dirty_size - offset));
+
     return result;
 }
 
-void Deallocate_(Arena& arena, size_t size) {
+// NOTE: Освобождать можно только последнюю аллокацию.
+// Padding перед ней остаётся занятым - его откатывает только TEMP_USAGE.
+void Deallocate_(Arena& arena, u8* ptr, size_t size) {
     Assert(size > 0);
-    Assert(arena.used >= size);
-    arena.used -= size;
+    Assert(ptr >= arena.base);
+    Assert(ptr + size == arena.base + arena.used);
+    arena.used = ptr - arena.base;
 
 #ifdef PROFILING
     // TODO: См. выше
@@ -70,18 +154,63 @@ void Deallocate_(Arena& arena, size_t size) {
 #endif
 }
 
+// NOTE: Резервирует `size` байт адресов. Память коммитится по мере роста `used`,
+// так что размер можно брать с большим запасом.
+// `keep_committed` - сколько памяти `Trim_Arena` оставляет закоммиченной.
+void Reserve_Virtual_Arena(
+    Arena&                   arena,
+    const OS_Virtual_Memory& virtual_memory,
+    size_t                   size,
+    size_t                   keep_committed
+) {
+    Assert(arena.base == nullptr);
+    Assert(size > 0);
+    Assert(Arena_Commit_Size(size) == size);
+
+    arena.base = (u8*)virtual_memory.Reserve(size);
+    Assert(arena.base != nullptr);
+    Assert(Align_Forward(arena.base, ARENA_COMMIT_GRANULARITY) == arena.base);
+
+    arena.used           = 0;
+    arena.size           = size;
+    arena.virtual_memory = &virtual_memory;
+    arena.committed      = 0;
+    arena.keep_committed = keep_committed;
+    arena.zeroed_size    = size;
+}
+
+void Release_Virtual_Arena(Arena& arena) {
+    Assert(arena.virtual_memory != nullptr);
+
+    arena.virtual_memory->Release(arena.base, arena.size);
+
+    auto debug_name  = arena.debug_name;
+    arena            = {};
+    arena.debug_name = debug_name;
+}
+
+// NOTE: Возвращает OS закоммиченную память выше `used` и `keep_committed`.
+// При повторном коммите OS отдаст её нулями. Обычные арены не трогает.
+void Trim_Arena(Arena& arena) {
+    if (arena.virtual_memory == nullptr)
+        return;
+
+    auto keep = MIN(arena.size, Arena_Commit_Size(MAX(arena.used, arena.keep_committed)));
+    if (arena.committed <= keep)
+        return;
+
+    arena.virtual_memory->Decommit(arena.base + keep, arena.committed - keep);
+    arena.committed   = keep;
+    arena.zeroed_size = MAX(arena.zeroed_size, arena.size - keep);
+}
+
 //----------------------------------------------------------------------------------
 // Other.
 //----------------------------------------------------------------------------------
-[[nodiscard]] BF_FORCE_INLINE u8* Align_Forward(u8* ptr, size_t alignment) noexcept {
-    const auto addr         = rcast<size_t>(ptr);
-    const auto aligned_addr = (addr + (alignment - 1)) & -alignment;
-    return rcast<u8*>(aligned_addr);
-}
-
 // TEMP_USAGE используется для временного использования арены.
 // При вызове TEMP_USAGE запоминается текущее количество занятого
 // пространства арены, которое обратно устанавливается при выходе из scope.
+// Padding выровненных аллокаций внутри scope откатывается вместе с ними.
 //
 // Пример использования:
 //
@@ -89,7 +218,7 @@ void Deallocate_(Arena& arena, size_t size) {
 //     {
 //         TEMP_USAGE(trash_arena);
 //         u32* allocated_on_arena_u32 = ALLOCATE_FOR(trash_arena, u32);
-//         Assert(trash_arena.used == X + 4);
+//         Assert(trash_arena.used >= X + 4);
 //     }
 //     Assert(trash_arena.used == X);
 //
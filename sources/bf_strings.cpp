@@ -52,9 +52,17 @@ char* Text_Format_To_Arena(Arena& arena, const char* format, ...) {
     memcpy(allocated_string, buf, n_wo_zero);
     *(allocated_string + n_wo_zero) = '\0';
 #else
+    // NOTE: Строка пишется прямо в арену, минуя `Allocate_`,
+    // так что у виртуальной арены страницы надо закоммитить заранее.
+    auto writable_size = arena.size;
+    if (arena.virtual_memory != nullptr) {
+        Commit_Arena(arena, MIN(arena.size, arena.used + BF_TEXTFORMAT_MAX_SIZE));
+        writable_size = arena.committed;
+    }
+
     auto allocated_string = (char*)(arena.base + arena.used);
 
-    const auto MAX_N = arena.size - arena.used;
+    const auto MAX_N = writable_size - arena.used;
 
     // NOLINTNEXTLINE(cppcoreguidelines-init-variables)
     va_list args;
@@ -69,6 +77,7 @@ char* Text_Format_To_Arena(Arena& arena, const char* format, ...) {
 
     arena.used += n_wo_zero + 1;
     Assert(arena.used <= arena.size);
+    arena.zeroed_size = MIN(arena.zeroed_size, arena.size - arena.used);
 #endif
     return allocated_string;
 }
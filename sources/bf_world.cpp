@@ -15,114 +15,1191 @@ bool Have_Some_Of_The_Same_Vertices(const Graph_Segment& s1, const Graph_Segment
     return false;
 }
 
+u32 Vertex_Segments_Slot(const Vertex_Segments_Index& index, v2i16 pos) {
+    return Hash32((const u8*)&pos, sizeof(pos)) & (index.max_count - 1);
+}
+
+Vertex_Segments* Find_Vertex_Segments(Vertex_Segments_Index& index, v2i16 pos) {
+    if (index.count == 0)
+        return nullptr;
+
+    auto i = Vertex_Segments_Slot(index, pos);
+    while (index.slots[i].count > 0) {
+        if (index.slots[i].pos == pos)
+            return index.slots + i;
+
+        i = (i + 1) & (index.max_count - 1);
+    }
+
+    return nullptr;
+}
+
+void Enlarge_Vertex_Segments_Index(Vertex_Segments_Index& index, MCTX) {
+    CTX_ALLOCATOR;
+
+    auto old_slots     = index.slots;
+    auto old_max_count = index.max_count;
+
+    index.max_count = MAX(old_max_count * 2, 64);
+    index.slots     = (Vertex_Segments*)ALLOC(sizeof(Vertex_Segments) * index.max_count);
+    FOR_RANGE (u32, i, index.max_count) {
+        index.slots[i].count = 0;
+    }
+
+    FOR_RANGE (u32, i, old_max_count) {
+        auto& old = old_slots[i];
+        if (old.count == 0)
+            continue;
+
+        auto j = Vertex_Segments_Slot(index, old.pos);
+        while (index.slots[j].count > 0)
+            j = (j + 1) & (index.max_count - 1);
+
+        index.slots[j] = old;
+    }
+
+    if (old_slots != nullptr)
+        FREE(old_slots, sizeof(Vertex_Segments) * old_max_count);
+}
+
+void Add_Vertex_Segment(
+    Vertex_Segments_Index& index,
+    v2i16                  pos,
+    Graph_Segment_ID       id,
+    MCTX
+) {
+    // NOTE: Держим заполненность не выше половины.
+    if (2 * (index.count + 1) > index.max_count)
+        Enlarge_Vertex_Segments_Index(index, ctx);
+
+    auto i = Vertex_Segments_Slot(index, pos);
+    while (index.slots[i].count > 0 && index.slots[i].pos != pos)
+        i = (i + 1) & (index.max_count - 1);
+
+    auto& entry = index.slots[i];
+    if (entry.count == 0) {
+        entry.pos = pos;
+        index.count++;
+    }
+
+    Assert(entry.count < 4);
+    entry.segments[entry.count++] = id;
+}
+
+void Remove_Vertex_Segment(Vertex_Segments_Index& index, v2i16 pos, Graph_Segment_ID id) {
+    auto entry = Find_Vertex_Segments(index, pos);
+    Assert(entry != nullptr);
+
+    auto found = Array_Find(entry->segments, entry->count, id);
+    Assert(found >= 0);
+    entry->segments[found] = entry->segments[--entry->count];
+
+    if (entry->count > 0)
+        return;
+
+    // NOTE: Сдвигаем назад записи, которые стоят не на своём месте,
+    // чтобы в цепочках пробирования не было дыр.
+    index.count--;
+    auto mask = index.max_count - 1;
+    auto hole = (u32)(entry - index.slots);
+    auto i    = (hole + 1) & mask;
+    while (index.slots[i].count > 0) {
+        auto home = Vertex_Segments_Slot(index, index.slots[i].pos);
+        if (((i - home) & mask) >= ((i - hole) & mask)) {
+            index.slots[hole]    = index.slots[i];
+            index.slots[i].count = 0;
+            hole                 = i;
+        }
+
+        i = (i + 1) & mask;
+    }
+}
+
+void Deinit_Vertex_Segments_Index(Vertex_Segments_Index& index, MCTX) {
+    CTX_ALLOCATOR;
+
+    if (index.slots != nullptr)
+        FREE(index.slots, sizeof(Vertex_Segments) * index.max_count);
+
+    index = {};
+}
+
+// NOTE: Сколько воркеров реально получит `Parallel_For`.
+// `thread_index` контекстов, которые увидит `func`, меньше этого числа.
+u32 Parallel_For_Threads_Count(u32 threads_count) {
+    auto data = global_library_integration_data;
+    if (threads_count <= 1 || data == nullptr || data->jobs == nullptr)
+        return 1;
+
+    return data->jobs_workers_count;
+}
+
+// NOTE: Раздаёт задачи [0, tasks_count) воркерам джоб системы хоста.
+// Без неё или при `threads_count <= 1` всё выполняется на вызывающем потоке с `ctx`.
+// `func(worker_ctx, task_index)` получает контекст воркера, который её выполняет
+// (`thread_index`, `scratch_arena`). Аллоцировать через него нельзя:
+// отладочный аллокатор не потокобезопасен.
+template <typename F>
+void Parallel_For(u32 threads_count, u32 tasks_count, F&& func, MCTX) {
+    auto workers_count = Parallel_For_Threads_Count(threads_count);
+
+    if (workers_count <= 1 || tasks_count <= 1) {
+        FOR_RANGE (u32, i, tasks_count) {
+            func(ctx, i);
+        }
+        return;
+    }
+
+    auto Routine = [](void* data, u32 begin, u32 end, Context* worker_ctx) noexcept {
+        auto& f = *(std::remove_reference_t<F>*)data;
+        for (auto i = begin; i < end; i++)
+            f(worker_ctx, i);
+    };
+
+    auto& jobs  = *global_library_integration_data;
+    auto  grain = MAX((u32)1, tasks_count / (workers_count * 8));
+
+    Job_Counter counter{};
+    jobs.Jobs_Submit(
+        jobs.jobs, Routine, (void*)&func, tasks_count, grain, &counter, nullptr
+    );
+    jobs.Jobs_Wait(jobs.jobs, &counter);
+}
+
 struct Path_Find_Result {
     bool   success;
     v2i16* path;
     i32    path_count;
 };
 
+BF_FORCE_INLINE void Set_Parent_Direction(u8* parents, i32 tile_index, Direction dir) {
+    auto& byte  = parents[tile_index / 4];
+    auto  shift = (tile_index % 4) * 2;
+    byte        = (u8)((byte & ~(0b11 << shift)) | ((u8)dir << shift));
+}
+
+BF_FORCE_INLINE Direction Get_Parent_Direction(const u8* parents, i32 tile_index) {
+    auto shift = (tile_index % 4) * 2;
+    return (Direction)((parents[tile_index / 4] >> shift) & 0b11);
+}
+
+// NOTE: Двойной проход по родителям: сначала считаем длину пути,
+// затем заполняем его с конца. Лишней памяти на `trash_arena` не берём.
 std::tuple<v2i16*, i32> Build_Path(
-    Arena&                trash_arena,
-    v2i16                 gsize,
-    std::optional<v2i16>* bfs_parents_mtx,
-    v2i16                 destination
+    Arena&    trash_arena,
+    v2i16     gsize,
+    const u8* parents,
+    v2i16     source,
+    v2i16     destination
 ) {
-#if 0
-    // NOTE: Двойной проход, но без RAM overhead-а на `trash_arena`.
-    auto path_max_count = 1;
-    {
-        v2i16 dest = destination;
-        while (WORLD_PTR_OFFSET(bfs_parents_mtx, dest).has_value()) {
-            auto value = WORLD_PTR_OFFSET(bfs_parents_mtx, dest).value();
-            path_max_count++;
-            dest = value;
-        }
+    i32 path_count = 1;
+    for (auto pos = destination; pos != source; path_count++) {
+        auto dir = Get_Parent_Direction(parents, pos.y * gsize.x + pos.x);
+        pos      = pos + As_Offset(dir);
     }
-#else
-    // NOTE: Одинарный проход. С RAM overhead-ом.
-    auto path_max_count = Longest_Meaningful_Path(gsize);
-#endif
 
-    i32  path_count = 0;
-    auto path       = Allocate_Zeros_Array(trash_arena, v2i16, path_max_count);
+    auto path = Allocate_Array(trash_arena, v2i16, path_count);
 
-    Array_Push(path, path_count, path_max_count, destination);
-    while (WORLD_PTR_OFFSET(bfs_parents_mtx, destination).has_value()) {
-        auto value = WORLD_PTR_OFFSET(bfs_parents_mtx, destination).value();
-        Array_Push(path, path_count, path_max_count, value);
-        destination = value;
+    auto pos = destination;
+    for (i32 i = path_count - 1; i > 0; i--) {
+        path[i]  = pos;
+        auto dir = Get_Parent_Direction(parents, pos.y * gsize.x + pos.x);
+        pos      = pos + As_Offset(dir);
     }
-
-    Array_Reverse(path, path_count);
+    path[0] = source;
 
     return {path, path_count};
 }
 
-Path_Find_Result Find_Path(
-    Arena&        trash_arena,
-    v2i16         gsize,
-    Terrain_Tile* terrain_tiles,
-    Element_Tile* element_tiles,
-    v2i16         source,
-    v2i16         destination,
-    bool          avoid_harvestable_resources
+// NOTE: Стоимости перехода на тайл для `Find_Path`.
+// По дорогам ходить дешевле, по скалам и ресурсам - дороже.
+#define PATH_COST_ROAD 2
+#define PATH_COST_DEFAULT 3
+#define PATH_COST_CLIFF_PENALTY 9
+#define PATH_COST_RESOURCE_PENALTY 3
+
+BF_FORCE_INLINE i32
+Path_Tile_Cost(const Terrain_Tile& terrain_tile, const Element_Tile& element_tile) {
+    i32 cost = PATH_COST_DEFAULT;
+    if (element_tile.type == Element_Tile_Type::Road
+        || element_tile.type == Element_Tile_Type::Flag)
+    {
+        cost = PATH_COST_ROAD;
+    }
+
+    if (terrain_tile.is_cliff)
+        cost += PATH_COST_CLIFF_PENALTY;
+    if (terrain_tile.resource_amount > 0)
+        cost += PATH_COST_RESOURCE_PENALTY;
+
+    return cost;
+}
+
+// NOTE: Эвристика - манхэттенское расстояние, умноженное на минимальную
+// стоимость тайла. Она не переоценивает путь, поэтому A* находит оптимальный.
+BF_FORCE_INLINE i32 Path_Heuristic(v2i16 pos, v2i16 destination) {
+    return (abs(pos.x - destination.x) + abs(pos.y - destination.y)) * PATH_COST_ROAD;
+}
+
+void Init_Path_Find_Workspace(
+    Path_Find_Workspace& workspace,
+    Arena&               arena,
+    i32                  tiles_count
+) {
+    workspace.generation = 0;
+    workspace.stamps     = Allocate_Zeros_Array(arena, u32, tiles_count);
+    workspace.g          = Allocate_Array(arena, i32, tiles_count);
+    workspace.parents
+        = Allocate_Zeros_Array(arena, u8, Ceiled_Division(tiles_count, 4));
+
+    // NOTE: Каждый тайл закрывается один раз и добавляет в кучу не более 4 узлов.
+    auto open_max_count        = tiles_count * 4 + 1;
+    workspace.open.count       = 0;
+    workspace.open.memory_size = sizeof(Path_Find_Node) * open_max_count;
+    workspace.open.base = Allocate_Array(arena, Path_Find_Node, open_max_count);
+}
+
+BF_FORCE_INLINE bool Pos_Is_In_Rect(v2i16 pos, v2i16 rect_min, v2i16 rect_max) {
+    return pos.x >= rect_min.x && pos.y >= rect_min.y && pos.x < rect_max.x
+           && pos.y < rect_max.y;
+}
+
+// NOTE: Начинает новый запрос в `workspace`. Возвращает штамп открытых тайлов,
+// штамп закрытых на единицу больше.
+// Штампы прошлых запросов становятся меньше `generation`.
+// Массив чистится только при переполнении счётчика.
+u32 Begin_Path_Find_Query(Path_Find_Workspace& workspace, i32 tiles_count) {
+    if (workspace.generation >= u32_max - 2) {
+        memset(workspace.stamps, 0, sizeof(u32) * tiles_count);
+        workspace.generation = 0;
+    }
+    workspace.generation += 2;
+    workspace.open.count = 0;
+    return workspace.generation;
+}
+
+// A* с манхэттенской эвристикой, не выходящий за прямоугольник
+// [`rect_min`, `rect_max`).
+// Всё состояние запроса живёт в `workspace`, в `trash_arena` аллоцируется только путь.
+Path_Find_Result Find_Path_In_Rect(
+    Path_Find_Workspace& workspace,
+    Arena&               trash_arena,
+    v2i16                gsize,
+    Terrain_Tile*        terrain_tiles,
+    Element_Tile*        element_tiles,
+    v2i16                rect_min,
+    v2i16                rect_max,
+    v2i16                source,
+    v2i16                destination,
+    bool                 avoid_harvestable_resources
 ) {
     if (source == destination)
         return {true, {}, 0};
 
-    TEMP_USAGE(trash_arena);
-    i32 tiles_count = gsize.x * gsize.y;
+    const auto opened = Begin_Path_Find_Query(workspace, gsize.x * gsize.y);
+    const auto closed = opened + 1;
 
-    Path_Find_Result        result{};
-    Fixed_Size_Queue<v2i16> queue{};
-    queue.memory_size = sizeof(v2i16) * tiles_count;
-    queue.base        = (v2i16*)Allocate_Array(trash_arena, u8, queue.memory_size);
-    *queue.Enqueue()  = source;
+    auto  stamps_mtx = workspace.stamps;
+    auto  g_mtx      = workspace.g;
+    auto& open       = workspace.open;
 
-    bool* visited_mtx = Allocate_Zeros_Array(trash_arena, bool, tiles_count);
-    WORLD_PTR_OFFSET(visited_mtx, source) = true;
+    Path_Find_Result result{};
 
-    auto bfs_parents_mtx
-        = Allocate_Zeros_Array(trash_arena, std::optional<v2i16>, tiles_count);
+    open.Push({Path_Heuristic(source, destination), 0, source});
+    WORLD_PTR_OFFSET(stamps_mtx, source) = opened;
+    WORLD_PTR_OFFSET(g_mtx, source)      = 0;
+
+    while (open.count > 0) {
+        auto node = open.Pop();
+        auto pos  = node.pos;
+
+        auto& stamp = WORLD_PTR_OFFSET(stamps_mtx, pos);
+        if (stamp == closed || node.g > WORLD_PTR_OFFSET(g_mtx, pos))
+            continue;
+        stamp = closed;
+
+        if (pos == destination) {
+            result.success = true;
+            auto [path, path_count]
+                = Build_Path(trash_arena, gsize, workspace.parents, source, destination);
+            result.path       = path;
+            result.path_count = path_count;
+            return result;
+        }
 
-    while (queue.count > 0) {
-        auto pos = queue.Dequeue();
         FOR_DIRECTION (dir) {
             auto offset  = As_Offset(dir);
             auto new_pos = pos + offset;
-            if (!Pos_Is_In_Bounds(new_pos, gsize))
+            if (!Pos_Is_In_Rect(new_pos, rect_min, rect_max))
+                continue;
+
+            auto& new_stamp = WORLD_PTR_OFFSET(stamps_mtx, new_pos);
+            if (new_stamp == closed)
+                continue;
+
+            auto& terrain_tile = WORLD_PTR_OFFSET(terrain_tiles, new_pos);
+            if (avoid_harvestable_resources && terrain_tile.resource_amount > 0)
+                continue;
+
+            auto& element_tile = WORLD_PTR_OFFSET(element_tiles, new_pos);
+
+            auto  g     = node.g + Path_Tile_Cost(terrain_tile, element_tile);
+            auto& new_g = WORLD_PTR_OFFSET(g_mtx, new_pos);
+            if (new_stamp == opened && new_g <= g)
+                continue;
+
+            new_stamp = opened;
+            new_g     = g;
+            Set_Parent_Direction(
+                workspace.parents, new_pos.y * gsize.x + new_pos.x, Opposite(dir)
+            );
+
+            open.Push({g + Path_Heuristic(new_pos, destination), g, new_pos});
+        }
+    }
+
+    result.success = false;
+    return result;
+}
+
+Path_Find_Result Find_Path(
+    Path_Find_Workspace& workspace,
+    Arena&               trash_arena,
+    v2i16                gsize,
+    Terrain_Tile*        terrain_tiles,
+    Element_Tile*        element_tiles,
+    v2i16                source,
+    v2i16                destination,
+    bool                 avoid_harvestable_resources
+) {
+    return Find_Path_In_Rect(
+        workspace,
+        trash_arena,
+        gsize,
+        terrain_tiles,
+        element_tiles,
+        {0, 0},
+        gsize,
+        source,
+        destination,
+        avoid_harvestable_resources
+    );
+}
+
+// NOTE: Dijkstra внутри прямоугольника [`rect_min`, `rect_max`) от `start`.
+// При `reverse` считаются стоимости путей до `start`, а не от него.
+// Результат читается через `Path_Find_Workspace_Cost`.
+void Path_Find_Dijkstra_In_Rect(
+    Path_Find_Workspace& workspace,
+    v2i16                gsize,
+    Terrain_Tile*        terrain_tiles,
+    Element_Tile*        element_tiles,
+    v2i16                rect_min,
+    v2i16                rect_max,
+    v2i16                start,
+    bool                 reverse
+) {
+    const auto opened = Begin_Path_Find_Query(workspace, gsize.x * gsize.y);
+    const auto closed = opened + 1;
+
+    auto  stamps_mtx = workspace.stamps;
+    auto  g_mtx      = workspace.g;
+    auto& open       = workspace.open;
+
+    open.Push({0, 0, start});
+    WORLD_PTR_OFFSET(stamps_mtx, start) = opened;
+    WORLD_PTR_OFFSET(g_mtx, start)      = 0;
+
+    while (open.count > 0) {
+        auto node = open.Pop();
+        auto pos  = node.pos;
+
+        auto& stamp = WORLD_PTR_OFFSET(stamps_mtx, pos);
+        if (stamp == closed || node.g > WORLD_PTR_OFFSET(g_mtx, pos))
+            continue;
+        stamp = closed;
+
+        // NOTE: В обратную сторону платим за `pos`, на который заходим с соседа.
+        i32 cost = 0;
+        if (reverse) {
+            auto& terrain_tile = WORLD_PTR_OFFSET(terrain_tiles, pos);
+            if (terrain_tile.resource_amount > 0)
                 continue;
 
-            auto& visited = WORLD_PTR_OFFSET(visited_mtx, new_pos);
-            if (visited)
+            cost = Path_Tile_Cost(terrain_tile, WORLD_PTR_OFFSET(element_tiles, pos));
+        }
+
+        FOR_DIRECTION (dir) {
+            auto new_pos = pos + As_Offset(dir);
+            if (!Pos_Is_In_Rect(new_pos, rect_min, rect_max))
                 continue;
 
-            if (avoid_harvestable_resources) {
+            auto& new_stamp = WORLD_PTR_OFFSET(stamps_mtx, new_pos);
+            if (new_stamp == closed)
+                continue;
+
+            if (!reverse) {
                 auto& terrain_tile = WORLD_PTR_OFFSET(terrain_tiles, new_pos);
                 if (terrain_tile.resource_amount > 0)
                     continue;
+
+                cost = Path_Tile_Cost(
+                    terrain_tile, WORLD_PTR_OFFSET(element_tiles, new_pos)
+                );
             }
 
-            auto& element_tile = WORLD_PTR_OFFSET(element_tiles, new_pos);
-            visited            = true;
+            auto  g     = node.g + cost;
+            auto& new_g = WORLD_PTR_OFFSET(g_mtx, new_pos);
+            if (new_stamp == opened && new_g <= g)
+                continue;
+
+            new_stamp = opened;
+            new_g     = g;
+            open.Push({g, g, new_pos});
+        }
+    }
+}
+
+// NOTE: i32_max - тайл недостижим в последнем `Path_Find_Dijkstra_In_Rect`.
+BF_FORCE_INLINE i32
+Path_Find_Workspace_Cost(const Path_Find_Workspace& workspace, v2i16 gsize, v2i16 pos) {
+    if (WORLD_PTR_OFFSET(workspace.stamps, pos) != workspace.generation + 1)
+        return i32_max;
+    return WORLD_PTR_OFFSET(workspace.g, pos);
+}
+
+BF_FORCE_INLINE i32 Path_Cluster_Index(const Path_Hierarchy& hierarchy, v2i16 pos) {
+    return (pos.y / PATH_CLUSTER_SIZE) * hierarchy.clusters_size.x
+           + pos.x / PATH_CLUSTER_SIZE;
+}
+
+std::tuple<v2i16, v2i16>
+Path_Cluster_Rect(const Path_Hierarchy& hierarchy, v2i16 gsize, i32 cluster_index) {
+    v2i16 rect_min = {
+        (cluster_index % hierarchy.clusters_size.x) * PATH_CLUSTER_SIZE,
+        (cluster_index / hierarchy.clusters_size.x) * PATH_CLUSTER_SIZE,
+    };
+    v2i16 rect_max = {
+        MIN(rect_min.x + PATH_CLUSTER_SIZE, gsize.x),
+        MIN(rect_min.y + PATH_CLUSTER_SIZE, gsize.y),
+    };
+    return {rect_min, rect_max};
+}
+
+void Init_Path_Hierarchy(Path_Hierarchy& hierarchy, Arena& arena, v2i16 gsize) {
+    hierarchy.clusters_size = {
+        Ceiled_Division(gsize.x, PATH_CLUSTER_SIZE),
+        Ceiled_Division(gsize.y, PATH_CLUSTER_SIZE),
+    };
+
+    auto clusters_count = hierarchy.clusters_size.x * hierarchy.clusters_size.y;
+    hierarchy.clusters  = Allocate_Zeros_Array(arena, Path_Cluster, clusters_count);
+    hierarchy.dirty     = Allocate_Array(arena, i32, clusters_count);
 
-            WORLD_PTR_OFFSET(bfs_parents_mtx, new_pos) = pos;
+    // NOTE: Тайлы ещё не сгенерированы.
+    // Кластеры посчитаются перед первым запросом.
+    hierarchy.dirty_count = clusters_count;
+    FOR_RANGE (i32, i, clusters_count) {
+        hierarchy.clusters[i].dirty = true;
+        hierarchy.dirty[i]          = i;
+    }
+
+    auto nodes_count     = clusters_count * PATH_CLUSTER_MAX_NODES + 2;
+    hierarchy.generation = 0;
+    hierarchy.stamps     = Allocate_Zeros_Array(arena, u32, nodes_count);
+    hierarchy.g          = Allocate_Array(arena, i32, nodes_count);
+    hierarchy.parents    = Allocate_Array(arena, u32, nodes_count);
+
+    // NOTE: При улучшении `g` узел в куче обновляется (`Decrease`),
+    // поэтому в куче не больше одного элемента на узел.
+    hierarchy.open.max_count = nodes_count;
+    hierarchy.open.count     = 0;
+    hierarchy.open.base      = Allocate_Array(arena, Path_Abstract_Node, nodes_count);
+    hierarchy.open.positions = Allocate_Array(arena, i32, nodes_count);
+}
+
+void Mark_Path_Cluster_Dirty(Path_Hierarchy& hierarchy, v2i16 cluster_pos) {
+    if (!Pos_Is_In_Bounds(cluster_pos, hierarchy.clusters_size))
+        return;
+
+    auto  index   = cluster_pos.y * hierarchy.clusters_size.x + cluster_pos.x;
+    auto& cluster = hierarchy.clusters[index];
+    if (cluster.dirty)
+        return;
+
+    cluster.dirty                            = true;
+    hierarchy.dirty[hierarchy.dirty_count++] = index;
+}
+
+// NOTE: Тайл на границе кластера меняет и переходы соседнего кластера.
+void Mark_Path_Clusters_Dirty(Path_Hierarchy& hierarchy, v2i16 pos) {
+    v2i16 cluster_pos = {pos.x / PATH_CLUSTER_SIZE, pos.y / PATH_CLUSTER_SIZE};
+    Mark_Path_Cluster_Dirty(hierarchy, cluster_pos);
+
+    auto local = pos - cluster_pos * (i16)PATH_CLUSTER_SIZE;
+    if (local.x == 0)
+        Mark_Path_Cluster_Dirty(hierarchy, cluster_pos + v2i16(-1, 0));
+    if (local.x == PATH_CLUSTER_SIZE - 1)
+        Mark_Path_Cluster_Dirty(hierarchy, cluster_pos + v2i16(1, 0));
+    if (local.y == 0)
+        Mark_Path_Cluster_Dirty(hierarchy, cluster_pos + v2i16(0, -1));
+    if (local.y == PATH_CLUSTER_SIZE - 1)
+        Mark_Path_Cluster_Dirty(hierarchy, cluster_pos + v2i16(0, 1));
+}
+
+void Add_Path_Cluster_Node(Path_Cluster& cluster, v2i16 pos, Direction exit) {
+    FOR_RANGE (i32, i, cluster.nodes_count) {
+        auto& node = cluster.nodes[i];
+        if (node.pos == pos) {
+            node.exits |= (u8)(1 << (u8)exit);
+            return;
+        }
+    }
+
+    Assert(cluster.nodes_count < PATH_CLUSTER_MAX_NODES);
+    cluster.nodes[cluster.nodes_count++] = {pos, (u8)(1 << (u8)exit)};
+}
 
-            if (new_pos == destination) {
-                result.success = true;
-                auto [path, path_count]
-                    = Build_Path(trash_arena, gsize, bfs_parents_mtx, new_pos);
-                result.path       = path;
-                result.path_count = path_count;
-                return result;
+// Пересчёт переходов кластера и стоимостей путей между ними.
+// Переходы на общей границе двух кластеров вычисляются одинаково с обеих сторон,
+// поэтому соседний кластер можно пересчитывать независимо.
+void Update_Path_Cluster(
+    Path_Hierarchy&      hierarchy,
+    Path_Find_Workspace& workspace,
+    v2i16                gsize,
+    Terrain_Tile*        terrain_tiles,
+    Element_Tile*        element_tiles,
+    i32                  cluster_index
+) {
+    auto& cluster       = hierarchy.clusters[cluster_index];
+    cluster.dirty       = false;
+    cluster.nodes_count = 0;
+
+    auto [rect_min, rect_max] = Path_Cluster_Rect(hierarchy, gsize, cluster_index);
+    v2i16 cluster_pos         = {
+        cluster_index % hierarchy.clusters_size.x,
+        cluster_index / hierarchy.clusters_size.x,
+    };
+
+    FOR_DIRECTION (dir) {
+        auto offset = As_Offset(dir);
+        if (!Pos_Is_In_Bounds(cluster_pos + offset, hierarchy.clusters_size))
+            continue;
+
+        // NOTE: Идём вдоль стороны кластера по возрастанию x или y.
+        v2i16 first  = rect_min;
+        v2i16 step   = {0, 1};
+        i32   length = rect_max.y - rect_min.y;
+        if (offset.x > 0)
+            first.x = rect_max.x - 1;
+        if (offset.y != 0) {
+            step   = {1, 0};
+            length = rect_max.x - rect_min.x;
+        }
+        if (offset.y > 0)
+            first.y = rect_max.y - 1;
+
+        i32 run_start = -1;
+        FOR_RANGE (i32, i, length + 1) {
+            bool passable = false;
+            if (i < length) {
+                auto  pos       = first + step * (i16)i;
+                auto& tile      = WORLD_PTR_OFFSET(terrain_tiles, pos);
+                auto& neighbour = WORLD_PTR_OFFSET(terrain_tiles, pos + offset);
+                passable = tile.resource_amount == 0 && neighbour.resource_amount == 0;
             }
 
-            *queue.Enqueue() = new_pos;
+            if (passable && run_start < 0)
+                run_start = i;
+            else if (!passable && run_start >= 0) {
+                auto middle = first + step * (i16)((run_start + i - 1) / 2);
+                Add_Path_Cluster_Node(cluster, middle, dir);
+                run_start = -1;
+            }
         }
     }
 
-    result.success = false;
-    return result;
+    FOR_RANGE (i32, i, cluster.nodes_count) {
+        Path_Find_Dijkstra_In_Rect(
+            workspace,
+            gsize,
+            terrain_tiles,
+            element_tiles,
+            rect_min,
+            rect_max,
+            cluster.nodes[i].pos,
+            false
+        );
+
+        FOR_RANGE (i32, j, cluster.nodes_count) {
+            auto  pos          = cluster.nodes[j].pos;
+            auto  cost         = Path_Find_Workspace_Cost(workspace, gsize, pos);
+            auto& cluster_cost = cluster.costs[i * PATH_CLUSTER_MAX_NODES + j];
+            if (cost == i32_max) {
+                cluster_cost = u16_max;
+                continue;
+            }
+
+            Assert(cost < u16_max);
+            cluster_cost = (u16)cost;
+        }
+    }
+}
+
+void Update_Path_Hierarchy(
+    Path_Hierarchy&      hierarchy,
+    Path_Find_Workspace& workspace,
+    v2i16                gsize,
+    Terrain_Tile*        terrain_tiles,
+    Element_Tile*        element_tiles
+) {
+    ZoneScoped;
+
+    FOR_RANGE (i32, i, hierarchy.dirty_count) {
+        Update_Path_Cluster(
+            hierarchy, workspace, gsize, terrain_tiles, element_tiles, hierarchy.dirty[i]
+        );
+    }
+    hierarchy.dirty_count = 0;
+}
+
+// HPA*. Сначала A* по абстрактному графу переходов между кластерами,
+// затем каждое его ребро уточняется A* внутри своего кластера.
+// Путь бывает чуть длиннее оптимального, зато поиск не обходит всю карту.
+// Тайлы с ресурсами обходятся всегда (`avoid_harvestable_resources` = true).
+Path_Find_Result Find_Path_Hierarchical(
+    Path_Hierarchy&      hierarchy,
+    Path_Find_Workspace& workspace,
+    Arena&               trash_arena,
+    v2i16                gsize,
+    Terrain_Tile*        terrain_tiles,
+    Element_Tile*        element_tiles,
+    v2i16                source,
+    v2i16                destination
+) {
+    if (source == destination)
+        return {true, {}, 0};
+
+    ZoneScoped;
+
+    Update_Path_Hierarchy(hierarchy, workspace, gsize, terrain_tiles, element_tiles);
+
+    auto clusters = hierarchy.clusters;
+
+    const u32 source_id
+        = hierarchy.clusters_size.x * hierarchy.clusters_size.y * PATH_CLUSTER_MAX_NODES;
+    const u32 destination_id = source_id + 1;
+
+    auto  source_cluster_index      = Path_Cluster_Index(hierarchy, source);
+    auto  destination_cluster_index = Path_Cluster_Index(hierarchy, destination);
+    auto& source_cluster            = clusters[source_cluster_index];
+    auto& destination_cluster       = clusters[destination_cluster_index];
+
+    // NOTE: Стоимости от начала до узлов его кластера
+    // и от узлов кластера цели до цели.
+    i32 source_costs[PATH_CLUSTER_MAX_NODES];
+    i32 destination_costs[PATH_CLUSTER_MAX_NODES];
+    i32 direct_cost = i32_max;
+
+    {
+        auto [rect_min, rect_max]
+            = Path_Cluster_Rect(hierarchy, gsize, source_cluster_index);
+        Path_Find_Dijkstra_In_Rect(
+            workspace,
+            gsize,
+            terrain_tiles,
+            element_tiles,
+            rect_min,
+            rect_max,
+            source,
+            false
+        );
+
+        FOR_RANGE (i32, i, source_cluster.nodes_count) {
+            source_costs[i]
+                = Path_Find_Workspace_Cost(workspace, gsize, source_cluster.nodes[i].pos);
+        }
+        if (source_cluster_index == destination_cluster_index)
+            direct_cost = Path_Find_Workspace_Cost(workspace, gsize, destination);
+    }
+    {
+        auto [rect_min, rect_max]
+            = Path_Cluster_Rect(hierarchy, gsize, destination_cluster_index);
+        Path_Find_Dijkstra_In_Rect(
+            workspace,
+            gsize,
+            terrain_tiles,
+            element_tiles,
+            rect_min,
+            rect_max,
+            destination,
+            true
+        );
+
+        FOR_RANGE (i32, i, destination_cluster.nodes_count) {
+            auto pos             = destination_cluster.nodes[i].pos;
+            destination_costs[i] = Path_Find_Workspace_Cost(workspace, gsize, pos);
+        }
+    }
+
+    auto Id_Pos = [&](u32 id) {
+        if (id == source_id)
+            return source;
+        if (id == destination_id)
+            return destination;
+        auto& cluster = clusters[id / PATH_CLUSTER_MAX_NODES];
+        return cluster.nodes[id % PATH_CLUSTER_MAX_NODES].pos;
+    };
+
+    if (hierarchy.generation >= u32_max - 2) {
+        memset(hierarchy.stamps, 0, sizeof(u32) * (destination_id + 1));
+        hierarchy.generation = 0;
+    }
+    hierarchy.generation += 2;
+
+    const auto opened = hierarchy.generation;
+    const auto closed = hierarchy.generation + 1;
+
+    auto& open = hierarchy.open;
+    open.count = 0;
+
+    auto Relax = [&](u32 from, u32 to, i32 g) {
+        auto& stamp = hierarchy.stamps[to];
+        if (stamp == closed || (stamp == opened && hierarchy.g[to] <= g))
+            return;
+
+        Path_Abstract_Node node = {g + Path_Heuristic(Id_Pos(to), destination), g, to};
+        if (stamp == opened)
+            open.Decrease(node);
+        else
+            open.Push(node);
+
+        stamp                 = opened;
+        hierarchy.g[to]       = g;
+        hierarchy.parents[to] = from;
+    };
+
+    hierarchy.stamps[source_id] = opened;
+    hierarchy.g[source_id]      = 0;
+    open.Push({Path_Heuristic(source, destination), 0, source_id});
+
+    bool found = false;
+    while (open.count > 0) {
+        auto node = open.Pop();
+        auto id   = node.id;
+
+        hierarchy.stamps[id] = closed;
+
+        if (id == destination_id) {
+            found = true;
+            break;
+        }
+
+        if (id == source_id) {
+            FOR_RANGE (i32, i, source_cluster.nodes_count) {
+                if (source_costs[i] == i32_max)
+                    continue;
+
+                auto to = source_cluster_index * PATH_CLUSTER_MAX_NODES + i;
+                Relax(id, to, node.g + source_costs[i]);
+            }
+            if (direct_cost != i32_max)
+                Relax(id, destination_id, node.g + direct_cost);
+            continue;
+        }
+
+        auto  cluster_index = id / PATH_CLUSTER_MAX_NODES;
+        auto  local         = id % PATH_CLUSTER_MAX_NODES;
+        auto& cluster       = clusters[cluster_index];
+        auto& cluster_node  = cluster.nodes[local];
+
+        FOR_RANGE (i32, i, cluster.nodes_count) {
+            auto cost = cluster.costs[local * PATH_CLUSTER_MAX_NODES + i];
+            if (i == (i32)local || cost == u16_max)
+                continue;
+
+            Relax(id, cluster_index * PATH_CLUSTER_MAX_NODES + i, node.g + cost);
+        }
+
+        FOR_DIRECTION (dir) {
+            if (!(cluster_node.exits & (1 << (u8)dir)))
+                continue;
+
+            auto  neighbour_pos   = cluster_node.pos + As_Offset(dir);
+            auto  neighbour_index = Path_Cluster_Index(hierarchy, neighbour_pos);
+            auto& neighbour       = clusters[neighbour_index];
+
+            FOR_RANGE (i32, i, neighbour.nodes_count) {
+                if (neighbour.nodes[i].pos != neighbour_pos)
+                    continue;
+
+                auto cost = Path_Tile_Cost(
+                    WORLD_PTR_OFFSET(terrain_tiles, neighbour_pos),
+                    WORLD_PTR_OFFSET(element_tiles, neighbour_pos)
+                );
+                Relax(id, neighbour_index * PATH_CLUSTER_MAX_NODES + i, node.g + cost);
+                break;
+            }
+        }
+
+        if (cluster_index == (u32)destination_cluster_index
+            && destination_costs[local] != i32_max)
+        {
+            Relax(id, destination_id, node.g + destination_costs[local]);
+        }
+    }
+
+    if (!found) {
+        // NOTE: С тайла с ресурсом можно шагнуть через границу кластера
+        // там, где переходов нет. Такие запросы отдаём обычному поиску.
+        if (WORLD_PTR_OFFSET(terrain_tiles, source).resource_amount > 0) {
+            return Find_Path(
+                workspace,
+                trash_arena,
+                gsize,
+                terrain_tiles,
+                element_tiles,
+                source,
+                destination,
+                true
+            );
+        }
+
+        return {false, {}, 0};
+    }
+
+    i32 abstract_count = 1;
+    for (auto id = destination_id; id != source_id; id = hierarchy.parents[id])
+        abstract_count++;
+
+    auto abstract_path = Allocate_Array(trash_arena, u32, abstract_count);
+    {
+        auto id = destination_id;
+        for (i32 i = abstract_count - 1; i >= 0; i--) {
+            abstract_path[i] = id;
+            id               = hierarchy.parents[id];
+        }
+    }
+
+    // NOTE: Уточняем рёбра внутри кластеров.
+    // Переход между кластерами - это шаг на соседний тайл.
+    auto pieces     = Allocate_Array(trash_arena, Path_Find_Result, abstract_count - 1);
+    i32  path_count = 1;
+    FOR_RANGE (i32, i, abstract_count - 1) {
+        auto from          = Id_Pos(abstract_path[i]);
+        auto to            = Id_Pos(abstract_path[i + 1]);
+        auto cluster_index = Path_Cluster_Index(hierarchy, from);
+
+        if (cluster_index != Path_Cluster_Index(hierarchy, to)) {
+            pieces[i] = {true, {}, 0};
+            path_count++;
+            continue;
+        }
+
+        auto [rect_min, rect_max] = Path_Cluster_Rect(hierarchy, gsize, cluster_index);
+        pieces[i]                 = Find_Path_In_Rect(
+            workspace,
+            trash_arena,
+            gsize,
+            terrain_tiles,
+            element_tiles,
+            rect_min,
+            rect_max,
+            from,
+            to,
+            true
+        );
+        Assert(pieces[i].success);
+
+        if (pieces[i].path_count > 0)
+            path_count += pieces[i].path_count - 1;
+    }
+
+    auto path = Allocate_Array(trash_arena, v2i16, path_count);
+    path[0]   = source;
+
+    i32 written = 1;
+    FOR_RANGE (i32, i, abstract_count - 1) {
+        auto& piece = pieces[i];
+        if (piece.path_count == 0) {
+            auto to = Id_Pos(abstract_path[i + 1]);
+            if (to != path[written - 1])
+                path[written++] = to;
+            continue;
+        }
+
+        FOR_RANGE (i32, k, piece.path_count - 1) {
+            path[written++] = piece.path[k + 1];
+        }
+    }
+    Assert(written == path_count);
+
+    return {true, path, path_count};
+}
+
+// NOTE: Поиск пути способом, выбранным в `world.path_find_backend`.
+Path_Find_Result
+Find_Path(World& world, Arena& trash_arena, v2i16 source, v2i16 destination) {
+    switch (world.path_find_backend) {
+    case Path_Find_Backend::Flat:
+        return Find_Path(
+            world.path_find_workspace,
+            trash_arena,
+            world.size,
+            world.terrain_tiles,
+            world.element_tiles,
+            source,
+            destination,
+            true
+        );
+
+    case Path_Find_Backend::Hierarchical:
+        return Find_Path_Hierarchical(
+            world.path_hierarchy,
+            world.path_find_workspace,
+            trash_arena,
+            world.size,
+            world.terrain_tiles,
+            world.element_tiles,
+            source,
+            destination
+        );
+
+    default:
+        INVALID_PATH;
+    }
+
+    return {false, {}, 0};
+}
+
+void Init_Flow_Field(Flow_Field& field, Arena& arena, i32 tiles_count) {
+    field.version    = 0;
+    field.last_used  = 0;
+    field.dist       = Allocate_Array(arena, i32, tiles_count);
+    field.directions = Allocate_Zeros_Array(arena, u8, Ceiled_Division(tiles_count, 4));
+}
+
+void Init_Flow_Field_Cache(Flow_Field_Cache& cache, Arena& arena, i32 tiles_count) {
+    // NOTE: Поля с `version` 0 никогда не валидны.
+    cache.version = 1;
+    cache.uses    = 0;
+
+    Init_Flow_Field(cache.city_halls, arena, tiles_count);
+    for (auto& field : cache.fields)
+        Init_Flow_Field(field, arena, tiles_count);
+}
+
+void Invalidate_Flow_Fields(World& world) {
+    world.flow_fields.version++;
+}
+
+// Dijkstra от `sources` в обратную сторону. Стоимость пути считается так же,
+// как в `Find_Path`: сумма стоимостей тайлов, на которые заходим.
+// На тайлы с ресурсами заходить нельзя (как в `Find_Path`
+// с `avoid_harvestable_resources`), но начинать путь с них можно.
+void Build_Flow_Field(
+    Flow_Field&          field,
+    Path_Find_Workspace& workspace,
+    v2i16                gsize,
+    Terrain_Tile*        terrain_tiles,
+    Element_Tile*        element_tiles,
+    const v2i16*         sources,
+    i32                  sources_count
+) {
+    ZoneScoped;
+
+    i32 tiles_count = gsize.x * gsize.y;
+
+    FOR_RANGE (i32, i, tiles_count) {
+        field.dist[i] = i32_max;
+    }
+
+    auto& open = workspace.open;
+    open.count = 0;
+
+    FOR_RANGE (i32, i, sources_count) {
+        auto source = sources[i];
+        Assert(Pos_Is_In_Bounds(source, gsize));
+
+        WORLD_PTR_OFFSET(field.dist, source) = 0;
+        open.Push({0, 0, source});
+    }
+
+    while (open.count > 0) {
+        auto node = open.Pop();
+        auto pos  = node.pos;
+        if (node.g > WORLD_PTR_OFFSET(field.dist, pos))
+            continue;
+
+        auto& terrain_tile = WORLD_PTR_OFFSET(terrain_tiles, pos);
+        if (terrain_tile.resource_amount > 0)
+            continue;
+
+        // NOTE: Стоимость захода на `pos` с соседнего тайла.
+        auto cost = Path_Tile_Cost(terrain_tile, WORLD_PTR_OFFSET(element_tiles, pos));
+
+        FOR_DIRECTION (dir) {
+            auto new_pos = pos + As_Offset(dir);
+            if (!Pos_Is_In_Bounds(new_pos, gsize))
+                continue;
+
+            auto  g     = node.g + cost;
+            auto& new_g = WORLD_PTR_OFFSET(field.dist, new_pos);
+            if (new_g <= g)
+                continue;
+
+            new_g = g;
+            Set_Parent_Direction(
+                field.directions, new_pos.y * gsize.x + new_pos.x, Opposite(dir)
+            );
+            open.Push({g, g, new_pos});
+        }
+    }
+}
+
+// NOTE: Путь по полю в том же формате, что и у `Find_Path`.
+Path_Find_Result
+Flow_Field_Path(const Flow_Field& field, Arena& trash_arena, v2i16 gsize, v2i16 source) {
+    auto dist = WORLD_PTR_OFFSET(field.dist, source);
+    if (dist == i32_max)
+        return {false, {}, 0};
+    if (dist == 0)
+        return {true, {}, 0};
+
+    i32 path_count = 1;
+    for (auto pos = source; WORLD_PTR_OFFSET(field.dist, pos) > 0; path_count++) {
+        auto dir = Get_Parent_Direction(field.directions, pos.y * gsize.x + pos.x);
+        pos      = pos + As_Offset(dir);
+    }
+
+    auto path = Allocate_Array(trash_arena, v2i16, path_count);
+
+    auto pos = source;
+    FOR_RANGE (i32, i, path_count - 1) {
+        path[i]  = pos;
+        auto dir = Get_Parent_Direction(field.directions, pos.y * gsize.x + pos.x);
+        pos      = pos + As_Offset(dir);
+    }
+    path[path_count - 1] = pos;
+
+    return {true, path, path_count};
+}
+
+// Путь до `destination` по закэшированному полю.
+// Поле живёт до изменения тайлов, см. `Flow_Field_Cache`.
+Path_Find_Result Find_Path_With_Flow_Field(
+    World& world,
+    Arena& trash_arena,
+    v2i16  source,
+    v2i16  destination
+) {
+    if (source == destination)
+        return {true, {}, 0};
+
+    auto& cache = world.flow_fields;
+    cache.uses++;
+
+    Flow_Field* field = nullptr;
+    for (auto& f : cache.fields) {
+        if (f.version == cache.version && f.destination == destination) {
+            field = &f;
+            break;
+        }
+    }
+
+    if (field == nullptr) {
+        if (cache.misses_version != cache.version) {
+            cache.misses_version = cache.version;
+            cache.misses_count   = 0;
+        }
+
+        Flow_Field_Miss* miss = nullptr;
+        FOR_RANGE (i32, i, MIN(cache.misses_count, FLOW_FIELDS_MISSES_SIZE)) {
+            if (cache.misses[i].destination == destination) {
+                miss = cache.misses + i;
+                break;
+            }
+        }
+
+        if (miss == nullptr) {
+            miss = cache.misses + (cache.misses_count % FLOW_FIELDS_MISSES_SIZE);
+            *miss = {destination, 0};
+            cache.misses_count++;
+        }
+
+        miss->count++;
+        if (miss->count < FLOW_FIELD_BUILD_AFTER_MISSES) {
+            return Find_Path(world, trash_arena, source, destination);
+        }
+
+        // NOTE: Вытесняем поле, которое дольше всех не использовалось.
+        field = cache.fields;
+        for (auto& f : cache.fields) {
+            if (f.version != cache.version) {
+                field = &f;
+                break;
+            }
+            if (f.last_used < field->last_used)
+                field = &f;
+        }
+
+        Build_Flow_Field(
+            *field,
+            world.path_find_workspace,
+            world.size,
+            world.terrain_tiles,
+            world.element_tiles,
+            &destination,
+            1
+        );
+        field->destination = destination;
+        field->version     = cache.version;
+    }
+
+    field->last_used = cache.uses;
+    return Flow_Field_Path(*field, trash_arena, world.size, source);
+}
+
+// Путь до ближайшей ратуши.
+std::tuple<Building_ID, Path_Find_Result>
+Find_Path_To_Nearest_City_Hall(World& world, Arena& trash_arena, v2i16 source) {
+    Assert(world.city_halls.count > 0);
+
+    auto& cache = world.flow_fields;
+    auto& field = cache.city_halls;
+    auto  gsize = world.size;
+
+    if (field.version != cache.version) {
+        TEMP_USAGE(trash_arena);
+
+        auto sources = Allocate_Array(trash_arena, v2i16, world.city_halls.count);
+        FOR_RANGE (i32, i, world.city_halls.count) {
+            auto& building = *Get_Building(world, world.city_halls.ids[i]);
+            sources[i]     = building.pos;
+        }
+
+        Build_Flow_Field(
+            field,
+            world.path_find_workspace,
+            gsize,
+            world.terrain_tiles,
+            world.element_tiles,
+            sources,
+            world.city_halls.count
+        );
+        field.version = cache.version;
+    }
+
+    auto result = Flow_Field_Path(field, trash_arena, gsize, source);
+    if (!result.success)
+        return {Building_ID_Missing, result};
+
+    auto destination
+        = (result.path_count > 0) ? result.path[result.path_count - 1] : source;
+    auto& tile = WORLD_PTR_OFFSET(world.element_tiles, destination);
+    Assert(tile.type == Element_Tile_Type::Building);
+
+    return {tile.building_id, result};
 }
 
 Terrain_Tile& Get_Terrain_Tile(World& world, v2i16 pos) {
@@ -153,6 +1230,7 @@ void Deinit_Queue(Queue<T>& container, MCTX) {
 
     container.count     = 0;
     container.max_count = 0;
+    container.head      = 0;
 }
 
 template <typename T>
@@ -163,6 +1241,7 @@ void Deinit_Sparse_Array_Of_Ids(Sparse_Array_Of_Ids<T>& container, MCTX) {
         Assert(container.max_count != 0);
         FREE(container.ids, sizeof(T) * container.max_count);
     }
+    container.sparse.Deinit(ctx);
 
     container.count     = 0;
     container.max_count = 0;
@@ -183,6 +1262,8 @@ void Deinit_Sparse_Array(Sparse_Array<T, U>& container, MCTX) {
         FREE(container.ids, sizeof(T) * container.max_count);
         FREE(container.base, sizeof(U) * container.max_count);
     }
+    container.sparse.Deinit(ctx);
+
     container.count     = 0;
     container.max_count = 0;
 }
@@ -200,32 +1281,85 @@ void Deinit_Vector(Vector<T>& container, MCTX) {
     container.max_count = 0;
 }
 
-void Assert_No_Collision(Entity_ID id, Entity_ID mask) {
-    Assert((id & mask) == 0);
+Entity_ID Create_Entity(Entity_Slots& slots, MCTX) {
+    u32 index = 0;
+    if (slots.free.count >= ENTITY_SLOTS_MIN_FREE) {
+        index = slots.free.Dequeue();
+    }
+    else {
+        if (slots.count == slots.max_count) {
+            CTX_ALLOCATOR;
+
+            u32 new_max_count = MAX(slots.max_count * 2, 64);
+            Assert(new_max_count <= (1u << ENTITY_INDEX_BITS));
+
+            auto size        = sizeof(u16) * new_max_count;
+            auto generations = rcast<u16*>(ALLOC(size));
+            if (slots.generations != nullptr) {
+                memcpy(generations, slots.generations, sizeof(u16) * slots.max_count);
+                FREE(slots.generations, sizeof(u16) * slots.max_count);
+            }
+
+            slots.generations = generations;
+            slots.max_count   = new_max_count;
+        }
+
+        index                    = slots.count++;
+        slots.generations[index] = 1;
+    }
+
+    return Make_Entity_ID(index, slots.generations[index]);
+}
+
+bool Entity_Is_Alive(const Entity_Slots& slots, Entity_ID id) {
+    auto index = Entity_Index(id);
+    if ((id & Entity_ID_Missing) || index >= slots.count)
+        return false;
+
+    return slots.generations[index] == Entity_Generation(id);
+}
+
+void Destroy_Entity(Entity_Slots& slots, Entity_ID id, MCTX) {
+    Assert(Entity_Is_Alive(slots, id));
+
+    auto  index      = Entity_Index(id);
+    auto& generation = slots.generations[index];
+
+    // NOTE: Поколение 0 пропускаем, см. `Entity_Slots::generations`.
+    generation++;
+    if (generation >= (1u << ENTITY_GENERATION_BITS))
+        generation = 1;
+
+    *slots.free.Enqueue(ctx) = index;
+}
+
+void Deinit_Entity_Slots(Entity_Slots& slots, MCTX) {
+    CTX_ALLOCATOR;
+
+    if (slots.generations != nullptr)
+        FREE(slots.generations, sizeof(u16) * slots.max_count);
+
+    Deinit_Queue(slots.free, ctx);
+
+    slots.generations = nullptr;
+    slots.count       = 0;
+    slots.max_count   = 0;
 }
 
-Human_ID Next_Human_ID(Entity_ID& last_entity_id) {
-    auto ent = ++last_entity_id;
-    Assert_No_Collision(ent, Human::component_mask);
-    return ent | Human::component_mask;
+Human_ID Next_Human_ID(Entity_Slots& slots, MCTX) {
+    return {Create_Entity(slots, ctx)};
 }
 
-Building_ID Next_Building_ID(Entity_ID& last_entity_id) {
-    auto ent = ++last_entity_id;
-    Assert_No_Collision(ent, Building::component_mask);
-    return ent | Building::component_mask;
+Building_ID Next_Building_ID(Entity_Slots& slots, MCTX) {
+    return {Create_Entity(slots, ctx)};
 }
 
-Graph_Segment_ID Next_Graph_Segment_ID(Entity_ID& last_entity_id) {
-    auto ent = ++last_entity_id;
-    Assert_No_Collision(ent, Graph_Segment::component_mask);
-    return ent | Graph_Segment::component_mask;
+Graph_Segment_ID Next_Graph_Segment_ID(Entity_Slots& slots, MCTX) {
+    return {Create_Entity(slots, ctx)};
 }
 
-World_Resource_ID Next_World_Resource_ID(Entity_ID& last_entity_id) {
-    auto ent = ++last_entity_id;
-    Assert_No_Collision(ent, World_Resource::component_mask);
-    return ent | World_Resource::component_mask;
+World_Resource_ID Next_World_Resource_ID(Entity_Slots& slots, MCTX) {
+    return {Create_Entity(slots, ctx)};
 }
 
 void Place_Building(
@@ -239,7 +1373,7 @@ void Place_Building(
     auto  gsize = world.size;
     Assert(Pos_Is_In_Bounds(pos, gsize));
 
-    auto     id = Next_Building_ID(world.last_entity_id);
+    auto     id = Next_Building_ID(world.entities, ctx);
     Building b{};
     b.pos        = pos;
     b.scriptable = scriptable;
@@ -247,9 +1381,8 @@ void Place_Building(
         b.remaining_construction_points = scriptable->construction_points;
 
     {
-        auto [pid, pvalue] = world.buildings.Add(ctx);
-        *pid               = id;
-        *pvalue            = b;
+        auto [_, pvalue] = world.buildings.Add(id, ctx);
+        *pvalue          = b;
     }
 
     if (built) {
@@ -258,9 +1391,8 @@ void Place_Building(
         City_Hall c{};
         c.time_since_human_was_created = f32_inf;
         {
-            auto [pid, pvalue] = world.city_halls.Add(ctx);
-            *pid               = id;
-            *pvalue            = c;
+            auto [_, pvalue] = world.city_halls.Add(id, ctx);
+            *pvalue          = c;
         }
     }
     else {
@@ -271,13 +1403,15 @@ void Place_Building(
                 = World_Resource_To_Book(resource, count, id);
         }
 
-        *world.not_constructed_buildings.Add(ctx) = id;
+        world.not_constructed_buildings.Add(id, ctx);
     }
 
     auto& tile = *(world.element_tiles + gsize.x * pos.y + pos.x);
     Assert(tile.type == Element_Tile_Type::None);
     tile.type        = Element_Tile_Type::Building;
     tile.building_id = id;
+
+    Invalidate_Flow_Fields(world);
 }
 
 // void Update_Building__Not_Constructed(Building& building, float dt) {
@@ -291,13 +1425,51 @@ void Place_Building(
 //     }
 // }
 
+struct Human_Update_Commands;
+
 // TODO: rename to Human_Controller_Dependencies
 struct Human_Data {
     Game*  game;
     World* world;
     Arena* trash_arena;
+
+    // NOTE: Задан при параллельном обновлении чувачков (`Update_Humans_Parallel`).
+    Human_Update_Commands* commands;
+};
+
+enum class Human_Update_Command_Type {
+    // NOTE: Чувачок обновится заново в последовательном проходе.
+    Update_Serially,
+    Remove,
+};
+
+struct Human_Update_Command {
+    Human_ID                  id   = {};
+    Human_Update_Command_Type type = {};
+};
+
+// NOTE: Буфер команд одной задачи `Update_Humans_Parallel`.
+// Команды применяются после синхронизации в порядке задач,
+// т.е. в том же порядке, в котором их выполнил бы последовательный проход.
+struct Human_Update_Commands {
+    Human_Update_Command* items = {};
+    i32                   count = {};
+
+    // NOTE: Обновление текущего чувачка трогает общее состояние мира
+    // (смена состояния, поиск пути), поэтому его результат выбрасывается.
+    bool deferred = {};
 };
 
+// NOTE: Возвращает true, если дальше идёт изменение общего состояния мира,
+// которое при параллельном обновлении нужно отложить до последовательного прохода.
+bool Human_Update_Deferred(const Human_Data& data) {
+    if (data.commands == nullptr)
+        return false;
+
+    data.commands->deferred = true;
+    return true;
+}
+
 void Root_Set_Human_State(
     Human&            human,
     Human_States      new_state,
@@ -305,23 +1477,149 @@ void Root_Set_Human_State(
     MCTX
 );
 
-void Advance_Moving_To(Human_Moving_Component& moving) {
+u32 Allocate_Path_Block(Path_Pool& pool, MCTX) {
+    CTX_ALLOCATOR;
+
+    if (pool.free_list != 0) {
+        auto result    = pool.free_list;
+        pool.free_list = pool.blocks[result].next;
+        return result;
+    }
+
+    if (pool.count == pool.max_count) {
+        auto old_max_count = pool.max_count;
+        auto new_max_count = MAX(old_max_count * 2, (u32)256);
+        Assert(old_max_count < new_max_count);  // NOTE: Ловим overflow
+
+        auto blocks = (Path_Block*)ALLOC(sizeof(Path_Block) * new_max_count);
+        if (pool.blocks != nullptr) {
+            memcpy(blocks, pool.blocks, sizeof(Path_Block) * pool.count);
+            FREE(pool.blocks, sizeof(Path_Block) * old_max_count);
+        }
+
+        pool.blocks    = blocks;
+        pool.max_count = new_max_count;
+
+        // NOTE: Блок 0 не выдаётся - это "блока нет".
+        if (pool.count == 0)
+            pool.count = 1;
+    }
+
+    return pool.count++;
+}
+
+void Free_Path(Path_Pool& pool, Human_Path& path) {
+    auto block = path.first;
+    while (block != 0) {
+        auto next               = pool.blocks[block].next;
+        pool.blocks[block].next = pool.free_list;
+        pool.free_list          = block;
+        block                   = next;
+    }
+
+    path = {};
+}
+
+void Deinit_Path_Pool(Path_Pool& pool, MCTX) {
+    CTX_ALLOCATOR;
+
+    if (pool.blocks != nullptr)
+        FREE(pool.blocks, sizeof(Path_Block) * pool.max_count);
+
+    pool = {};
+}
+
+// NOTE: Кодирует путь из соседних клеток: первая клетка и направление каждого шага.
+void Encode_Path(
+    Path_Pool&   pool,
+    Human_Path&  path,
+    const v2i16* tiles,
+    i32          tiles_count,
+    MCTX
+) {
+    Assert(path.first == 0);
+    Assert(tiles_count > 0);
+
+    path.count = tiles_count;
+    path.next  = tiles[0];
+
+    // NOTE: `Direction` по смещению, индекс - `(dx + 1) + 3 * (dy + 1)`.
+    const u8 directions[9] = {0, 3, 0, 2, 0, 0, 0, 1, 0};
+
+    u32 block = 0;
+    u8* steps = nullptr;
+    u8  byte  = 0;
+    for (i32 i = 1; i < tiles_count; i++) {
+        auto step = (u32)(i - 1) % PATH_BLOCK_STEPS;
+        if (step == 0) {
+            auto new_block = Allocate_Path_Block(pool, ctx);
+            if (block == 0)
+                path.first = new_block;
+            else
+                pool.blocks[block].next = new_block;
+
+            block                   = new_block;
+            steps                   = pool.blocks[block].steps;
+            pool.blocks[block].next = 0;
+        }
+
+        auto offset = tiles[i] - tiles[i - 1];
+        auto dir    = directions[(offset.x + 1) + 3 * (offset.y + 1)];
+        Assert(abs(offset.x) + abs(offset.y) == 1);
+        Assert(As_Offset((Direction)dir) == offset);
+
+        byte |= (u8)(dir << ((step % 4) * 2));
+        if (step % 4 == 3 || i == tiles_count - 1) {
+            steps[step / 4] = byte;
+            byte            = 0;
+        }
+    }
+
+    path.block = path.first;
+    path.step  = 0;
+}
+
+v2i16 Dequeue_Path_Tile(const Path_Pool& pool, Human_Path& path) {
+    Assert(path.count > 0);
+
+    auto result = path.next;
+    path.count--;
+
+    if (path.count > 0) {
+        Assert(path.block != 0);
+
+        auto byte = pool.blocks[path.block].steps[path.step / 4];
+        auto dir  = (byte >> ((path.step % 4) * 2)) & 0b11;
+        path.next = path.next + v2i16_adjacent_offsets[dir];
+
+        path.step++;
+        if (path.step == PATH_BLOCK_STEPS) {
+            path.block = pool.blocks[path.block].next;
+            path.step  = 0;
+        }
+    }
+
+    return result;
+}
+
+void Advance_Moving_To(const Path_Pool& pool, Human_Moving_Component& moving) {
     if (moving.path.count == 0) {
         moving.progress = 0;
         moving.to.reset();
     }
     else {
-        moving.to = moving.path.Dequeue();
+        moving.to = Dequeue_Path_Tile(pool, moving.path);
     }
 }
 
 void Human_Moving_Component_Add_Path(
+    Path_Pool&              pool,
     Human_Moving_Component& moving,
     v2i16*                  path,
     i32                     path_count,
     MCTX
 ) {
-    moving.path.Reset();
+    Free_Path(pool, moving.path);
 
     if (moving.elapsed == 0)
         moving.to.reset();
@@ -334,39 +1632,30 @@ void Human_Moving_Component_Add_Path(
             path_count--;
         }
 
-        memcpy(  //
-            moving.path.Bulk_Enqueue(path_count, ctx),
-            path,
-            sizeof(*path) * path_count
-        );
+        if (path_count > 0)
+            Encode_Path(pool, moving.path, path, path_count, ctx);
     }
 
     if (!moving.to.has_value())
-        Advance_Moving_To(moving);
+        Advance_Moving_To(pool, moving);
 }
 
 Building* Strict_Query_Building(World& world, Building_ID id) {
     Assert(id != Building_ID_Missing);
+    Assert(Entity_Is_Alive(world.entities, id.id));
 
-    for (auto [instance_id, instance] : Iter(&world.buildings)) {
-        if (instance_id == id)
-            return instance;
-    }
-
-    INVALID_PATH;
-    return nullptr;
+    auto result = world.buildings.Find(id);
+    Assert(result != nullptr);
+    return result;
 }
 
 Human* Strict_Query_Human(World& world, Human_ID id) {
     Assert(id != Human_ID_Missing);
+    Assert(Entity_Is_Alive(world.entities, id.id));
 
-    for (auto [instance_id, instance] : Iter(&world.humans)) {
-        if (instance_id == id)
-            return instance;
-    }
-
-    INVALID_PATH;
-    return nullptr;
+    auto result = world.humans.Find(id);
+    Assert(result != nullptr);
+    return result;
 }
 
 Graph_Segment* Query_Graph_Segment(World& world, Graph_Segment_ID id) {
@@ -404,7 +1693,7 @@ HumanState_OnEnter_function(HumanState_MovingInTheWorld_OnEnter) {
         // );
     }
 
-    human.moving.path.Reset();
+    Free_Path(data.world->human_paths, human.moving.path);
 
     HumanState_MovingInTheWorld_UpdateStates(
         state, human, data, Building_ID_Missing, nullptr, ctx
@@ -416,7 +1705,7 @@ HumanState_OnExit_function(HumanState_MovingInTheWorld_OnExit) {
     LOG_SCOPE;
 
     human.state_moving_in_the_world = Moving_In_The_World_State::None;
-    human.moving.path.Reset();
+    Free_Path(data.world->human_paths, human.moving.path);
 
     if (human.type == Human_Type::Employee) {
         Assert(human.building_id != Building_ID_Missing);
@@ -502,13 +1791,19 @@ HumanState_UpdateStates_function(HumanState_MovingInTheWorld_UpdateStates) {
         if (Graph_Contains(segment.graph, human.moving.pos)
             && (Graph_Node(segment.graph, human.moving.pos) != 0))
         {
-            human.moving.path.Reset();
+            if (Human_Update_Deferred(data))
+                return;
+
+            Free_Path(world.human_paths, human.moving.path);
             Root_Set_Human_State(human, Human_States::MovingInsideSegment, data, ctx);
             return;
         }
 
         auto moving_to_destination = Moving_In_The_World_State::Moving_To_Destination;
         if (human.state_moving_in_the_world != moving_to_destination) {
+            if (Human_Update_Deferred(data))
+                return;
+
             LOG_DEBUG(
                 "Setting human.state_moving_in_the_world = "
                 "Moving_In_The_World_State::Moving_To_Destination"
@@ -518,6 +1813,8 @@ HumanState_UpdateStates_function(HumanState_MovingInTheWorld_UpdateStates) {
 
             Assert(data.trash_arena != nullptr);
 
+            TEMP_USAGE(*data.trash_arena);
+
             if (human.moving.elapsed == 0)
                 human.moving.to.reset();
             auto moving_from = human.moving.to.value_or(human.moving.pos);
@@ -525,20 +1822,16 @@ HumanState_UpdateStates_function(HumanState_MovingInTheWorld_UpdateStates) {
             auto segment_center = Assert_Deref(segment.graph.data).center;
             if (segment_center != moving_from) {
                 LOG_DEBUG("Calculating path to the segment");
-                auto [success, path, path_count] = Find_Path(
-                    *data.trash_arena,
-                    world.size,
-                    world.terrain_tiles,
-                    world.element_tiles,
-                    moving_from,
-                    segment_center,
-                    true
+                auto [success, path, path_count] = Find_Path_With_Flow_Field(
+                    world, *data.trash_arena, moving_from, segment_center
                 );
 
                 Assert(success);
                 Assert(path_count > 0);
 
-                Human_Moving_Component_Add_Path(human.moving, path, path_count, ctx);
+                Human_Moving_Component_Add_Path(
+                    world.human_paths, human.moving, path, path_count, ctx
+                );
             }
         }
     }
@@ -554,6 +1847,9 @@ HumanState_UpdateStates_function(HumanState_MovingInTheWorld_UpdateStates) {
         // }
 
         if (old_building_id != human.building_id) {
+            if (Human_Update_Deferred(data))
+                return;
+
             Assert(data.trash_arena != nullptr);
 
             TEMP_USAGE(*data.trash_arena);
@@ -562,26 +1858,25 @@ HumanState_UpdateStates_function(HumanState_MovingInTheWorld_UpdateStates) {
                 human.moving.to.reset();
             auto moving_from = human.moving.to.value_or(human.moving.pos);
 
-            auto [success, path, path_count] = Find_Path(
-                *data.trash_arena,
-                world.size,
-                world.terrain_tiles,
-                world.element_tiles,
-                moving_from,
-                building.pos,
-                true
+            auto [success, path, path_count] = Find_Path_With_Flow_Field(
+                world, *data.trash_arena, moving_from, building.pos
             );
 
             Assert(success);
             Assert(path_count > 0);
 
-            Human_Moving_Component_Add_Path(human.moving, path, path_count, ctx);
+            Human_Moving_Component_Add_Path(
+                world.human_paths, human.moving, path, path_count, ctx
+            );
         }
     }
     else if ( //
         human.state_moving_in_the_world
         != Moving_In_The_World_State::Moving_To_The_City_Hall)
     {
+        if (Human_Update_Deferred(data))
+            return;
+
         LOG_DEBUG(
             "human.state_moving_in_the_world = "
             "Moving_In_The_World_State::Moving_To_The_City_Hall"
@@ -589,32 +1884,25 @@ HumanState_UpdateStates_function(HumanState_MovingInTheWorld_UpdateStates) {
         human.state_moving_in_the_world
             = Moving_In_The_World_State::Moving_To_The_City_Hall;
 
-        Assert(world.city_halls.count > 0);
-        auto      city_hall_id = world.city_halls.ids[0];
-        Building& city_hall    = *Strict_Query_Building(world, city_hall_id);
-
-        human.building_id = city_hall_id;
-
         TEMP_USAGE(*data.trash_arena);
 
         if (human.moving.elapsed == 0)
             human.moving.to.reset();
 
-        LOG_DEBUG("Calculating path to the city hall");
-        auto [success, path, path_count] = Find_Path(
-            *data.trash_arena,
-            world.size,
-            world.terrain_tiles,
-            world.element_tiles,
-            human.moving.to.value_or(human.moving.pos),
-            city_hall.pos,
-            true
+        LOG_DEBUG("Calculating path to the nearest city hall");
+        auto [city_hall_id, path_result] = Find_Path_To_Nearest_City_Hall(
+            world, *data.trash_arena, human.moving.to.value_or(human.moving.pos)
         );
+        auto [success, path, path_count] = path_result;
 
         Assert(success);
         Assert(path_count > 0);
 
-        Human_Moving_Component_Add_Path(human.moving, path, path_count, ctx);
+        human.building_id = city_hall_id;
+
+        Human_Moving_Component_Add_Path(
+            world.human_paths, human.moving, path, path_count, ctx
+        );
     }
 }
 
@@ -650,19 +1938,15 @@ HumanState_OnEnter_function(HumanState_MovingInsideSegment_OnEnter) {
             human.moving.to.reset();
         auto moving_from = human.moving.to.value_or(human.moving.pos);
 
-        auto [success, path, path_count] = Find_Path(
-            *data.trash_arena,
-            world.size,
-            world.terrain_tiles,
-            world.element_tiles,
-            moving_from,
-            Assert_Deref(segment.graph.data).center,
-            true
+        auto [success, path, path_count] = Find_Path_With_Flow_Field(
+            world, *data.trash_arena, moving_from, Assert_Deref(segment.graph.data).center
         );
 
         Assert(success);
 
-        Human_Moving_Component_Add_Path(human.moving, path, path_count, ctx);
+        Human_Moving_Component_Add_Path(
+            world.human_paths, human.moving, path, path_count, ctx
+        );
     }
     else {
         // TODO: moving.path.Reset(), moving.to.reset() и идём до вертекса с ресурсом
@@ -673,7 +1957,7 @@ HumanState_OnExit_function(HumanState_MovingInsideSegment_OnExit) {
     CTX_LOGGER;
     LOG_SCOPE;
 
-    human.moving.path.Reset();
+    Free_Path(data.world->human_paths, human.moving.path);
 }
 
 HumanState_Update_function(HumanState_MovingInsideSegment_Update) {
@@ -707,7 +1991,10 @@ HumanState_UpdateStates_function(HumanState_MovingInsideSegment_UpdateStates) {
     LOG_SCOPE;
 
     if (human.segment_id == Graph_Segment_ID_Missing) {
-        human.moving.path.Reset();
+        if (Human_Update_Deferred(data))
+            return;
+
+        Free_Path(data.world->human_paths, human.moving.path);
         Root_Set_Human_State(human, Human_States::MovingInTheWorld, data, ctx);
         return;
     }
@@ -722,7 +2009,11 @@ HumanState_UpdateStates_function(HumanState_MovingInsideSegment_UpdateStates) {
             return;
         }
 
-        human.moving.path.Reset();
+        // NOTE: Освобождение пути меняет общий `world.human_paths`.
+        if (Human_Update_Deferred(data))
+            return;
+
+        Free_Path(data.world->human_paths, human.moving.path);
     }
 }
 
@@ -853,6 +2144,9 @@ void Root_Set_Human_State(
     const Human_Data& data,
     MCTX
 ) {
+    if (Human_Update_Deferred(data))
+        return;
+
     CTX_LOGGER;
     LOG_SCOPE;
     auto old_state_value = human.state;
@@ -899,19 +2193,18 @@ std::tuple<Human_ID, Human*> Create_Human_Transporter(
     human.moving.progress = 0;
     human.moving.from     = pos;
     human.moving.to.reset();
-    human.moving.path.count         = 0;
-    human.moving.path.max_count     = 0;
-    human.moving.path.base          = nullptr;
+    human.moving.path               = {};
     human.segment_id                = segment_id;
     human.type                      = Human_Type::Transporter;
     human.state                     = Human_States::None;
     human.state_moving_in_the_world = Moving_In_The_World_State::None;
     human.building_id               = Building_ID_Missing;
 
-    auto [human_id, human_p] = world.humans_to_add.Add(ctx);
-
-    *human_id = Next_Human_ID(world.last_entity_id);
-    *human_p  = human;
+    auto [human_id, human_p] = world.humans_to_add.Add(  //
+        Next_Human_ID(world.entities, ctx),
+        ctx
+    );
+    *human_p = human;
 
     Root_Set_Human_State(*human_p, Human_States::MovingInTheWorld, data, ctx);
 
@@ -1001,8 +2294,351 @@ void Process_Humans_Moving_To_City_Halls() {
     // TODO:
 }
 
+// NOTE: Переносит первые `count` элементов в новый массив на `new_max_count`.
+template <typename T>
+void Enlarge_Array(T*& array, i32 count, i32 old_max_count, i32 new_max_count, MCTX) {
+    CTX_ALLOCATOR;
+
+    auto new_array = (T*)ALLOC(sizeof(T) * new_max_count);
+    if (array != nullptr) {
+        memcpy(new_array, array, sizeof(T) * count);
+        FREE(array, sizeof(T) * old_max_count);
+    }
+    array = new_array;
+}
+
+void Reserve_Human_Movement_Columns(Human_Movement_Columns& columns, i32 count, MCTX) {
+    if (count <= columns.max_count)
+        return;
+
+    auto n   = columns.count;
+    auto old = columns.max_count;
+    auto max = MAX(count, MAX(old * 2, 64));
+
+    Enlarge_Array(columns.elapsed, n, old, max, ctx);
+    Enlarge_Array(columns.progress, n, old, max, ctx);
+    Enlarge_Array(columns.moving, n, old, max, ctx);
+    Enlarge_Array(columns.crossed, n, old, max, ctx);
+
+    columns.max_count = max;
+}
+
+void Set_Human_Movement(Human_Movement_Columns& columns, i32 i, const Human& human) {
+    Assert(i >= 0);
+    Assert(i < columns.count);
+
+    columns.elapsed[i]  = human.moving.elapsed;
+    columns.progress[i] = human.moving.progress;
+    columns.moving[i]   = human.moving.to.has_value() ? ~0u : 0;
+    columns.crossed[i]  = 0;
+}
+
+void Add_Human_Movement(Human_Movement_Columns& columns, const Human& human, MCTX) {
+    Reserve_Human_Movement_Columns(columns, columns.count + 1, ctx);
+    columns.count++;
+    Set_Human_Movement(columns, columns.count - 1, human);
+}
+
+// NOTE: Повторяет перестановку `Sparse_Array::Unstable_Remove`.
+void Remove_Human_Movement(Human_Movement_Columns& columns, i32 i) {
+    Assert(i >= 0);
+    Assert(i < columns.count);
+
+    auto last = columns.count - 1;
+    if (i != last) {
+        columns.elapsed[i]  = columns.elapsed[last];
+        columns.progress[i] = columns.progress[last];
+        columns.moving[i]   = columns.moving[last];
+        columns.crossed[i]  = columns.crossed[last];
+    }
+    columns.count--;
+}
+
+void Rebuild_Human_Movement_Columns(World& world, MCTX) {
+    auto& columns = world.human_movement;
+
+    Reserve_Human_Movement_Columns(columns, world.humans.count, ctx);
+    columns.count = world.humans.count;
+    columns.dirty = false;
+
+    FOR_RANGE (i32, i, columns.count) {
+        Set_Human_Movement(columns, i, world.humans.base[i]);
+    }
+}
+
+void Deinit_Human_Movement_Columns(Human_Movement_Columns& columns, MCTX) {
+    CTX_ALLOCATOR;
+
+    if (columns.max_count > 0) {
+        FREE(columns.elapsed, sizeof(f32) * columns.max_count);
+        FREE(columns.progress, sizeof(f32) * columns.max_count);
+        FREE(columns.moving, sizeof(u32) * columns.max_count);
+        FREE(columns.crossed, sizeof(u32) * columns.max_count);
+    }
+
+    columns = {};
+}
+
+// NOTE: Продвигает `elapsed` и `progress` идущих чувачков [begin, end).
+// Дошедших до `moving.to` только помечает в `crossed`,
+// сам переход на тайл делает `Update_Human_Moving_Component`.
+//
+// Арифметика та же, что и у скалярного кода (IEEE сложение, вычитание,
+// деление и `MIN`), поэтому результат не зависит от того,
+// попал чувачок в SSE2 проход или в хвост.
+void Advance_Human_Movement(
+    Human_Movement_Columns& columns,
+    i32                     begin,
+    i32                     end,
+    f32                     dt,
+    f32                     duration
+) {
+    ZoneScoped;
+
+    Assert(begin >= 0);
+    Assert(end <= columns.count);
+
+    auto i = begin;
+
+#if BF_SSE2
+    const auto dt4       = _mm_set1_ps(dt);
+    const auto duration4 = _mm_set1_ps(duration);
+    const auto one4      = _mm_set1_ps(1.0f);
+
+    for (; i + 4 <= end; i += 4) {
+        auto moving   = _mm_castsi128_ps(_mm_loadu_si128((__m128i*)(columns.moving + i)));
+        auto elapsed  = _mm_loadu_ps(columns.elapsed + i);
+        auto progress = _mm_loadu_ps(columns.progress + i);
+
+        auto new_elapsed = _mm_add_ps(elapsed, dt4);
+        auto crossed     = _mm_and_ps(moving, _mm_cmpgt_ps(new_elapsed, duration4));
+        new_elapsed      = _mm_sub_ps(new_elapsed, _mm_and_ps(crossed, duration4));
+
+        // NOTE: `_mm_min_ps(a, b)` - это `a < b ? a : b`, как и `MIN`.
+        auto new_progress = _mm_min_ps(one4, _mm_div_ps(new_elapsed, duration4));
+
+        // NOTE: У стоящих чувачков ничего не меняется.
+        elapsed = _mm_or_ps(
+            _mm_and_ps(moving, new_elapsed), _mm_andnot_ps(moving, elapsed)
+        );
+        progress = _mm_or_ps(
+            _mm_and_ps(moving, new_progress), _mm_andnot_ps(moving, progress)
+        );
+
+        _mm_storeu_ps(columns.elapsed + i, elapsed);
+        _mm_storeu_ps(columns.progress + i, progress);
+        _mm_storeu_si128((__m128i*)(columns.crossed + i), _mm_castps_si128(crossed));
+    }
+#endif
+
+    for (; i < end; i++) {
+        columns.crossed[i] = 0;
+        if (!columns.moving[i])
+            continue;
+
+        auto elapsed = columns.elapsed[i] + dt;
+        if (elapsed > duration) {
+            elapsed -= duration;
+            columns.crossed[i] = ~0u;
+        }
+
+        columns.elapsed[i]  = elapsed;
+        columns.progress[i] = MIN(1.0f, elapsed / duration);
+    }
+}
+
+u32 Allocate_Human_Timer(Human_Timer_Wheel& wheel, MCTX) {
+    CTX_ALLOCATOR;
+
+    if (wheel.free_list != 0) {
+        auto result     = wheel.free_list;
+        wheel.free_list = wheel.timers[result].next;
+        return result;
+    }
+
+    if (wheel.count == wheel.max_count) {
+        auto old_max_count = wheel.max_count;
+        auto new_max_count = MAX(old_max_count * 2, (u32)256);
+        Assert(old_max_count < new_max_count);  // NOTE: Ловим overflow
+
+        auto timers = (Human_Timer*)ALLOC(sizeof(Human_Timer) * new_max_count);
+        if (wheel.timers != nullptr) {
+            memcpy(timers, wheel.timers, sizeof(Human_Timer) * wheel.count);
+            FREE(wheel.timers, sizeof(Human_Timer) * old_max_count);
+        }
+
+        wheel.timers    = timers;
+        wheel.max_count = new_max_count;
+
+        // NOTE: Таймер 0 не выдаётся - это "таймера нет".
+        if (wheel.count == 0)
+            wheel.count = 1;
+    }
+
+    return wheel.count++;
+}
+
+void Free_Human_Timer(Human_Timer_Wheel& wheel, u32 timer) {
+    Assert(timer != 0);
+    wheel.timers[timer].next = wheel.free_list;
+    wheel.free_list          = timer;
+}
+
+void Link_Human_Timer(Human_Timer_Wheel& wheel, u32 timer) {
+    auto tick = wheel.timers[timer].tick;
+    Assert(tick >= wheel.now);
+
+    i32 level = 0;
+    for (; level < HUMAN_TIMER_WHEEL_LEVELS - 1; level++) {
+        auto shift = HUMAN_TIMER_WHEEL_SLOTS_BITS * (level + 1);
+        if ((tick >> shift) == (wheel.now >> shift))
+            break;
+    }
+
+    auto  shift = HUMAN_TIMER_WHEEL_SLOTS_BITS * level;
+    auto  slot  = (tick >> shift) & (HUMAN_TIMER_WHEEL_SLOTS - 1);
+    auto& head  = wheel.slots[level][slot];
+
+    wheel.timers[timer].next = head;
+    head                     = timer;
+}
+
+void Add_Human_Timer(Human_Timer_Wheel& wheel, Human_ID id, u64 tick, MCTX) {
+    Assert(tick > wheel.now);
+
+    auto timer          = Allocate_Human_Timer(wheel, ctx);
+    wheel.timers[timer] = {0, id, tick};
+    Link_Human_Timer(wheel, timer);
+}
+
+// NOTE: Переводит колесо на следующий тик.
+// Возвращает список (по `Human_Timer::next`) таймеров, сработавших на этом тике.
+// Таймеры списка освобождает вызывающий.
+u32 Step_Human_Timer_Wheel(Human_Timer_Wheel& wheel) {
+    wheel.now++;
+
+    for (i32 level = 1; level < HUMAN_TIMER_WHEEL_LEVELS; level++) {
+        auto shift = HUMAN_TIMER_WHEEL_SLOTS_BITS * level;
+        if ((wheel.now & (((u64)1 << shift) - 1)) != 0)
+            break;
+
+        auto  slot  = (wheel.now >> shift) & (HUMAN_TIMER_WHEEL_SLOTS - 1);
+        auto& head  = wheel.slots[level][slot];
+        auto  timer = head;
+        head        = 0;
+
+        while (timer != 0) {
+            auto next = wheel.timers[timer].next;
+            Link_Human_Timer(wheel, timer);
+            timer = next;
+        }
+    }
+
+    auto& head   = wheel.slots[0][wheel.now & (HUMAN_TIMER_WHEEL_SLOTS - 1)];
+    auto  result = head;
+    head         = 0;
+    return result;
+}
+
+void Deinit_Human_Timer_Wheel(Human_Timer_Wheel& wheel, MCTX) {
+    CTX_ALLOCATOR;
+
+    if (wheel.timers != nullptr)
+        FREE(wheel.timers, sizeof(Human_Timer) * wheel.max_count);
+
+    wheel = {};
+}
+
+u64 Human_Timer_Ticks(f32 seconds) {
+    return MAX((u64)1, (u64)(seconds / HUMAN_TIMER_WHEEL_TICK + 0.5f));
+}
+
+// NOTE: Планирует приход чувачка на `moving.to` через тайл от `departed_at`.
+void Schedule_Human_Arrival(
+    World&   world,
+    Human_ID id,
+    Human&   human,
+    u64      departed_at,
+    MCTX
+) {
+    auto& wheel  = world.human_timers;
+    auto& moving = human.moving;
+    Assert(moving.to.has_value());
+    Assert(moving.arrives_at == 0);
+
+    auto duration = Human_Timer_Ticks(world.data.human_moving_one_tile_duration);
+
+    // NOTE: Если `dt` длиннее тайла, следующий тайл начинается с задержкой на тик.
+    moving.departed_at = departed_at;
+    moving.arrives_at  = MAX(departed_at + duration, wheel.now + 1);
+    Add_Human_Timer(wheel, id, moving.arrives_at, ctx);
+}
+
+// NOTE: `elapsed` и `progress` идущего чувачка по времени колеса.
+void Sync_Human_Moving_Time(const World& world, Human& human) {
+    auto& moving = human.moving;
+    if (moving.arrives_at == 0 || !moving.to.has_value())
+        return;
+
+    const auto duration = world.data.human_moving_one_tile_duration;
+    auto       ticks    = world.human_timers.now - moving.departed_at;
+
+    moving.elapsed  = (f32)ticks * HUMAN_TIMER_WHEEL_TICK;
+    moving.progress = MIN(1.0f, moving.elapsed / duration);
+}
+
+// NOTE: Доля пройденного до `moving.to` для отрисовки.
+// `ahead` - сколько секунд прошло с последнего тика симуляции.
+// При `Timer_Wheel` интерполируется от `departed_at` с учётом доли текущего тика.
+f32 Human_Moving_Progress(const World& world, const Human& human, f32 ahead) {
+    auto& moving = human.moving;
+    if (world.human_movement_backend != Human_Movement_Backend::Timer_Wheel
+        || moving.arrives_at == 0)
+    {
+        const auto duration = world.data.human_moving_one_tile_duration;
+        return MIN(1.0f, (moving.elapsed + ahead) / duration);
+    }
+
+    auto& wheel   = world.human_timers;
+    auto  elapsed = (f32)(wheel.now - moving.departed_at) + wheel.remainder
+                   + ahead / HUMAN_TIMER_WHEEL_TICK;
+    auto total = (f32)(moving.arrives_at - moving.departed_at);
+    return MIN(1.0f, elapsed / total);
+}
+
+f32 Human_Moving_Progress_Per_Second(const World& world, const Human& human) {
+    auto& moving = human.moving;
+    if (world.human_movement_backend != Human_Movement_Backend::Timer_Wheel
+        || moving.arrives_at == 0)
+    {
+        return 1.0f / world.data.human_moving_one_tile_duration;
+    }
+
+    auto total = (f32)(moving.arrives_at - moving.departed_at);
+    return 1.0f / (total * HUMAN_TIMER_WHEEL_TICK);
+}
+
+void Set_Human_Movement_Backend(World& world, Human_Movement_Backend backend) {
+    if (world.human_movement_backend == backend)
+        return;
+
+    world.human_movement_backend = backend;
+
+    // NOTE: Колонки пересоберутся, а уже стоящие таймеры станут устаревшими.
+    // Идущие чувачки встанут в колесо с учётом набранного `elapsed`.
+    world.human_movement.dirty = true;
+    for (auto [_, human_p] : Iter(&world.humans))
+        human_p->moving.arrives_at = 0;
+}
+
 void Remove_Humans(Game& game, MCTX) {
-    auto& world = game.world;
+    auto& world    = game.world;
+    auto& movement = world.human_movement;
+
+    // NOTE: Рассинхронизированные колонки всё равно пересоберутся.
+    bool movement_in_sync
+        = world.human_movement_backend == Human_Movement_Backend::Columns
+          && !movement.dirty && movement.count == world.humans.count;
 
     for (auto [id, reason_p] : Iter(&world.humans_to_remove)) {
         auto& reason = *reason_p;
@@ -1018,10 +2654,16 @@ void Remove_Humans(Game& game, MCTX) {
             Assert(human.building_id != Building_ID_Missing);
         }
 
-        Deinit_Queue(human.moving.path, ctx);
+        Free_Path(world.human_paths, human.moving.path);
+
+        if (movement_in_sync)
+            Remove_Human_Movement(movement, (i32)(&human - world.humans.base));
+        else
+            movement.dirty = true;
 
         world.humans.Unstable_Remove(id);
         On_Human_Removed(game, id, human, reason, ctx);
+        Destroy_Entity(world.entities, id.id, ctx);
     }
 
     world.humans_to_remove.Reset();
@@ -1053,7 +2695,7 @@ void Update_Human_Moving_Component(
         // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
         moving.pos  = moving.to.value();
         moving.from = moving.pos;
-        Advance_Moving_To(moving);
+        Advance_Moving_To(world.human_paths, moving);
 
         Root_OnMovedToTheNextTile(human, data, ctx);
         // TODO: on_Human_Moved_To_The_Next_Tile.On_Next(new (){ human = human });
@@ -1067,9 +2709,123 @@ void Update_Human_Moving_Component(
     SANITIZE_HUMAN;
 }
 
+// NOTE: Переносит в чувачка результат `Advance_Human_Movement` (колонка `i`).
+// Переход на следующий тайл и колбэки - только у дошедших до `moving.to`.
+void Apply_Human_Movement_Column(
+    World&            world,
+    Human&            human,
+    i32               i,
+    const Human_Data& data,
+    MCTX
+) {
+    CTX_LOGGER;
+    CTX_ALLOCATOR;
+
+    auto& columns = world.human_movement;
+    auto& moving  = human.moving;
+    Assert(moving.to.has_value());
+    Assert(columns.moving[i]);
+
+    moving.elapsed  = columns.elapsed[i];
+    moving.progress = columns.progress[i];
+
+    if (columns.crossed[i]) {
+        LOG_SCOPE;
+
+        const auto duration = world.data.human_moving_one_tile_duration;
+        Assert(moving.elapsed < duration);
+
+        // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+        moving.pos  = moving.to.value();
+        moving.from = moving.pos;
+        Advance_Moving_To(world.human_paths, moving);
+
+        Root_OnMovedToTheNextTile(human, data, ctx);
+        // TODO: on_Human_Moved_To_The_Next_Tile.On_Next(new (){ human = human });
+
+        if (!moving.to.has_value())
+            moving.elapsed = 0;
+
+        moving.progress = MIN(1.0f, moving.elapsed / duration);
+    }
+
+    SANITIZE_HUMAN;
+}
+
+// NOTE: Приход чувачка на `moving.to` по таймеру `arrived_at`.
+void Human_Arrived_To_The_Next_Tile(
+    World&            world,
+    Human_ID          id,
+    Human&            human,
+    const Human_Data& data,
+    MCTX
+) {
+    CTX_LOGGER;
+    LOG_SCOPE;
+
+    auto& moving     = human.moving;
+    auto  arrived_at = moving.arrives_at;
+
+    moving.arrives_at = 0;
+
+    // NOTE: Путь сбросили, пока чувачок шёл.
+    if (!moving.to.has_value())
+        return;
+
+    // NOLINTNEXTLINE(bugprone-unchecked-optional-access)
+    moving.pos  = moving.to.value();
+    moving.from = moving.pos;
+    Advance_Moving_To(world.human_paths, moving);
+
+    Root_OnMovedToTheNextTile(human, data, ctx);
+    // TODO: on_Human_Moved_To_The_Next_Tile.On_Next(new (){ human = human });
+
+    if (moving.to.has_value()) {
+        if (moving.arrives_at == 0)
+            Schedule_Human_Arrival(world, id, human, arrived_at, ctx);
+    }
+    else {
+        moving.elapsed  = 0;
+        moving.progress = 0;
+    }
+
+    SANITIZE_HUMAN;
+}
+
+// NOTE: Продвигает `world.human_timers` на `dt` и переводит на следующий тайл
+// только тех чувачков, чьи таймеры сработали.
+void Update_Human_Timers(World& world, f32 dt, const Human_Data& data, MCTX) {
+    ZoneScoped;
+
+    auto& wheel = world.human_timers;
+
+    wheel.remainder += dt / HUMAN_TIMER_WHEEL_TICK;
+    auto ticks = (u64)wheel.remainder;
+    wheel.remainder -= (f32)ticks;
+
+    FOR_RANGE (u64, _, ticks) {
+        auto timer = Step_Human_Timer_Wheel(wheel);
+
+        while (timer != 0) {
+            auto [next, id, tick] = wheel.timers[timer];
+            Free_Human_Timer(wheel, timer);
+            timer = next;
+
+            auto human_p = world.humans.Find(id);
+            if (human_p == nullptr || human_p->moving.arrives_at != tick)
+                continue;
+
+            Human_Arrived_To_The_Next_Tile(world, id, *human_p, data, ctx);
+        }
+    }
+}
+
+// NOTE: `i` - индекс чувачка в `world.humans` и `world.human_movement`.
+// `human_p` может указывать на копию (см. `Update_Humans_Parallel`).
 void Update_Human(
     World&            world,
     Human_ID          id,
+    i32               i,
     Human*            human_p,
     float             dt,
     const Human_Data& data,
@@ -1082,14 +2838,26 @@ void Update_Human(
     auto& human            = *human_p;
     auto& humans_to_remove = world.humans_to_remove;
 
-    if (human.moving.to.has_value()) {
+    auto backend     = world.human_movement_backend;
+    bool columns     = backend == Human_Movement_Backend::Columns;
+    bool timer_wheel = backend == Human_Movement_Backend::Timer_Wheel;
+
+    if (timer_wheel)
+        Sync_Human_Moving_Time(world, human);
+    else if (human.moving.to.has_value()) {
         ZoneScopedN("Update_Human_Moving_Component");
 
-        Update_Human_Moving_Component(world, human, dt, data, ctx);
+        if (columns)
+            Apply_Human_Movement_Column(world, human, i, data, ctx);
+        else
+            Update_Human_Moving_Component(world, human, dt, data, ctx);
     }
 
-    if (humans_to_remove.count > 0 && humans_to_remove.Contains(id))
+    if (humans_to_remove.count > 0 && humans_to_remove.Contains(id)) {
+        if (columns)
+            Set_Human_Movement(world.human_movement, i, human);
         return;
+    }
 
     {
         ZoneScopedN("Human_Root_Update");
@@ -1097,6 +2865,26 @@ void Update_Human(
         Human_Root_Update(human, data, dt, ctx);
     }
 
+    if (timer_wheel) {
+        auto& moving = human.moving;
+        if (!moving.to.has_value())
+            moving.arrives_at = 0;
+        else if (moving.arrives_at == 0) {
+            // NOTE: Таймер ставится в общее колесо.
+            if (Human_Update_Deferred(data))
+                return;
+
+            // NOTE: `elapsed` не 0 только после переключения с другого бэкенда.
+            auto now     = world.human_timers.now;
+            auto elapsed = (u64)(moving.elapsed / HUMAN_TIMER_WHEEL_TICK + 0.5f);
+            Schedule_Human_Arrival(world, id, human, now - MIN(now, elapsed), ctx);
+        }
+    }
+
+    auto commands = data.commands;
+    if (commands != nullptr && commands->deferred)
+        return;
+
     {
         ZoneScopedN("Checking if needs removal");
 
@@ -1105,16 +2893,115 @@ void Update_Human(
             && (!human.moving.to.has_value())           //
             && (human.moving.pos == Strict_Query_Building(world, human.building_id)->pos))
         {
-            auto [id_p, r_value] = humans_to_remove.Add(ctx);
-
-            *id_p    = id;
-            *r_value = Human_Removal_Reason::Transporter_Returned_To_City_Hall;
+            if (commands != nullptr) {
+                commands->items[commands->count++]
+                    = {id, Human_Update_Command_Type::Remove};
+            }
+            else {
+                auto [_, r_value] = humans_to_remove.Add(id, ctx);
+                *r_value = Human_Removal_Reason::Transporter_Returned_To_City_Hall;
+            }
         }
     }
 
+    if (columns)
+        Set_Human_Movement(world.human_movement, i, human);
+
     SANITIZE_HUMAN;
 }
 
+// NOTE: Меньше чувачков обновляем последовательно - раздача задач обойдётся дороже.
+#define HUMANS_PARALLEL_MIN_COUNT 256
+#define HUMANS_PER_TASK 64
+
+// NOTE: Параллельное обновление `world.humans`. Результат совпадает
+// с последовательным обновлением (на это завязаны реплеи).
+//
+// Каждый чувачок обновляется на воркере в копии. Если обновление упирается
+// в общее состояние мира (`Human_Update_Deferred`), копия выбрасывается,
+// а чувачок обновляется заново в последовательном проходе после синхронизации.
+// Удаления пишутся в буфер команд задачи. Буферы применяются в порядке задач.
+void Update_Humans_Parallel(Game& game, f32 dt, const Human_Data& data, MCTX) {
+    ZoneScoped;
+
+    auto& world       = game.world;
+    auto& trash_arena = game.trash_arena;
+
+    auto humans_count = (u32)world.humans.count;
+    auto tasks_count  = (humans_count + HUMANS_PER_TASK - 1) / HUMANS_PER_TASK;
+
+    TEMP_USAGE(trash_arena);
+
+    auto commands = Allocate_Zeros_Array(trash_arena, Human_Update_Commands, tasks_count);
+    FOR_RANGE (u32, task, tasks_count) {
+        commands[task].items
+            = Allocate_Array(trash_arena, Human_Update_Command, HUMANS_PER_TASK);
+    }
+
+    Parallel_For(
+        game.threads_count,
+        tasks_count,
+        [&](Context* job_ctx, u32 task) {
+            auto& task_commands = commands[task];
+
+            // NOTE: Логи воркеров выключены, а главный поток не должен писать
+            // логи чувачков, чьё обновление будет выброшено.
+            auto worker_ctx                 = *job_ctx;
+            worker_ctx.logger_data          = nullptr;
+            worker_ctx.logger_routine       = nullptr;
+            worker_ctx.logger_scope_routine = nullptr;
+
+            // NOTE: Всё, что трогает `trash_arena`, откладывается
+            // до последовательного прохода.
+            auto task_data        = data;
+            task_data.trash_arena = nullptr;
+            task_data.commands    = &task_commands;
+
+            auto begin = task * HUMANS_PER_TASK;
+            auto end   = MIN(begin + HUMANS_PER_TASK, humans_count);
+            for (auto i = begin; i < end; i++) {
+                auto id    = world.humans.ids[i];
+                auto human = world.humans.base[i];
+
+                task_commands.deferred = false;
+                Update_Human(world, id, (i32)i, &human, dt, task_data, &worker_ctx);
+
+                if (task_commands.deferred) {
+                    task_commands.items[task_commands.count++]
+                        = {id, Human_Update_Command_Type::Update_Serially};
+                }
+                else
+                    world.humans.base[i] = human;
+            }
+        },
+        ctx
+    );
+
+    FOR_RANGE (u32, task, tasks_count) {
+        auto& task_commands = commands[task];
+
+        FOR_RANGE (i32, i, task_commands.count) {
+            auto [id, type] = task_commands.items[i];
+
+            switch (type) {
+            case Human_Update_Command_Type::Update_Serially: {
+                auto human_p = world.humans.Find(id);
+                auto i       = (i32)(human_p - world.humans.base);
+                Update_Human(world, id, i, human_p, dt, data, ctx);
+            } break;
+
+            case Human_Update_Command_Type::Remove: {
+                auto [_, r_value] = world.humans_to_remove.Add(id, ctx);
+                *r_value = Human_Removal_Reason::Transporter_Returned_To_City_Hall;
+            } break;
+
+            default:
+                INVALID_PATH;
+            }
+        }
+    }
+}
+
 void Update_Humans(Game& game, f32 dt, const Human_Data& data, MCTX) {
     ZoneScoped;
 
@@ -1127,16 +3014,46 @@ void Update_Humans(Game& game, f32 dt, const Human_Data& data, MCTX) {
 
     Remove_Humans(game, ctx);
 
-    for (auto [id, human_p] : Iter(&world.humans))
-        Update_Human(world, id, human_p, dt, data, ctx);
+    auto&      movement = world.human_movement;
+    const auto duration = world.data.human_moving_one_tile_duration;
+
+    auto backend     = world.human_movement_backend;
+    bool columns     = backend == Human_Movement_Backend::Columns;
+    bool timer_wheel = backend == Human_Movement_Backend::Timer_Wheel;
+
+    if (timer_wheel)
+        Update_Human_Timers(world, dt, data, ctx);
+    else if (columns) {
+        if (movement.dirty || movement.count != world.humans.count)
+            Rebuild_Human_Movement_Columns(world, ctx);
+
+#if ASSERT_SLOW
+        FOR_RANGE (i32, i, movement.count) {
+            auto& moving = world.humans.base[i].moving;
+            Assert(movement.elapsed[i] == moving.elapsed);
+            Assert(movement.progress[i] == moving.progress);
+            Assert((movement.moving[i] != 0) == moving.to.has_value());
+        }
+#endif
+
+        Advance_Human_Movement(movement, 0, movement.count, dt, duration);
+    }
+
+    if (game.threads_count > 1 && world.humans.count >= HUMANS_PARALLEL_MIN_COUNT)
+        Update_Humans_Parallel(game, dt, data, ctx);
+    else {
+        FOR_RANGE (i32, i, world.humans.count) {
+            auto id      = world.humans.ids[i];
+            auto human_p = world.humans.base + i;
+            Update_Human(world, id, i, human_p, dt, data, ctx);
+        }
+    }
 
     auto prev_count = world.humans_to_add.count;
     for (auto [id, human_to_move] : Iter(&world.humans_to_add)) {
         LOG_DEBUG("Update_Humans: moving human from humans_to_add to humans");
-        auto [id_p, phuman] = world.humans.Add(ctx);
-
-        *id_p   = id;
-        *phuman = *human_to_move;
+        auto [_, phuman] = world.humans.Add(id, ctx);
+        *phuman          = *human_to_move;
 
         auto& human = *phuman;
 
@@ -1145,38 +3062,44 @@ void Update_Humans(Game& game, f32 dt, const Human_Data& data, MCTX) {
             segment.assigned_human_id = id;
         }
 
-        Update_Human(world, id, phuman, dt, data, ctx);
+        auto i = world.humans.count - 1;
+        if (columns) {
+            Add_Human_Movement(movement, human, ctx);
+            Advance_Human_Movement(movement, i, i + 1, dt, duration);
+        }
+
+        Update_Human(world, id, i, phuman, dt, data, ctx);
     }
 
     Assert(prev_count == world.humans_to_add.count);
     world.humans_to_add.Reset();
 
     Remove_Humans(game, ctx);
+}
 
-    {  // NOTE: Debug shiet.
-        int humans_moving_to_destination = 0;
-        int humans_moving_inside_segment = 0;
-        for (auto [id, human_p] : Iter(&world.humans)) {
-            auto& human = *human_p;
-
-            if (human.state == Human_States::MovingInTheWorld  //
-                && human.state_moving_in_the_world
-                       == Moving_In_The_World_State::Moving_To_Destination)
-            {
-                humans_moving_to_destination++;
-            }
-            else if (human.state == Human_States::MovingInsideSegment) {
-                humans_moving_inside_segment++;
-            }
-        }
+f32 Simulation_Tick_Duration(const Simulation_Clock& clock) {
+    Assert(clock.ticks_per_second > 0);
+    return 1.0f / (f32)clock.ticks_per_second;
+}
 
-        ImGui::Text("world.humans.count %d", world.humans.count);
-        ImGui::Text(
-            "world.humans_going_to_city_hall %d", world.humans_going_to_city_hall.count
-        );
-        ImGui::Text("humans_moving_to_destination %d", humans_moving_to_destination);
-        ImGui::Text("humans_moving_inside_segment %d", humans_moving_inside_segment);
-    }
+// NOTE: Копит реальное время кадра `dt` и возвращает,
+// сколько тиков `Update_World` нужно отработать в этом кадре.
+u32 Advance_Simulation_Clock(Simulation_Clock& clock, f32 dt) {
+    Assert(clock.ticks_per_second > 0);
+    Assert(clock.speed > 0);
+
+    clock.accumulator += dt * (f32)(clock.ticks_per_second * clock.speed);
+
+    auto ticks = MIN((u32)clock.accumulator, clock.max_ticks_per_frame * clock.speed);
+    clock.accumulator -= (f32)ticks;
+
+    // NOTE: Не влезшие в лимит тики выбрасываются.
+    if (clock.accumulator >= 1.0f)
+        clock.accumulator -= (f32)(u32)clock.accumulator;
+
+    clock.alpha = clock.accumulator;
+    clock.ticks += ticks;
+    return ticks;
 }
 
 void Update_World(Game& game, float dt, MCTX) {
@@ -1188,14 +3111,198 @@ void Update_World(Game& game, float dt, MCTX) {
     auto& world       = game.world;
     auto& trash_arena = game.trash_arena;
 
-    ImGui::Text("world.segments.count %d", world.segments.count);
-
     Process_City_Halls(game, dt, Assert_Deref(game.world.human_data), ctx);
     Update_Humans(game, dt, Assert_Deref(game.world.human_data), ctx);
 
     SANITIZE;
 }
 
+void Init_Render_Snapshots(Render_Snapshots& snapshots) {
+    std::construct_at(&snapshots);
+
+    snapshots.write = 0;
+    snapshots.latest.store(1, std::memory_order_relaxed);
+    snapshots.read = 2;
+
+    snapshots.buffers[snapshots.write].version = 1;
+}
+
+void Deinit_Render_Snapshots(Render_Snapshots& snapshots, MCTX) {
+    CTX_ALLOCATOR;
+
+    for (auto& snapshot : snapshots.buffers) {
+        if (snapshot.humans_max_count > 0) {
+            FREE(
+                snapshot.humans,
+                sizeof(Human_Render_Transform) * snapshot.humans_max_count
+            );
+        }
+        if (snapshot.dirty_tiles_max_count > 0) {
+            FREE(
+                snapshot.dirty_tiles,
+                sizeof(Render_Dirty_Tile) * snapshot.dirty_tiles_max_count
+            );
+        }
+    }
+
+    Init_Render_Snapshots(snapshots);
+}
+
+void Reserve_Render_Snapshot_Humans(Render_Snapshot& snapshot, i32 count, MCTX) {
+    if (count <= snapshot.humans_max_count)
+        return;
+
+    auto old = snapshot.humans_max_count;
+    auto max = MAX(count, MAX(old * 2, 64));
+    Enlarge_Array(snapshot.humans, snapshot.humans_count, old, max, ctx);
+    snapshot.humans_max_count = max;
+}
+
+void Reserve_Render_Snapshot_Dirty_Tiles(Render_Snapshot& snapshot, i32 count, MCTX) {
+    if (count <= snapshot.dirty_tiles_max_count)
+        return;
+
+    auto n   = snapshot.dirty_tiles_count;
+    auto old = snapshot.dirty_tiles_max_count;
+    auto max = MAX(count, MAX(old * 2, 64));
+    Enlarge_Array(snapshot.dirty_tiles, n, old, max, ctx);
+    snapshot.dirty_tiles_max_count = max;
+}
+
+// NOTE: Вызывает только писатель.
+void Add_Render_Snapshot_Dirty_Tile(
+    Render_Snapshots&        snapshots,
+    const Render_Dirty_Tile& tile,
+    MCTX
+) {
+    auto& snapshot = snapshots.buffers[snapshots.write];
+
+    Reserve_Render_Snapshot_Dirty_Tiles(snapshot, snapshot.dirty_tiles_count + 1, ctx);
+    snapshot.dirty_tiles[snapshot.dirty_tiles_count++] = tile;
+}
+
+// NOTE: Клетка `pos` для рендера в её текущем виде.
+Render_Dirty_Tile Make_Render_Dirty_Tile(World& world, v2i16 pos) {
+    Render_Dirty_Tile result{};
+    result.pos  = pos;
+    result.tile = world.element_tiles[pos.y * world.size.x + pos.x];
+
+    auto& tile = result.tile;
+    if (tile.type == Element_Tile_Type::Building) {
+        auto& building            = *Strict_Query_Building(world, tile.building_id);
+        result.scriptable         = building.scriptable;
+        result.under_construction = building.remaining_construction_points != 0;
+    }
+
+    return result;
+}
+
+// NOTE: Публикует буфер писателя и забирает себе следующий.
+void Publish_Render_Snapshot(Render_Snapshots& snapshots, MCTX) {
+    auto& snapshot = snapshots.buffers[snapshots.write];
+
+    // NOTE: Если прошлый снапшот читатель не забрал, его клетки переезжают
+    // в начало этого, иначе он их не увидит. Если читатель успеет забрать
+    // прошлый снапшот после проверки, клетки просто придут ему дважды -
+    // в порядке постройки, так что итог у рендера тот же.
+    auto latest = snapshots.latest.load(std::memory_order_acquire);
+    if (latest & RENDER_SNAPSHOT_FRESH) {
+        auto& unread = snapshots.buffers[latest & RENDER_SNAPSHOT_INDEX_MASK];
+        auto  n      = unread.dirty_tiles_count;
+        auto  count  = snapshot.dirty_tiles_count;
+
+        Reserve_Render_Snapshot_Dirty_Tiles(snapshot, count + n, ctx);
+        memmove(
+            snapshot.dirty_tiles + n,
+            snapshot.dirty_tiles,
+            sizeof(Render_Dirty_Tile) * count
+        );
+        memcpy(snapshot.dirty_tiles, unread.dirty_tiles, sizeof(Render_Dirty_Tile) * n);
+        snapshot.dirty_tiles_count = count + n;
+    }
+
+    auto version = snapshot.version;
+
+    auto old = snapshots.latest.exchange(
+        snapshots.write | RENDER_SNAPSHOT_FRESH, std::memory_order_acq_rel
+    );
+    snapshots.write = old & RENDER_SNAPSHOT_INDEX_MASK;
+
+    auto& next             = snapshots.buffers[snapshots.write];
+    next.version           = version + 1;
+    next.dirty_tiles_count = 0;
+}
+
+// NOTE: Вызывает только читатель. Возвращает true, если забран новый снапшот.
+// Сам снапшот - `snapshots.buffers[snapshots.read]`.
+bool Acquire_Render_Snapshot(Render_Snapshots& snapshots) {
+    if (!(snapshots.latest.load(std::memory_order_relaxed) & RENDER_SNAPSHOT_FRESH))
+        return false;
+
+    auto old = snapshots.latest.exchange(snapshots.read, std::memory_order_acq_rel);
+    snapshots.read = old & RENDER_SNAPSHOT_INDEX_MASK;
+    return true;
+}
+
+// NOTE: Снимок мира для рендера после тика.
+void Publish_World_Snapshot(Game& game, MCTX) {
+    ZoneScoped;
+
+    auto& snapshots = Assert_Deref(game.render_snapshots);
+    auto& snapshot  = snapshots.buffers[snapshots.write];
+    auto& world     = game.world;
+
+    snapshot.ahead = game.clock.alpha * Simulation_Tick_Duration(game.clock);
+
+    Reserve_Render_Snapshot_Humans(snapshot, world.humans.count, ctx);
+    snapshot.humans_count = world.humans.count;
+
+    FOR_RANGE (i32, i, world.humans.count) {
+        auto& human     = world.humans.base[i];
+        auto& transform = snapshot.humans[i];
+
+        transform.id                  = world.humans.ids[i];
+        transform.pos                 = human.moving.pos;
+        transform.to                  = human.moving.to.value_or(human.moving.pos);
+        transform.progress            = Human_Moving_Progress(world, human, 0);
+        transform.progress_per_second = Human_Moving_Progress_Per_Second(world, human);
+    }
+
+    Publish_Render_Snapshot(snapshots, ctx);
+}
+
+#if BF_CLIENT
+// NOTE: Вызывается раз за кадр, а не на каждый тик симуляции.
+void Show_World_Debug_Info(Game& game) {
+    auto& world = game.world;
+
+    ImGui::Text("world.segments.count %d", world.segments.count);
+
+    int humans_moving_to_destination = 0;
+    int humans_moving_inside_segment = 0;
+    for (auto [id, human_p] : Iter(&world.humans)) {
+        auto& human = *human_p;
+
+        if (human.state == Human_States::MovingInTheWorld  //
+            && human.state_moving_in_the_world
+                   == Moving_In_The_World_State::Moving_To_Destination)
+        {
+            humans_moving_to_destination++;
+        }
+        else if (human.state == Human_States::MovingInsideSegment) {
+            humans_moving_inside_segment++;
+        }
+    }
+
+    ImGui::Text("world.humans.count %d", world.humans.count);
+    ImGui::Text(
+        "world.humans_going_to_city_hall %d", world.humans_going_to_city_hall.count
+    );
+    ImGui::Text("humans_moving_to_destination %d", humans_moving_to_destination);
+    ImGui::Text("humans_moving_inside_segment %d", humans_moving_inside_segment);
+}
+#endif
+
 void Add_World_Resource(
     Game&                game,
     Scriptable_Resource* scriptable,
@@ -1215,12 +3322,35 @@ void Add_World_Resource(
     resource.carrying_human = Human_ID_Missing;
 
     {
-        auto [id_p, presource] = world.resources.Add(ctx);
-        *id_p                  = Next_World_Resource_ID(world.last_entity_id);
-        *presource             = resource;
+        auto [_, presource] = world.resources.Add(  //
+            Next_World_Resource_ID(world.entities, ctx),
+            ctx
+        );
+        *presource = resource;
     }
 }
 
+void Init_Graph_Trace_Workspace(
+    Graph_Trace_Workspace& workspace,
+    Arena&                 arena,
+    i32                    tiles_count
+) {
+    workspace.generation    = 0;
+    workspace.stamps        = Allocate_Zeros_Array(arena, u32, tiles_count);
+    workspace.visited       = Allocate_Array(arena, u8, tiles_count);
+    workspace.nodes         = Allocate_Zeros_Array(arena, u8, tiles_count);
+    workspace.vertex_marks  = Allocate_Zeros_Array(arena, bool, tiles_count);
+    workspace.vertices      = Allocate_Array(arena, v2i16, tiles_count);
+    workspace.segment_tiles = Allocate_Array(arena, v2i16, tiles_count);
+    workspace.big_queue     = {};
+    workspace.queue         = {};
+}
+
+void Deinit_Graph_Trace_Workspace(Graph_Trace_Workspace& workspace, MCTX) {
+    Deinit_Queue(workspace.big_queue, ctx);
+    Deinit_Queue(workspace.queue, ctx);
+}
+
 void Init_World(
     bool /* first_time_initializing */,
     bool /* hot_reloaded */,
@@ -1245,7 +3375,7 @@ void Init_World(
 
     auto& world = game.world;
 
-    world.last_entity_id                      = 0;
+    world.entities                            = {};
     world.data.human_moving_one_tile_duration = 0.3f;
 
     {
@@ -1253,9 +3383,16 @@ void Init_World(
         human_data->world       = &game.world;
         human_data->trash_arena = &game.trash_arena;
         human_data->game        = &game;
+        human_data->commands    = nullptr;
 
         world.human_data = human_data;
     }
+
+    auto tiles_count = (i32)world.size.x * world.size.y;
+    Init_Path_Find_Workspace(world.path_find_workspace, arena, tiles_count);
+    Init_Path_Hierarchy(world.path_hierarchy, arena, world.size);
+    Init_Flow_Field_Cache(world.flow_fields, arena, tiles_count);
+    Init_Graph_Trace_Workspace(world.graph_trace, arena, tiles_count);
 }
 
 void Post_Init_World(
@@ -1276,6 +3413,22 @@ void Post_Init_World(
     Add_World_Resource(game, game.scriptable_resources + 0, {0, 0}, ctx);
 }
 
+void Deinit_Graph_Data(Graph& graph, MCTX) {
+    CTX_ALLOCATOR;
+
+    Assert(graph.data != nullptr);
+    auto& data = *graph.data;
+
+    auto n = graph.nodes_count;
+    auto k = data.vertices_count;
+    FREE(data.node_index_2_pos, sizeof(v2i16) * n);
+    FREE(data.dist, sizeof(i16) * k * n);
+    FREE(data.prev, sizeof(i16) * k * n);
+    FREE(graph.data, sizeof(Calculated_Graph_Data));
+
+    graph.data = nullptr;
+}
+
 void Deinit_World(Game& game, MCTX) {
     CTX_ALLOCATOR;
     auto& world = game.world;
@@ -1290,30 +3443,23 @@ void Deinit_World(Game& game, MCTX) {
         Deinit_Queue(segment.resources_to_transport, ctx);
 
         Assert(segment.graph.nodes != nullptr);
-        Assert(segment.graph.data != nullptr);
-
-        auto& data = *segment.graph.data;
-        Assert(data.dist != nullptr);
-        Assert(data.prev != nullptr);
-
-        data.node_index_2_pos.clear();
-        data.pos_2_node_index.clear();
-
-        auto n = segment.graph.nodes_count;
-        FREE(data.dist, sizeof(i16) * n * n);
-        FREE(data.prev, sizeof(i16) * n * n);
+        Deinit_Graph_Data(segment.graph, ctx);
     }
 
     Deinit_Sparse_Array(world.segments, ctx);
+    Deinit_Vertex_Segments_Index(world.vertex_segments, ctx);
+    Deinit_Graph_Trace_Workspace(world.graph_trace, ctx);
     Deinit_Queue(world.segments_wo_humans, ctx);
 
     Deinit_Sparse_Array(world.buildings, ctx);
     Deinit_Sparse_Array_Of_Ids(world.not_constructed_buildings, ctx);
     Deinit_Sparse_Array(world.city_halls, ctx);
 
-    for (auto [_, human] : Iter(&world.humans))
-        Deinit_Queue(human->moving.path, ctx);
+    // NOTE: Пути чувачков освобождаются вместе с пулом.
     Deinit_Sparse_Array(world.humans, ctx);
+    Deinit_Human_Movement_Columns(world.human_movement, ctx);
+    Deinit_Human_Timer_Wheel(world.human_timers, ctx);
+    Deinit_Path_Pool(world.human_paths, ctx);
 
     Deinit_Sparse_Array_Of_Ids(world.humans_going_to_city_hall, ctx);
     Deinit_Sparse_Array(world.humans_to_add, ctx);
@@ -1321,6 +3467,7 @@ void Deinit_World(Game& game, MCTX) {
     Deinit_Sparse_Array(world.resources, ctx);
 
     Deinit_Vector(world.resources_booking_queue, ctx);
+    Deinit_Entity_Slots(world.entities, ctx);
 }
 
 void Regenerate_Terrain_Tiles(
@@ -1585,26 +3732,6 @@ bool Should_Segment_Be_Deleted(
     return false;
 }
 
-#define Add_Without_Duplication(max_count_, count_, array_, value_) \
-    STATEMENT({                                                     \
-        Assert((max_count_) >= (count_));                           \
-                                                                    \
-        auto found = false;                                         \
-        FOR_RANGE (int, i, (count_)) {                              \
-            auto existing = *((array_) + i);                        \
-            if (existing == (value_)) {                             \
-                found = true;                                       \
-                break;                                              \
-            }                                                       \
-        }                                                           \
-                                                                    \
-        if (!found) {                                               \
-            Assert((count_) < (max_count_));                        \
-            *((array_) + (count_)) = (value_);                      \
-            (count_)++;                                             \
-        }                                                           \
-    })
-
 bool Adjacent_Tiles_Are_Connected(Graph& graph, i16 x, i16 y) {
     const auto gx = graph.size.x;
 
@@ -1638,115 +3765,115 @@ void Assert_Is_Undirected(Graph& graph) {
     }
 }
 
-void Calculate_Graph_Data(Graph& graph, Arena& trash_arena, MCTX) {
-    TEMP_USAGE(trash_arena);
-
+void Allocate_Graph_Data(Graph& graph, u16 vertices_count, MCTX) {
     CTX_ALLOCATOR;
 
+    auto n = graph.nodes_count;
+    auto k = vertices_count;
+
+    Assert(n < (u16)i16_max);
+    Assert(k > 0);
+
+    graph.data = (Calculated_Graph_Data*)ALLOC(sizeof(Calculated_Graph_Data));
+    auto& data = *graph.data;
+
+    data.vertices_count   = k;
+    data.node_index_2_pos = (v2i16*)ALLOC(sizeof(v2i16) * n);
+    data.dist             = (i16*)ALLOC(sizeof(i16) * k * n);
+    data.prev             = (i16*)ALLOC(sizeof(i16) * k * n);
+}
+
+// NOTE: Сколько `trash_arena` потребуется `Fill_Graph_Data`.
+size_t Graph_Data_Scratch_Size(const Graph& graph) {
+    return sizeof(i16) * graph.size.x * graph.size.y
+           + sizeof(i16) * Ceil_To_Power_Of_2((u32)graph.nodes_count);
+}
+
+// NOTE: BFS из каждой вершинной клетки сегмента по его графу.
+// Граф невзвешенный и разреженный, так что это O(k * n)
+// вместо O(n^3) у Флойда-Уоршелла по всем клеткам.
+//
+// Ничего не аллоцирует через `ctx`, поэтому безопасно вызывается
+// из нескольких потоков для разных сегментов.
+void Fill_Graph_Data(
+    Graph&       graph,
+    const v2i16* vertices,
+    u16          vertices_count,
+    Arena&       trash_arena
+) {
+    TEMP_USAGE(trash_arena);
+
     auto n      = graph.nodes_count;
+    auto k      = vertices_count;
     auto nodes  = graph.nodes;
     auto height = graph.size.y;
     auto width  = graph.size.x;
 
-    graph.data = (Calculated_Graph_Data*)ALLOC(sizeof(Calculated_Graph_Data));
+    Assert(graph.data != nullptr);
     auto& data = *graph.data;
+    Assert(data.vertices_count == k);
 
-    auto& node_index_2_pos = *std::construct_at(&data.node_index_2_pos);
-    auto& pos_2_node_index = *std::construct_at(&data.pos_2_node_index);
-
+    // NOTE: Клетки графа нумеруются построчно.
+    auto pos_2_node_index = Allocate_Array(trash_arena, i16, width * height);
     {
-        int node_index = 0;
+        i16 node_index = 0;
         FOR_RANGE (int, y, height) {
             FOR_RANGE (int, x, width) {
-                auto node = nodes[y * width + x];
-                if (node == 0)
+                auto& index = pos_2_node_index[y * width + x];
+                if (nodes[y * width + x] == 0) {
+                    index = -1;
                     continue;
+                }
 
-                data.node_index_2_pos.insert({node_index, v2i16(x, y)});
-                data.pos_2_node_index.insert({v2i16(x, y), node_index});
-
+                data.node_index_2_pos[node_index] = v2i16(x, y);
+                index                             = node_index;
                 node_index += 1;
             }
         }
+        Assert(node_index == n);
     }
 
-    // NOTE: |V| = _nodes_count
-    // > let dist be a |V| × |V| array of minimum distances initialized to ∞ (infinity)
-    // > let prev be a |V| × |V| array of minimum distances initialized to null
-    auto& dist = data.dist;
-    auto& prev = data.prev;
-    dist       = (i16*)ALLOC(sizeof(i16) * n * n);
-    prev       = (i16*)ALLOC(sizeof(i16) * n * n);
-    FOR_RANGE (int, y, n) {
-        FOR_RANGE (int, x, n) {
-            dist[y * n + x] = i16_max;
-            prev[y * n + x] = i16_min;
+    Fixed_Size_Queue<i16> queue{};
+    queue.max_count = Ceil_To_Power_Of_2(n);
+    queue.base      = Allocate_Array(trash_arena, i16, queue.max_count);
+
+    FOR_RANGE (u16, vertex, k) {
+        auto dist = data.dist + vertex * n;
+        auto prev = data.prev + vertex * n;
+        FOR_RANGE (u16, i, n) {
+            dist[i] = i16_max;
+            prev[i] = i16_min;
         }
-    }
 
-    // NOTE: edge (u, v) = (node_index, new_node_index)
-    // > for each edge (u, v) do
-    // >     dist[u][v] ← w(u, v)  // The weight of the edge (u, v)
-    // >     prev[u][v] ← u
-    {
-        i16 node_index = 0;
-        FOR_RANGE (int, y, height) {
-            FOR_RANGE (int, x, width) {
-                u8 node = nodes[y * width + x];
-                if (!node)
-                    continue;
+        auto pos = vertices[vertex] - graph.offset;
+        Assert(Pos_Is_In_Bounds(pos, graph.size));
 
-                FOR_DIRECTION (dir) {
-                    if (!Graph_Node_Has(node, dir))
-                        continue;
+        auto start = pos_2_node_index[pos.y * width + pos.x];
+        Assert(start >= 0);
 
-                    auto new_pos = v2i16(x, y) + As_Offset(dir);
-                    Assert(pos_2_node_index.contains(new_pos));
-                    auto new_node_index = pos_2_node_index[new_pos];
+        dist[start]      = 0;
+        prev[start]      = start;
+        *queue.Enqueue() = start;
 
-                    dist[node_index * n + new_node_index] = 1;
-                    prev[node_index * n + new_node_index] = node_index;
-                }
+        while (queue.count > 0) {
+            auto node_index = queue.Dequeue();
+            auto node_pos   = data.node_index_2_pos[node_index];
+            auto node       = nodes[node_pos.y * width + node_pos.x];
 
-                node_index += 1;
-            }
-        }
-    }
+            FOR_DIRECTION (dir) {
+                if (!Graph_Node_Has(node, dir))
+                    continue;
 
-    // NOTE: vertex v = nodeIndex
-    // > for each vertex v do
-    // >     dist[v][v] ← 0
-    // >     prev[v][v] ← v
-    {
-        Assert(n < (u16)i16_max);
-        FOR_RANGE (u16, node_index, n) {
-            dist[node_index * n + node_index] = 0;
-            prev[node_index * n + node_index] = (i16)node_index;
-        }
-    }
+                auto new_pos        = node_pos + As_Offset(dir);
+                auto new_node_index = pos_2_node_index[new_pos.y * width + new_pos.x];
+                Assert(new_node_index >= 0);
 
-    // Standard Floyd-Warshall
-    // for k from 1 to |V|
-    //     for i from 1 to |V|
-    //         for j from 1 to |V|
-    //             if dist[i][j] > dist[i][k] + dist[k][j] then
-    //                 dist[i][j] ← dist[i][k] + dist[k][j]
-    //                 prev[i][j] ← prev[k][j]
-    //
-    FOR_RANGE (u16, k, n) {
-        FOR_RANGE (u16, j, n) {
-            FOR_RANGE (u16, i, n) {
-                auto ij = dist[n * i + j];
-                auto ik = dist[n * i + k];
-                auto kj = dist[n * k + j];
-
-                if ((ik != i16_max)     //
-                    && (kj != i16_max)  //
-                    && (ij > ik + kj))
-                {
-                    dist[i * n + j] = (i16)(ik + kj);
-                    prev[i * n + j] = prev[k * n + j];
-                }
+                if (dist[new_node_index] != i16_max)
+                    continue;
+
+                dist[new_node_index] = (i16)(dist[node_index] + 1);
+                prev[new_node_index] = node_index;
+                *queue.Enqueue()     = new_node_index;
             }
         }
     }
@@ -1755,34 +3882,75 @@ void Calculate_Graph_Data(Graph& graph, Arena& trash_arena, MCTX) {
     Assert_Is_Undirected(graph);
 #endif
 
-    // NOTE: Вычисление центра графа.
-    i16* node_eccentricities = Allocate_Zeros_Array(trash_arena, i16, n);
+    // NOTE: Вычисление центра графа - клетки,
+    // максимальное расстояние от которой до вершин минимально.
+    i16 rad          = i16_max;
+    i16 center_index = 0;
     FOR_RANGE (u16, i, n) {
-        FOR_RANGE (u16, j, n) {
-            node_eccentricities[i] = MAX(node_eccentricities[i], dist[n * i + j]);
+        i16 eccentricity = 0;
+        FOR_RANGE (u16, vertex, k) {
+            eccentricity = MAX(eccentricity, data.dist[vertex * n + i]);
         }
-    }
-
-    i16 rad  = i16_max;
-    i16 diam = 0;
-    FOR_RANGE (u16, i, n) {
-        rad  = MIN(rad, node_eccentricities[i]);
-        diam = MAX(diam, node_eccentricities[i]);
-    }
 
-    FOR_RANGE (u16, i, n) {
-        Assert(node_index_2_pos.contains(i));
-        if (node_eccentricities[i] == rad) {
-            data.center = node_index_2_pos[i] + graph.offset;
-            break;
+        if (eccentricity < rad) {
+            rad          = eccentricity;
+            center_index = (i16)i;
         }
     }
 
+    data.center = data.node_index_2_pos[center_index] + graph.offset;
+}
+
+void Calculate_Graph_Data(
+    Graph&       graph,
+    const v2i16* vertices,
+    u16          vertices_count,
+    Arena&       trash_arena,
+    MCTX
+) {
+    CTX_ALLOCATOR;
+
+    Allocate_Graph_Data(graph, vertices_count, ctx);
+    Fill_Graph_Data(graph, vertices, vertices_count, trash_arena);
+
     SANITIZE;
 }
 
+// NOTE: Переписывает владельца рёбер графа сегмента с `from` на `to`.
+void Set_Segment_Owner(
+    Graph_Segment_ID*    segment_owners,
+    v2i16                gsize,
+    const Graph_Segment& segment,
+    Graph_Segment_ID     from,
+    Graph_Segment_ID     to
+) {
+    auto& graph = segment.graph;
+
+    FOR_RANGE (i16, y, graph.size.y) {
+        FOR_RANGE (i16, x, graph.size.x) {
+            auto node = graph.nodes[y * graph.size.x + x];
+            if (node == 0)
+                continue;
+
+            auto pos    = graph.offset + v2i16(x, y);
+            auto owners = segment_owners + 4 * (pos.y * gsize.x + pos.x);
+
+            FOR_DIRECTION (dir) {
+                if (!Graph_Node_Has(node, dir))
+                    continue;
+
+                Assert(owners[(u8)dir] == from);
+                owners[(u8)dir] = to;
+            }
+        }
+    }
+}
+
 std::tuple<Graph_Segment_ID, Graph_Segment*> Add_And_Link_Segment(
-    Entity_ID&                                     last_entity_id,
+    Entity_Slots&                                  entities,
+    Vertex_Segments_Index&                         vertex_segments,
+    Graph_Segment_ID*                              segment_owners,
+    v2i16                                          gsize,
     Sparse_Array<Graph_Segment_ID, Graph_Segment>& segments,
     Graph_Segment&                                 added_segment,
     Arena&                                         trash_arena,
@@ -1792,30 +3960,40 @@ std::tuple<Graph_Segment_ID, Graph_Segment*> Add_And_Link_Segment(
 
     // NOTE: Создание финального Graph_Segment,
     // который будет использоваться в игровой логике.
+    // NOTE: `graph.data` уже посчитана `Calculate_Segments_Graph_Data`.
     Graph_Segment segment = added_segment;
-    Calculate_Graph_Data(segment.graph, trash_arena, ctx);
+    Assert(segment.graph.data != nullptr);
     segment.assigned_human_id = Human_ID_Missing;
 
-    auto [id_p, segment1_p] = segments.Add(ctx);
-    *id_p                   = Next_Graph_Segment_ID(last_entity_id);
+    auto [id_p, segment1_p] = segments.Add(Next_Graph_Segment_ID(entities, ctx), ctx);
     *segment1_p             = segment;
 
-    auto& id = *id_p;
+    auto  id       = *id_p;
+    auto& segment1 = *segment1_p;
 
-    for (auto [segment2_id, segment2_p] : Iter(&segments)) {
-        if (segment2_id == id)
-            continue;
+    Set_Segment_Owner(segment_owners, gsize, segment1, Graph_Segment_ID_Missing, id);
+
+    // NOTE: Связываем с сегментами, у которых есть общие вершины.
+    FOR_RANGE (i32, i, segment1.vertices_count) {
+        auto vertex  = segment1.vertices[i];
+        auto entry_p = Find_Vertex_Segments(vertex_segments, vertex);
+
+        if (entry_p != nullptr) {
+            FOR_RANGE (u8, k, entry_p->count) {
+                auto segment2_id = entry_p->segments[k];
+                if (segment2_id == id)
+                    continue;
 
-        // PERF: Мб AABB / QuadTree стоит заюзать.
-        auto& segment1 = *segment1_p;
-        auto& segment2 = *segment2_p;
-        if (Have_Some_Of_The_Same_Vertices(segment1, segment2)) {
-            if (segment2.linked_segments.Index_Of(id) == -1)
-                *segment2.linked_segments.Vector_Occupy_Slot(ctx) = id;
+                auto& segment2 = *segments.Find(segment2_id);
+                if (segment2.linked_segments.Index_Of(id) == -1)
+                    *segment2.linked_segments.Vector_Occupy_Slot(ctx) = id;
 
-            if (segment1.linked_segments.Index_Of(segment2_id) == -1)
-                *segment1.linked_segments.Vector_Occupy_Slot(ctx) = segment2_id;
+                if (segment1.linked_segments.Index_Of(segment2_id) == -1)
+                    *segment1.linked_segments.Vector_Occupy_Slot(ctx) = segment2_id;
+            }
         }
+
+        Add_Vertex_Segment(vertex_segments, vertex, id, ctx);
     }
 
     SANITIZE;
@@ -1828,6 +4006,68 @@ using Graph_Segments_To_Add = Fixed_Size_Slice<Graph_Segment>;
 using Segment_To_Delete        = std::tuple<Graph_Segment_ID, Graph_Segment*>;
 using Graph_Segments_To_Delete = Fixed_Size_Slice<Segment_To_Delete>;
 
+// NOTE: Если суммарной работы меньше, потоки не запускаем - дороже выйдет.
+#define GRAPH_DATA_PARALLEL_MIN_WORK 16384
+
+// NOTE: Аллокации делаются в вызывающем потоке,
+// а BFS по сегментам раскидывается по воркерам (`Parallel_For`).
+// Каждый воркер получает свой кусок `trash_arena`.
+// Результат не зависит от количества потоков.
+void Calculate_Segments_Graph_Data(
+    Graph_Segments_To_Add& segments,
+    u32                    threads_count,
+    Arena&                 trash_arena,
+    MCTX
+) {
+    CTX_ALLOCATOR;
+
+    if (!segments.count)
+        return;
+
+    TEMP_USAGE(trash_arena);
+
+    size_t scratch_size = 0;
+    size_t work         = 0;
+    FOR_RANGE (i32, i, segments.count) {
+        auto& segment = segments.items[i];
+        Allocate_Graph_Data(segment.graph, segment.vertices_count, ctx);
+
+        scratch_size = MAX(scratch_size, Graph_Data_Scratch_Size(segment.graph));
+        work += (size_t)segment.graph.nodes_count * segment.vertices_count;
+    }
+
+    if (work < GRAPH_DATA_PARALLEL_MIN_WORK)
+        threads_count = 1;
+    threads_count = Parallel_For_Threads_Count(threads_count);
+
+    auto arenas = Allocate_Zeros_Array(trash_arena, Arena, threads_count);
+    FOR_RANGE (u32, i, threads_count) {
+        auto& arena      = arenas[i];
+        arena.debug_name = "graph_data_worker_arena";
+        arena.size       = scratch_size;
+        // NOTE: Размер посчитан впритык, так что `base` должен быть выровнен
+        // под `i16`. Cache line заодно разводит арены разных потоков.
+        arena.base = Allocate_Cache_Aligned_Array(trash_arena, u8, scratch_size);
+    }
+
+    Parallel_For(
+        threads_count,
+        (u32)segments.count,
+        [&](Context* worker_ctx, u32 i) {
+            auto& segment = segments.items[i];
+            Fill_Graph_Data(
+                segment.graph,
+                segment.vertices,
+                segment.vertices_count,
+                arenas[worker_ctx->thread_index]
+            );
+        },
+        ctx
+    );
+
+    SANITIZE;
+}
+
 BF_FORCE_INLINE void Update_Segments(
     Arena& trash_arena,
     Game& /* game */,
@@ -1856,8 +4096,8 @@ BF_FORCE_INLINE void Update_Segments(
         auto [segment_id, segment_p] = segments_to_delete.items[i];
         auto& segment                = *segment_p;
 
-        LOG_DEBUG("Update_Segments: deleting segment %d", segment_id);
-        LOG_DEBUG("segment.assigned_human_id %d", segment.assigned_human_id);
+        LOG_DEBUG("Update_Segments: deleting segment %u", segment_id.id);
+        LOG_DEBUG("segment.assigned_human_id %u", segment.assigned_human_id.id);
 
         // Если у сегмента был чувак, отвязываем его от него и ставим,
         // что он идёт в ратушу.
@@ -1875,12 +4115,13 @@ BF_FORCE_INLINE void Update_Segments(
             Root_Set_Human_State(
                 human, Human_States::MovingInTheWorld, *world.human_data, ctx
             );
+            world.human_movement.dirty = true;
             Assert(
                 human.state_moving_in_the_world
                 == Moving_In_The_World_State::Moving_To_The_City_Hall
             );
 
-            *world.humans_going_to_city_hall.Add(ctx) = segment.assigned_human_id;
+            world.humans_going_to_city_hall.Add(segment.assigned_human_id, ctx);
 
             segment.assigned_human_id = Human_ID_Missing;
         }
@@ -1891,7 +4132,9 @@ BF_FORCE_INLINE void Update_Segments(
         for (auto linked_segment_id_p : Iter(&segment.linked_segments)) {
             auto linked_segment_id = *linked_segment_id_p;
             LOG_DEBUG(
-                "Update_Segments: Unlinking %d from %d", linked_segment_id, segment_id
+                "Update_Segments: Unlinking %u from %u",
+                linked_segment_id.id,
+                segment_id.id
             );
 
             Graph_Segment& linked_segment
@@ -1916,9 +4159,21 @@ BF_FORCE_INLINE void Update_Segments(
 
         SANITIZE;
 
+        FOR_RANGE (i32, k, segment.vertices_count) {
+            Remove_Vertex_Segment(world.vertex_segments, segment.vertices[k], segment_id);
+        }
+        Set_Segment_Owner(
+            world.segment_owners,
+            world.size,
+            segment,
+            segment_id,
+            Graph_Segment_ID_Missing
+        );
+
         // NOTE: Уничтожаем сегмент.
         FREE(segment.vertices, sizeof(v2i16) * segment.vertices_count);
         FREE(segment.graph.nodes, segment.graph.nodes_allocation_count);
+        Deinit_Graph_Data(segment.graph, ctx);
 
         SANITIZE;
     }
@@ -1926,6 +4181,7 @@ BF_FORCE_INLINE void Update_Segments(
     FOR_RANGE (i32, i, segments_to_delete.count) {
         auto& [segment_id, _] = *(segments_to_delete.items + i);
         world.segments.Unstable_Remove(segment_id);
+        Destroy_Entity(world.entities, segment_id.id, ctx);
     }
 
     // NOTE: Вносим созданные сегменты. Если будут свободные чувачки - назначим им.
@@ -1939,7 +4195,10 @@ BF_FORCE_INLINE void Update_Segments(
 
     FOR_RANGE (u32, i, segments_to_add.count) {
         added_segments[i] = Add_And_Link_Segment(
-            world.last_entity_id,
+            world.entities,
+            world.vertex_segments,
+            world.segment_owners,
+            world.size,
             world.segments,
             segments_to_add.items[i],
             trash_arena,
@@ -1966,6 +4225,7 @@ BF_FORCE_INLINE void Update_Segments(
         human.segment_id          = segment_id;
 
         Root_OnCurrentSegmentChanged(human_id, human, *world.human_data, ctx);
+        world.human_movement.dirty = true;
     }
 
     // По возможности назначаем чувачков на новые сегменты.
@@ -1974,8 +4234,10 @@ BF_FORCE_INLINE void Update_Segments(
     while ((added_segments_count > 0)  //
            && (world.humans_going_to_city_hall.count > 0))
     {
-        auto [segment_id, segment_p] = added_segments[--added_segments_count];
-        auto& segment                = *segment_p;
+        // NOTE: Указатели из `Add_And_Link_Segment` могли протухнуть
+        // после расширения `world.segments`, поэтому ищем по id.
+        auto [segment_id, _] = added_segments[--added_segments_count];
+        auto& segment        = *Strict_Query_Graph_Segment(world, segment_id);
 
         auto  human_id = world.humans_going_to_city_hall.Pop();
         auto& human    = *Strict_Query_Human(world, human_id);
@@ -1984,6 +4246,7 @@ BF_FORCE_INLINE void Update_Segments(
         human.segment_id          = segment_id;
 
         Root_OnCurrentSegmentChanged(human_id, human, *world.human_data, ctx);
+        world.human_movement.dirty = true;
     }
 
     while (added_segments_count > 0) {
@@ -1993,57 +4256,97 @@ BF_FORCE_INLINE void Update_Segments(
     }
 }
 
-using Dir_v2i16 = std::tuple<Direction, v2i16>;
-
-#define QUEUES_SCALE 4
-
+// NOTE: Трассировка сегментов от изменённых тайлов, см. `Update_Tiles`.
+// Стоимость пропорциональна размеру затронутых сегментов, а не карты:
+// буферы `workspace` переиспользуются между вызовами и очищаются
+// только в тронутых клетках.
 void Update_Graphs(
-    const v2i16                  gsize,
-    const Element_Tile* const    element_tiles,
-    Graph_Segments_To_Add&       added_segments,
-    Fixed_Size_Queue<Dir_v2i16>& big_queue,
-    Fixed_Size_Queue<Dir_v2i16>& queue,
-    Arena&                       trash_arena,
-    u8* const                    visited,
-    const bool                   full_graph_build,
+    const v2i16               gsize,
+    const Element_Tile* const element_tiles,
+    Graph_Segments_To_Add&    added_segments,
+    Graph_Trace_Workspace&    workspace,
     MCTX
 ) {
     CTX_ALLOCATOR;
 
-    TEMP_USAGE(trash_arena);
-
     auto tiles_count = gsize.x * gsize.y;
 
-    bool* vis = nullptr;
-    if (full_graph_build)
-        vis = Allocate_Zeros_Array(trash_arena, bool, tiles_count);
+    if (workspace.generation == u32_max) {
+        memset(workspace.stamps, 0, sizeof(u32) * tiles_count);
+        workspace.generation = 0;
+    }
+    workspace.generation++;
 
-    while (big_queue.count) {
-        TEMP_USAGE(trash_arena);
+    auto& big_queue = workspace.big_queue;
+    auto& queue     = workspace.queue;
+    queue.Reset();
+
+    auto Visited = [&](v2i16 pos) -> u8& {
+        auto i = pos.y * gsize.x + pos.x;
+        if (workspace.stamps[i] != workspace.generation) {
+            workspace.stamps[i]  = workspace.generation;
+            workspace.visited[i] = 0;
+        }
+        return workspace.visited[i];
+    };
+
+    Graph temp_graph{};
+    temp_graph.nodes = workspace.nodes;
+    temp_graph.size  = gsize;
+
+    auto vertex_marks  = workspace.vertex_marks;
+    auto vertices      = workspace.vertices;
+    auto segment_tiles = workspace.segment_tiles;
+
+    int   vertices_count      = 0;
+    int   segment_tiles_count = 0;
+    v2i16 bounds_min          = gsize;
+    v2i16 bounds_max          = -v2i16_one;
+
+    auto Add_Vertex = [&](v2i16 pos) {
+        auto& mark = WORLD_PTR_OFFSET(vertex_marks, pos);
+        if (mark)
+            return;
+
+        mark = true;
+        Assert(vertices_count < tiles_count);
+        vertices[vertices_count++] = pos;
+    };
 
-        auto p           = big_queue.Dequeue();
-        *queue.Enqueue() = p;
+    auto Add_Edge = [&](v2i16 pos, Direction dir) {
+        if (!WORLD_PTR_OFFSET(temp_graph.nodes, pos)) {
+            Assert(segment_tiles_count < tiles_count);
+            segment_tiles[segment_tiles_count++] = pos;
 
-        auto [_, p_pos] = p;
-        if (full_graph_build)
-            WORLD_PTR_OFFSET(vis, p_pos) = true;
+            bounds_min.x = MIN(bounds_min.x, pos.x);
+            bounds_min.y = MIN(bounds_min.y, pos.y);
+            bounds_max.x = MAX(bounds_max.x, pos.x);
+            bounds_max.y = MAX(bounds_max.y, pos.y);
+        }
+        Graph_Update(temp_graph, pos, dir, true);
+    };
 
-        auto vertices      = Allocate_Zeros_Array(trash_arena, v2i16, tiles_count);
-        auto segment_tiles = Allocate_Zeros_Array(trash_arena, v2i16, tiles_count);
+    while (big_queue.count) {
+        auto p              = big_queue.Dequeue();
+        *queue.Enqueue(ctx) = p;
 
-        int vertices_count      = 0;
-        int segment_tiles_count = 1;
-        *(segment_tiles + 0)    = p_pos;
+        defer {
+            FOR_RANGE (int, i, segment_tiles_count) {
+                WORLD_PTR_OFFSET(temp_graph.nodes, segment_tiles[i]) = 0;
+            }
+            FOR_RANGE (int, i, vertices_count) {
+                WORLD_PTR_OFFSET(vertex_marks, vertices[i]) = false;
+            }
 
-        Graph temp_graph{};
-        temp_graph.nodes  = Allocate_Zeros_Array(trash_arena, u8, tiles_count);
-        temp_graph.size.x = gsize.x;
-        temp_graph.size.y = gsize.y;
+            temp_graph.nodes_count = 0;
+            vertices_count         = 0;
+            segment_tiles_count    = 0;
+            bounds_min             = gsize;
+            bounds_max             = -v2i16_one;
+        };
 
         while (queue.count) {
             auto [dir, pos] = queue.Dequeue();
-            if (full_graph_build)
-                WORLD_PTR_OFFSET(vis, pos) = true;
 
             auto& tile = WORLD_PTR_OFFSET(element_tiles, pos);
 
@@ -2052,13 +4355,13 @@ void Update_Graphs(
             bool is_vertex   = is_building || is_flag;
 
             if (is_vertex)
-                Add_Without_Duplication(tiles_count, vertices_count, vertices, pos);
+                Add_Vertex(pos);
 
             FOR_DIRECTION (dir_index) {
                 if (is_vertex && dir_index != dir)
                     continue;
 
-                u8& visited_value = WORLD_PTR_OFFSET(visited, pos);
+                u8& visited_value = Visited(pos);
                 if (Graph_Node_Has(visited_value, dir_index))
                     continue;
 
@@ -2067,7 +4370,7 @@ void Update_Graphs(
                     continue;
 
                 Direction opposite_dir_index = Opposite(dir_index);
-                u8&       new_visited_value  = WORLD_PTR_OFFSET(visited, new_pos);
+                u8&       new_visited_value  = Visited(new_pos);
                 if (Graph_Node_Has(new_visited_value, opposite_dir_index))
                     continue;
 
@@ -2089,7 +4392,7 @@ void Update_Graphs(
                         );
                         FOR_DIRECTION (new_dir_index) {
                             if (!Graph_Node_Has(new_visited_value, new_dir_index))
-                                *big_queue.Enqueue() = {new_dir_index, new_pos};
+                                *big_queue.Enqueue(ctx) = {new_dir_index, new_pos};
                         }
                     }
                     continue;
@@ -2098,55 +4401,18 @@ void Update_Graphs(
                 visited_value = Graph_Node_Mark(visited_value, dir_index, true);
                 new_visited_value
                     = Graph_Node_Mark(new_visited_value, opposite_dir_index, true);
-                Graph_Update(temp_graph, pos, dir_index, true);
-                Graph_Update(temp_graph, new_pos, opposite_dir_index, true);
-
-                if (full_graph_build && new_is_vertex) {
-                    FOR_DIRECTION (new_dir_index) {
-                        if (!Graph_Node_Has(new_visited_value, new_dir_index))
-                            *big_queue.Enqueue() = {new_dir_index, new_pos};
-                    }
-                }
-
-                Add_Without_Duplication(
-                    tiles_count, segment_tiles_count, segment_tiles, new_pos
-                );
+                Add_Edge(pos, dir_index);
+                Add_Edge(new_pos, opposite_dir_index);
 
-                if (new_is_vertex) {
-                    Add_Without_Duplication(
-                        tiles_count, vertices_count, vertices, new_pos
-                    );
-                }
-                else {
-                    *queue.Enqueue() = {(Direction)0, new_pos};
-                }
+                if (new_is_vertex)
+                    Add_Vertex(new_pos);
+                else
+                    *queue.Enqueue(ctx) = {(Direction)0, new_pos};
             }
 
             SANITIZE;
         }
 
-        // NOTE: Поиск островов графа.
-        if (full_graph_build && !big_queue.count) {
-            FOR_RANGE (int, y, gsize.y) {
-                FOR_RANGE (int, x, gsize.x) {
-                    auto  pos  = v2i16(x, y);
-                    auto& tile = WORLD_PTR_OFFSET(element_tiles, pos);
-                    u8&   v1   = WORLD_PTR_OFFSET(visited, pos);
-                    bool& v2   = WORLD_PTR_OFFSET(vis, pos);
-
-                    bool is_building = tile.type == Element_Tile_Type::Building;
-                    bool is_flag     = tile.type == Element_Tile_Type::Flag;
-                    bool is_vertex   = is_building || is_flag;
-
-                    if (is_vertex && !v1 && !v2) {
-                        FOR_DIRECTION (dir_index) {
-                            *big_queue.Enqueue() = {dir_index, pos};
-                        }
-                    }
-                }
-            }
-        }
-
         if (vertices_count <= 1)
             continue;
 
@@ -2163,25 +4429,12 @@ void Update_Graphs(
 
         segment.graph.nodes_count = temp_graph.nodes_count;
 
-        // NOTE: Вычисление size и offset графа.
+        // NOTE: size и offset графа считаются по ходу обхода.
         auto& gr_size = segment.graph.size;
         auto& offset  = segment.graph.offset;
 
-        offset = gsize - v2i16_one;
-
-        FOR_RANGE (int, y, gsize.y) {
-            FOR_RANGE (int, x, gsize.x) {
-                auto& node = *(temp_graph.nodes + y * gsize.x + x);
-                if (node) {
-                    gr_size.x = MAX(gr_size.x, x);
-                    gr_size.y = MAX(gr_size.y, y);
-                    offset.x  = MIN(offset.x, x);
-                    offset.y  = MIN(offset.y, y);
-                }
-            }
-        }
-        gr_size -= offset;
-        gr_size += v2i16_one;
+        offset  = bounds_min;
+        gr_size = bounds_max - bounds_min + v2i16_one;
 
         Assert(gr_size.x > 0);
         Assert(gr_size.y > 0);
@@ -2197,9 +4450,8 @@ void Update_Graphs(
 
         segment.graph.nodes = (u8*)ALLOC(nodes_allocation_count);
 
-        auto rows   = gr_size.y;
-        auto stride = gsize.x;
-        // auto stride        = gr_size.x;
+        auto rows          = gr_size.y;
+        auto stride        = gsize.x;
         auto starting_node = temp_graph.nodes + offset.y * gsize.x + offset.x;
         Rect_Copy(segment.graph.nodes, starting_node, stride, rows, gr_size.x);
 
@@ -2207,14 +4459,44 @@ void Update_Graphs(
     }
 }
 
+#define GRAPH_BUILD_ROWS_PER_TASK 16
+
+// NOTE: Область дорог, найденная при полном построении графа.
+struct Traced_Segment {
+    u32   root            = {};
+    u32   roads_offset    = {};
+    u32   roads_count     = {};
+    u32   vertices_offset = {};
+    u32   vertices_count  = {};  // NOTE: Уже без дубликатов.
+    v2i16 bounds_min      = {};
+    v2i16 bounds_max      = {};
+};
+
 // Создание сетки графа.
 // Вызывается на старте игры (предполагается, что при её загрузке).
+//
+// Сегмент - это связная область дорог вместе с примыкающими к ней
+// флагами и зданиями (вершинами). Сегменты с одной вершиной не нужны.
+//
+// 1. Union-find по клеткам дорог (параллельно по полосам строк).
+//    Корень области - её клетка с наименьшим индексом.
+// 2. Подсчёт размеров областей, раскладка по общим буферам.
+// 3. BFS по каждой области от её корня (параллельно по областям).
+// 4. Аллокация сегментов в порядке корней, заполнение нод
+//    и `Calculate_Segments_Graph_Data` (параллельно по сегментам).
+// 5. Связывание сегментов в том же порядке.
+//
+// Порядок обхода определяется только картой, поэтому результат
+// побайтово совпадает при любом `threads_count`.
 void Build_Graph_Segments(
-    Entity_ID&                                     last_entity_id,
+    Entity_Slots&                                  entities,
+    Vertex_Segments_Index&                         vertex_segments,
+    Graph_Segment_ID*                              segment_owners,
     v2i16                                          gsize,
     Element_Tile*                                  element_tiles,
     Sparse_Array<Graph_Segment_ID, Graph_Segment>& segments,
     Arena&                                         trash_arena,
+    u32                                            threads_count,
     std::invocable<Graph_Segments_To_Add&, Graph_Segments_To_Delete&, Context*> auto&&
         Update_Segments_Lambda,
     MCTX
@@ -2224,73 +4506,305 @@ void Build_Graph_Segments(
     Assert(segments.count == 0);
     TEMP_USAGE(trash_arena);
 
-    auto tiles_count = gsize.x * gsize.y;
+    const u32 tiles_count = gsize.x * gsize.y;
+    const u32 tasks_count
+        = (gsize.y + GRAPH_BUILD_ROWS_PER_TASK - 1) / GRAPH_BUILD_ROWS_PER_TASK;
 
-    // NOTE: Создание новых сегментов.
-    auto                  segments_to_add_allocate = tiles_count * 4;
-    Graph_Segments_To_Add segments_to_add{};
-    segments_to_add.max_count = segments_to_add_allocate;
-    segments_to_add.items
-        = Allocate_Zeros_Array(trash_arena, Graph_Segment, segments_to_add_allocate);
+    auto Is_Road = [&](u32 i) {
+        return element_tiles[i].type == Element_Tile_Type::Road;
+    };
+    auto Is_Vertex = [&](u32 i) {
+        auto type = element_tiles[i].type;
+        return type == Element_Tile_Type::Flag || type == Element_Tile_Type::Building;
+    };
+    auto For_Task_Rows = [&](u32 task, auto&& func) {
+        auto y0 = task * GRAPH_BUILD_ROWS_PER_TASK;
+        auto y1 = MIN(y0 + GRAPH_BUILD_ROWS_PER_TASK, (u32)gsize.y);
+        for (auto i = y0 * gsize.x; i < y1 * gsize.x; i++)
+            func(i);
+    };
 
-    v2i16 pos   = -v2i16_one;
-    bool  found = false;
-    FOR_RANGE (int, y, gsize.y) {
-        FOR_RANGE (int, x, gsize.x) {
-            auto& tile = *(element_tiles + y * gsize.x + x);
+    auto parent         = Allocate_Array(trash_arena, u32, tiles_count);
+    auto roads_count    = Allocate_Zeros_Array(trash_arena, u32, tiles_count);
+    auto vertices_count = Allocate_Zeros_Array(trash_arena, u32, tiles_count);
+
+    // NOTE: 1. Union-find.
+    Parallel_For(
+        threads_count,
+        tasks_count,
+        [&](Context*, u32 task) {
+            For_Task_Rows(task, [&](u32 i) { parent[i] = Is_Road(i) ? i : u32_max; });
+        },
+        ctx
+    );
 
-            if (tile.type == Element_Tile_Type::Flag
-                || tile.type == Element_Tile_Type::Building)
-            {
-                pos   = {x, y};
-                found = true;
-                break;
-            }
+    auto Find_Root = [&](u32 i) {
+        while (true) {
+            auto p = std::atomic_ref(parent[i]).load(std::memory_order_relaxed);
+            if (p == i)
+                return i;
+
+            // NOTE: Path halving.
+            auto pp = std::atomic_ref(parent[p]).load(std::memory_order_relaxed);
+            std::atomic_ref(parent[i])
+                .compare_exchange_weak(p, pp, std::memory_order_relaxed);
+            i = pp;
         }
+    };
 
-        if (found)
-            break;
+    auto Unite = [&](u32 a, u32 b) {
+        while (true) {
+            a = Find_Root(a);
+            b = Find_Root(b);
+            if (a == b)
+                return;
+
+            // NOTE: Больший корень подвешиваем под меньший,
+            // так что корнем остаётся клетка с наименьшим индексом.
+            if (a > b)
+                std::swap(a, b);
+
+            auto expected = b;
+            if (std::atomic_ref(parent[b])
+                    .compare_exchange_weak(expected, a, std::memory_order_relaxed))
+                return;
+        }
+    };
+
+    Parallel_For(
+        threads_count,
+        tasks_count,
+        [&](Context*, u32 task) {
+            For_Task_Rows(task, [&](u32 i) {
+                if (!Is_Road(i))
+                    return;
+
+                auto x = i % gsize.x;
+                auto y = i / gsize.x;
+                if (x + 1 < (u32)gsize.x && Is_Road(i + 1))
+                    Unite(i, i + 1);
+                if (y + 1 < (u32)gsize.y && Is_Road(i + gsize.x))
+                    Unite(i, i + gsize.x);
+            });
+        },
+        ctx
+    );
+
+    // NOTE: 2. Размеры областей.
+    // Вершина считается за каждую примыкающую клетку дороги,
+    // дубликаты уберутся после BFS.
+    Parallel_For(
+        threads_count,
+        tasks_count,
+        [&](Context*, u32 task) {
+            For_Task_Rows(task, [&](u32 i) {
+                if (!Is_Road(i))
+                    return;
+
+                auto pos  = v2i16(i % gsize.x, i / gsize.x);
+                u32  refs = 0;
+                FOR_DIRECTION (dir) {
+                    auto new_pos = pos + As_Offset(dir);
+                    if (Pos_Is_In_Bounds(new_pos, gsize)
+                        && Is_Vertex(new_pos.y * gsize.x + new_pos.x))
+                        refs++;
+                }
+
+                auto root = Find_Root(i);
+                std::atomic_ref(roads_count[root])
+                    .fetch_add(1, std::memory_order_relaxed);
+                if (refs)
+                    std::atomic_ref(vertices_count[root])
+                        .fetch_add(refs, std::memory_order_relaxed);
+            });
+        },
+        ctx
+    );
+
+    u32 traced_count         = 0;
+    u32 total_roads_count    = 0;
+    u32 total_vertices_count = 0;
+    FOR_RANGE (u32, i, tiles_count) {
+        if (parent[i] != i)
+            continue;
+
+        traced_count++;
+        total_roads_count += roads_count[i];
+        total_vertices_count += vertices_count[i];
     }
 
     SANITIZE;
 
-    if (!found)
+    if (!traced_count)
         return;
 
-    Fixed_Size_Queue<Dir_v2i16> big_queue{};
-    big_queue.memory_size = sizeof(Dir_v2i16) * tiles_count * QUEUES_SCALE;
-    big_queue.base = (Dir_v2i16*)Allocate_Array(trash_arena, u8, big_queue.memory_size);
+    auto traced   = Allocate_Zeros_Array(trash_arena, Traced_Segment, traced_count);
+    auto roads    = Allocate_Array(trash_arena, v2i16, total_roads_count);
+    auto vertices = Allocate_Array(trash_arena, v2i16, MAX(total_vertices_count, 1));
+    {
+        u32 k               = 0;
+        u32 roads_offset    = 0;
+        u32 vertices_offset = 0;
+        FOR_RANGE (u32, i, tiles_count) {
+            if (parent[i] != i)
+                continue;
 
-    FOR_DIRECTION (dir) {
-        *big_queue.Enqueue() = {dir, pos};
+            auto& t           = traced[k++];
+            t.root            = i;
+            t.roads_offset    = roads_offset;
+            t.vertices_offset = vertices_offset;
+            roads_offset += roads_count[i];
+            vertices_offset += vertices_count[i];
+        }
     }
 
-    Fixed_Size_Queue<Dir_v2i16> queue{};
-    queue.memory_size = sizeof(Dir_v2i16) * tiles_count * QUEUES_SCALE;
-    queue.base        = (Dir_v2i16*)Allocate_Array(trash_arena, u8, queue.memory_size);
+    // NOTE: 3. BFS по областям. Каждая область пишет только в свои
+    // куски `roads`, `vertices` и в свои клетки `visited`.
+    auto visited = Allocate_Zeros_Array(trash_arena, bool, tiles_count);
 
-    u8* visited = Allocate_Zeros_Array(trash_arena, u8, tiles_count);
+    Parallel_For(
+        threads_count,
+        traced_count,
+        [&](Context*, u32 k) {
+            auto& t       = traced[k];
+            auto  t_roads = roads + t.roads_offset;
+            auto  t_verts = vertices + t.vertices_offset;
 
-    bool full_graph_build = true;
+            auto root_pos = v2i16(t.root % gsize.x, t.root / gsize.x);
+            t_roads[0]    = root_pos;
+            t.roads_count = 1;
+            t.bounds_min  = root_pos;
+            t.bounds_max  = root_pos;
 
-    Update_Graphs(
-        gsize,
-        element_tiles,
-        segments_to_add,
-        big_queue,
-        queue,
-        trash_arena,
-        visited,
-        full_graph_build,
+            WORLD_PTR_OFFSET(visited, root_pos) = true;
+
+            u32 vertex_refs = 0;
+            for (u32 head = 0; head < t.roads_count; head++) {
+                auto pos = t_roads[head];
+
+                FOR_DIRECTION (dir) {
+                    auto new_pos = pos + As_Offset(dir);
+                    if (!Pos_Is_In_Bounds(new_pos, gsize))
+                        continue;
+
+                    auto new_i = new_pos.y * gsize.x + new_pos.x;
+                    if (Is_Vertex(new_i)) {
+                        t_verts[vertex_refs++] = new_pos;
+                    }
+                    else if (Is_Road(new_i) && !visited[new_i]) {
+                        visited[new_i]           = true;
+                        t_roads[t.roads_count++] = new_pos;
+                    }
+                    else
+                        continue;
+
+                    t.bounds_min.x = MIN(t.bounds_min.x, new_pos.x);
+                    t.bounds_min.y = MIN(t.bounds_min.y, new_pos.y);
+                    t.bounds_max.x = MAX(t.bounds_max.x, new_pos.x);
+                    t.bounds_max.y = MAX(t.bounds_max.y, new_pos.y);
+                }
+            }
+            Assert(t.roads_count == roads_count[t.root]);
+            Assert(vertex_refs == vertices_count[t.root]);
+
+            // NOTE: Вершины упорядочиваются построчно.
+            std::sort(t_verts, t_verts + vertex_refs, [](v2i16 a, v2i16 b) {
+                return (a.y != b.y) ? (a.y < b.y) : (a.x < b.x);
+            });
+            t.vertices_count = std::unique(t_verts, t_verts + vertex_refs) - t_verts;
+        },
+        ctx
+    );
+
+    // NOTE: 4. Сегменты.
+    Graph_Segments_To_Add segments_to_add{};
+    segments_to_add.max_count = traced_count;
+    segments_to_add.items
+        = Allocate_Zeros_Array(trash_arena, Graph_Segment, traced_count);
+
+    auto segments_traced = Allocate_Array(trash_arena, Traced_Segment*, traced_count);
+
+    FOR_RANGE (u32, k, traced_count) {
+        auto& t = traced[k];
+        if (t.vertices_count <= 1)
+            continue;
+
+        segments_traced[segments_to_add.count] = &t;
+
+        auto& segment          = *segments_to_add.Add_Unsafe();
+        segment.vertices_count = t.vertices_count;
+        segment.vertices       = (v2i16*)ALLOC(sizeof(v2i16) * t.vertices_count);
+        memcpy(
+            segment.vertices,
+            vertices + t.vertices_offset,
+            sizeof(v2i16) * t.vertices_count
+        );
+
+        auto& graph                  = segment.graph;
+        graph.offset                 = t.bounds_min;
+        graph.size                   = t.bounds_max - t.bounds_min + v2i16_one;
+        graph.nodes_count            = t.roads_count + t.vertices_count;
+        graph.nodes_allocation_count = graph.size.x * graph.size.y;
+        graph.nodes = (u8*)ALLOC(graph.nodes_allocation_count);
+    }
+
+    // NOTE: У дороги есть ребро в каждую непустую соседнюю клетку,
+    // у вершины - в каждую соседнюю дорогу этого сегмента.
+    Parallel_For(
+        threads_count,
+        segments_to_add.count,
+        [&](Context*, u32 k) {
+            auto& t       = *segments_traced[k];
+            auto& graph   = segments_to_add.items[k].graph;
+            auto  t_roads = roads + t.roads_offset;
+
+            memset(graph.nodes, 0, graph.nodes_allocation_count);
+
+            FOR_RANGE (u32, i, t.roads_count) {
+                auto  pos   = t_roads[i];
+                auto  local = pos - graph.offset;
+                auto& node  = graph.nodes[local.y * graph.size.x + local.x];
+
+                FOR_DIRECTION (dir) {
+                    auto new_pos = pos + As_Offset(dir);
+                    if (!Pos_Is_In_Bounds(new_pos, gsize))
+                        continue;
+
+                    auto new_i = new_pos.y * gsize.x + new_pos.x;
+                    if (element_tiles[new_i].type == Element_Tile_Type::None)
+                        continue;
+
+                    node = Graph_Node_Mark(node, dir, true);
+
+                    if (Is_Vertex(new_i)) {
+                        auto  v_local = new_pos - graph.offset;
+                        auto& v_node  = graph.nodes[v_local.y * graph.size.x + v_local.x];
+                        v_node        = Graph_Node_Mark(v_node, Opposite(dir), true);
+                    }
+                }
+            }
+        },
         ctx
     );
 
+    Calculate_Segments_Graph_Data(segments_to_add, threads_count, trash_arena, ctx);
+
+    SANITIZE;
+
+    // NOTE: 5. Связывание.
     Graph_Segments_To_Delete no_segments_to_delete{};
     Update_Segments_Lambda(segments_to_add, no_segments_to_delete, ctx);
 
-    FOR_RANGE (u32, i, segments_to_add.count) {
+    FOR_RANGE (i32, i, segments_to_add.count) {
         Add_And_Link_Segment(
-            last_entity_id, segments, segments_to_add.items[i], trash_arena, ctx
+            entities,
+            vertex_segments,
+            segment_owners,
+            gsize,
+            segments,
+            segments_to_add.items[i],
+            trash_arena,
+            ctx
         );
     }
 
@@ -2302,8 +4816,11 @@ void Build_Graph_Segments(
 std::tuple<int, int> Update_Tiles(
     v2i16                                          gsize,
     Element_Tile*                                  element_tiles,
+    const Graph_Segment_ID*                        segment_owners,
     Sparse_Array<Graph_Segment_ID, Graph_Segment>* segments,
+    Graph_Trace_Workspace&                         graph_trace,
     Arena&                                         trash_arena,
+    u32                                            threads_count,
     const Updated_Tiles&                           updated_tiles,
     std::invocable<Graph_Segments_To_Add&, Graph_Segments_To_Delete&, Context*> auto&&
         Update_Segments_Lambda,
@@ -2317,9 +4834,8 @@ std::tuple<int, int> Update_Tiles(
 
     TEMP_USAGE(trash_arena);
 
-    auto tiles_count = gsize.x * gsize.y;
-
     // NOTE: Ищем сегменты для удаления.
+    // Смотрим только на владельцев затронутых клеток, а не на все сегменты.
     auto segments_to_delete_allocate = updated_tiles.count * 4;
 
     Graph_Segments_To_Delete segments_to_delete{};
@@ -2328,11 +4844,75 @@ std::tuple<int, int> Update_Tiles(
         trash_arena, Segment_To_Delete, segments_to_delete_allocate
     );
 
-    for (auto [id, segment_p] : Iter(segments)) {
-        if (Should_Segment_Be_Deleted(gsize, element_tiles, updated_tiles, *segment_p))
+    auto Add_Owners_To_Delete = [&](v2i16 pos) {
+        auto owners = segment_owners + 4 * (pos.y * gsize.x + pos.x);
+
+        FOR_RANGE (u8, dir, 4) {
+            auto id = owners[dir];
+            if (id == Graph_Segment_ID_Missing)
+                continue;
+
+            bool found = false;
+            FOR_RANGE (u32, i, segments_to_delete.count) {
+                if (std::get<0>(segments_to_delete.items[i]) == id) {
+                    found = true;
+                    break;
+                }
+            }
+            if (found)
+                continue;
+
+            auto segment_p = segments->Find(id);
+            Assert(segment_p != nullptr);
             *segments_to_delete.Add_Unsafe() = Segment_To_Delete(id, segment_p);
+        }
     };
 
+    FOR_RANGE (u16, i, updated_tiles.count) {
+        auto& tile_pos     = *(updated_tiles.pos + i);
+        auto& updated_type = *(updated_tiles.type + i);
+
+        switch (updated_type) {
+        case Tile_Updated_Type::Road_Placed:
+        case Tile_Updated_Type::Building_Placed: {
+            for (auto& offset : v2i16_adjacent_offsets) {
+                auto pos = tile_pos + offset;
+                if (!Pos_Is_In_Bounds(pos, gsize))
+                    continue;
+
+                auto& tile = WORLD_PTR_OFFSET(element_tiles, pos);
+                if (tile.type == Element_Tile_Type::Road)
+                    Add_Owners_To_Delete(pos);
+            }
+        } break;
+
+        case Tile_Updated_Type::Flag_Placed:
+        case Tile_Updated_Type::Flag_Removed:
+        case Tile_Updated_Type::Road_Removed:
+        case Tile_Updated_Type::Building_Removed: {
+            if (Pos_Is_In_Bounds(tile_pos, gsize))
+                Add_Owners_To_Delete(tile_pos);
+        } break;
+
+        default:
+            INVALID_PATH;
+        }
+    }
+
+#if ASSERT_SLOW
+    for (auto [id, segment_p] : Iter(segments)) {
+        bool found = false;
+        FOR_RANGE (u32, i, segments_to_delete.count) {
+            if (std::get<0>(segments_to_delete.items[i]) == id)
+                found = true;
+        }
+
+        auto should_be_deleted
+            = Should_Segment_Be_Deleted(gsize, element_tiles, updated_tiles, *segment_p);
+        Assert(found == should_be_deleted);
+    }
+#endif
+
     // NOTE: Создание новых сегментов.
     auto                  segments_to_add_allocate = updated_tiles.count * 4;
     Graph_Segments_To_Add segments_to_add{};
@@ -2340,9 +4920,10 @@ std::tuple<int, int> Update_Tiles(
     segments_to_add.items
         = Allocate_Zeros_Array(trash_arena, Graph_Segment, segments_to_add_allocate);
 
-    Fixed_Size_Queue<Dir_v2i16> big_queue{};
-    big_queue.memory_size = sizeof(Dir_v2i16) * tiles_count * QUEUES_SCALE;
-    big_queue.base = (Dir_v2i16*)Allocate_Array(trash_arena, u8, big_queue.memory_size);
+    // NOTE: Очередь живёт в `graph_trace` и растёт по ходу обхода,
+    // так что её размер определяется правкой, а не картой.
+    auto& big_queue = graph_trace.big_queue;
+    big_queue.Reset();
 
     FOR_RANGE (auto, i, updated_tiles.count) {
         const auto& updated_type = *(updated_tiles.type + i);
@@ -2359,7 +4940,7 @@ std::tuple<int, int> Update_Tiles(
                 if (element_tile.type == Element_Tile_Type::None)
                     continue;
 
-                *big_queue.Enqueue() = {dir, pos};
+                *big_queue.Enqueue(ctx) = {dir, pos};
             }
         } break;
 
@@ -2371,7 +4952,7 @@ std::tuple<int, int> Update_Tiles(
 
                 auto& element_tile = WORLD_PTR_OFFSET(element_tiles, new_pos);
                 if (element_tile.type == Element_Tile_Type::Road)
-                    *big_queue.Enqueue() = {dir, pos};
+                    *big_queue.Enqueue(ctx) = {dir, pos};
             }
         } break;
 
@@ -2383,7 +4964,7 @@ std::tuple<int, int> Update_Tiles(
 
                 auto& element_tile = WORLD_PTR_OFFSET(element_tiles, new_pos);
                 if (element_tile.type != Element_Tile_Type::None)
-                    *big_queue.Enqueue() = {dir, pos};
+                    *big_queue.Enqueue(ctx) = {dir, pos};
             }
         } break;
 
@@ -2398,7 +4979,7 @@ std::tuple<int, int> Update_Tiles(
                     continue;
 
                 FOR_DIRECTION (dir) {
-                    *big_queue.Enqueue() = {dir, new_pos};
+                    *big_queue.Enqueue(ctx) = {dir, new_pos};
                 }
             }
         } break;
@@ -2420,7 +5001,7 @@ std::tuple<int, int> Update_Tiles(
                     continue;
 
                 FOR_DIRECTION (dir) {
-                    *big_queue.Enqueue() = {dir, new_pos};
+                    *big_queue.Enqueue(ctx) = {dir, new_pos};
                 }
             }
         } break;
@@ -2434,7 +5015,7 @@ std::tuple<int, int> Update_Tiles(
                 auto& element_tile = WORLD_PTR_OFFSET(element_tiles, new_pos);
                 if (element_tile.type == Element_Tile_Type::Road) {
                     FOR_DIRECTION (new_dir) {
-                        *big_queue.Enqueue() = {new_dir, new_pos};
+                        *big_queue.Enqueue(ctx) = {new_dir, new_pos};
                     }
                 }
             }
@@ -2445,25 +5026,9 @@ std::tuple<int, int> Update_Tiles(
         }
     }
 
-    // NOTE: Each byte here contains differently bit-shifted values of `Direction`.
-    u8* visited = Allocate_Zeros_Array(trash_arena, u8, tiles_count);
+    Update_Graphs(gsize, element_tiles, segments_to_add, graph_trace, ctx);
 
-    Fixed_Size_Queue<Dir_v2i16> queue{};
-    queue.memory_size = sizeof(Dir_v2i16) * tiles_count * QUEUES_SCALE;
-    queue.base        = (Dir_v2i16*)Allocate_Array(trash_arena, u8, queue.memory_size);
-
-    bool full_graph_build = false;
-    Update_Graphs(
-        gsize,
-        element_tiles,
-        segments_to_add,
-        big_queue,
-        queue,
-        trash_arena,
-        visited,
-        full_graph_build,
-        ctx
-    );
+    Calculate_Segments_Graph_Data(segments_to_add, threads_count, trash_arena, ctx);
 
     Update_Segments_Lambda(segments_to_add, segments_to_delete, ctx);
 
@@ -2512,13 +5077,32 @@ std::tuple<int, int> Update_Tiles(
     auto type__            = (type_);                      \
     (variable_name_).type  = &type__;
 
+// NOTE: Флаги не меняют стоимость прохода по тайлу,
+// поэтому поля расстояний и кластеры поиска пути после них остаются валидными.
+// Поля и кластеры сбрасываются до `Update_Tiles` - `Update_Segments` уже ищет пути.
 #define INVOKE_UPDATE_TILES                                                            \
     STATEMENT({                                                                        \
+        bool path_costs_changed = false;                                               \
+        FOR_RANGE (i32, i, updated_tiles.count) {                                      \
+            auto type = updated_tiles.type[i];                                         \
+            if (type == Tile_Updated_Type::Flag_Placed                                 \
+                || type == Tile_Updated_Type::Flag_Removed)                            \
+                continue;                                                              \
+                                                                                       \
+            path_costs_changed = true;                                                 \
+            Mark_Path_Clusters_Dirty(game.world.path_hierarchy, updated_tiles.pos[i]); \
+        }                                                                              \
+        if (path_costs_changed)                                                        \
+            Invalidate_Flow_Fields(game.world);                                        \
+                                                                                       \
         Update_Tiles(                                                                  \
             game.world.size,                                                           \
             game.world.element_tiles,                                                  \
+            game.world.segment_owners,                                                 \
             &game.world.segments,                                                      \
+            game.world.graph_trace,                                                    \
             trash_arena,                                                               \
+            game.threads_count,                                                        \
             updated_tiles,                                                             \
             [&world, &trash_arena, &game](                                             \
                 Graph_Segments_To_Add&    segments_to_add,                             \
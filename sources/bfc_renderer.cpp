@@ -211,21 +211,14 @@ void Init_Renderer(
         game.renderer = Allocate_Zeros_For(arena, Renderer);
 }
 
-void Add_Building_Sprite(
-    Renderer&   renderer,
-    World&      world,
-    v2i         pos,
-    Building_ID building_id,
-    MCTX
-) {
+void Add_Building_Sprite(Renderer& renderer, const Render_Dirty_Tile& tile, MCTX) {
+    auto building_id = tile.tile.building_id;
     Assert(building_id != Building_ID_Missing);
 
-    auto building = *Strict_Query_Building(world, building_id);
-
-    auto& scriptable = *building.scriptable;
+    auto& scriptable = Assert_Deref(tile.scriptable);
 
     C_Sprite building_sprite{};
-    building_sprite.pos   = pos;
+    building_sprite.pos   = v2i(tile.pos);
     building_sprite.scale = {1, 1};
     // building_sprite.anchor   = {0.5f, 0.5f};
     building_sprite.anchor   = {1, 1};
@@ -234,19 +227,18 @@ void Add_Building_Sprite(
     Assert(scriptable.texture != Texture_ID_Missing);
     building_sprite.z = 0;
 
-    if (building.remaining_construction_points)
+    if (tile.under_construction)
         building_sprite.texture = renderer.building_in_progress_texture;
     else
         building_sprite.texture = scriptable.texture;
 
     {
-        auto [pid, pvalue] = renderer.sprites.Add(ctx);
-        *pid               = building_id;
-        *pvalue            = building_sprite;
+        auto [_, pvalue] = renderer.sprites.Add(building_id.id, ctx);
+        *pvalue          = building_sprite;
     }
 }
 
-void Set_Flag_Tile(Renderer& renderer, World& /* world */, v2i pos, MCTX_) {
+void Set_Flag_Tile(Renderer& renderer, v2i pos, MCTX_) {
     auto& placeables_tilemap = renderer.tilemaps[renderer.element_tilemap_index + 1];
 
     auto t = pos.y * placeables_tilemap.size.x + pos.x;
@@ -710,12 +702,21 @@ void main() {
     }
 
     // --- Element Tiles ---
+    // NOTE: Дальше рендер узнаёт о постройках только из снапшотов.
+    renderer.element_tiles
+        = Allocate_Array(non_persistent_arena, Element_Tile, gsize.x * gsize.y);
+    memcpy(
+        renderer.element_tiles,
+        world.element_tiles,
+        sizeof(Element_Tile) * gsize.x * gsize.y
+    );
+
     auto& element_tilemap = renderer.tilemaps[renderer.element_tilemap_index];
     FOR_RANGE (i32, y, gsize.y) {
         FOR_RANGE (i32, x, gsize.x) {
             const auto t = y * gsize.x + x;
 
-            const Element_Tile& element_tile = world.element_tiles[t];
+            const Element_Tile& element_tile = renderer.element_tiles[t];
 
             auto type = element_tile.type;
 
@@ -724,18 +725,18 @@ void main() {
                 || type == Element_Tile_Type::Road)
             {
                 auto tex
-                    = Get_Road_Texture_Number(world.element_tiles, v2i16(x, y), gsize);
+                    = Get_Road_Texture_Number(renderer.element_tiles, v2i16(x, y), gsize);
                 auto& tile_id               = element_tilemap.tiles[t];
                 tile_id                     = global_road_starting_tile_id + tex;
                 element_tilemap.textures[t] = renderer.road_textures[tex];
 
-                if (element_tile.type == Element_Tile_Type::Building)
-                    Add_Building_Sprite(
-                        renderer, world, {x, y}, element_tile.building_id, ctx
-                    );
+                if (element_tile.type == Element_Tile_Type::Building) {
+                    auto tile = Make_Render_Dirty_Tile(world, v2i16(x, y));
+                    Add_Building_Sprite(renderer, tile, ctx);
+                }
 
                 if (element_tile.type == Element_Tile_Type::Flag)
-                    Set_Flag_Tile(renderer, world, {x, y}, ctx);
+                    Set_Flag_Tile(renderer, {x, y}, ctx);
             }
         }
     }
@@ -757,10 +758,8 @@ void main() {
         sprite.anchor  = v2f_half;
 
         {
-            auto [id_p, sprite_p] = renderer.sprites.Add(ctx);
-
-            *id_p     = id;
-            *sprite_p = sprite;
+            auto [_, sprite_p] = renderer.sprites.Add(id.id, ctx);
+            *sprite_p          = sprite;
         }
     }
 
@@ -1361,7 +1360,12 @@ void Render_UI(Game& game, f32 /* dt */, MCTX_) {
 
 #if 0
             if (human.moving.path.count > 0) {
-                auto last_p = human.moving.path.base[human.moving.path.count - 1];
+                // NOTE: Курсор - копия, пул путей не меняется.
+                auto  cursor = human.moving.path;
+                v2i16 last_p = {};
+                while (cursor.count > 0)
+                    last_p = Dequeue_Path_Tile(world.human_paths, cursor);
+
                 auto p = W2GL * v3f((v2f(last_p) + v2f_half) * (f32)cell_size, 1);
 
                 glPointSize(12);
@@ -1459,6 +1463,80 @@ void Render_UI(Game& game, f32 /* dt */, MCTX_) {
     );
 }
 
+// NOTE: Перерисовка клетки, на которой что-то построили, и дорог вокруг неё.
+void Renderer_Apply_Dirty_Tile(
+    Renderer&                renderer,
+    v2i16                    gsize,
+    const Render_Dirty_Tile& dirty_tile,
+    MCTX
+) {
+    CTX_ALLOCATOR;
+
+    auto pos = dirty_tile.pos;
+
+    // Тут рисуются дороги.
+    auto& roads_tilemap = renderer.tilemaps[renderer.element_tilemap_index];
+    // Тут рисуются флаги и здания.
+    auto& placeables_tilemap = renderer.tilemaps[renderer.element_tilemap_index + 1];
+
+    auto t = pos.y * gsize.x + pos.x;
+
+    auto& element_tile = renderer.element_tiles[t];
+    element_tile       = dirty_tile.tile;
+
+    switch (element_tile.type) {
+    case Element_Tile_Type::Building:
+    case Element_Tile_Type::Road: {
+        placeables_tilemap.tiles[pos.y * gsize.x + pos.x] = 0;
+    } break;
+
+    case Element_Tile_Type::Flag: {
+        placeables_tilemap.tiles[pos.y * gsize.x + pos.x] = global_flag_starting_tile_id;
+    } break;
+
+    default:
+        INVALID_PATH;
+    }
+
+    if (element_tile.type != Element_Tile_Type::Building)
+        Assert(element_tile.building_id == Building_ID_Missing);
+
+    if (element_tile.type == Element_Tile_Type::Building)
+        Add_Building_Sprite(renderer, dirty_tile, ctx);
+
+    if (element_tile.type == Element_Tile_Type::Flag)
+        Set_Flag_Tile(renderer, pos, ctx);
+
+    for (auto offset : v2i16_adjacent_offsets_including_0) {
+        auto new_pos = pos + offset;
+        if (!Pos_Is_In_Bounds(new_pos, gsize))
+            continue;
+
+        auto t = new_pos.y * gsize.x + new_pos.x;
+
+        auto& element_tile = renderer.element_tiles[t];
+
+        switch (element_tile.type) {
+        case Element_Tile_Type::Building:
+        case Element_Tile_Type::Flag:
+        case Element_Tile_Type::Road: {
+            auto tex
+                = Get_Road_Texture_Number(renderer.element_tiles, new_pos, gsize);
+            auto& tile_id = roads_tilemap.tiles[t];
+            tile_id       = global_road_starting_tile_id + tex;
+            auto& texture_id = roads_tilemap.textures[t];
+            texture_id       = renderer.road_textures[tex];
+        } break;
+
+        case Element_Tile_Type::None:
+            break;
+
+        default:
+            INVALID_PATH;
+        }
+    }
+}
+
 void Render(Game& game, f32 dt, MCTX) {
     CTX_ALLOCATOR;
     CTX_LOGGER;
@@ -1578,29 +1656,39 @@ void Render(Game& game, f32 dt, MCTX) {
     W2GL      = glm::scale(W2GL, v2f(2, -2));
     W2GL *= W2RelScreen;
 
+    // NOTE: Всё, что рендер знает о мире после инициализации, приходит в снапшотах.
+    auto& snapshots = Assert_Deref(game.render_snapshots);
+    auto  fresh     = Acquire_Render_Snapshot(snapshots);
+    auto& snapshot  = snapshots.buffers[snapshots.read];
+
+    // Перерисовка построенного.
+    if (fresh) {
+        ZoneScopedN("Dirty tiles updating");
+
+        FOR_RANGE (i32, i, snapshot.dirty_tiles_count) {
+            Renderer_Apply_Dirty_Tile(renderer, gsize, snapshot.dirty_tiles[i], ctx);
+        }
+    }
+
     // Обновление позиций чувачков.
     {
         ZoneScopedN("Human positions updating");
 
-        // TODO: Посмотреть что там по ECS
-        for (auto [human_id, human_ptr] : Iter(&world.humans)) {
-            auto& human = *human_ptr;
+        // NOTE: Симуляция отстаёт от кадра на `snapshot.ahead` секунд.
+        auto ahead = snapshot.ahead;
 
-            for (auto [sprite_id, sprite_ptr] : Iter(&renderer.sprites)) {
-                if (human_id != sprite_id)
-                    continue;
+        // TODO: Посмотреть что там по ECS
+        FOR_RANGE (i32, i, snapshot.humans_count) {
+            auto& transform = snapshot.humans[i];
 
-                v2f pos = v2f(human.moving.pos);
+            auto sprite_ptr = renderer.sprites.Find(transform.id.id);
+            if (sprite_ptr == nullptr)
+                continue;
 
-                if (human.moving.to.has_value())
-                    pos = Lerp_v2f(
-                        {human.moving.pos},
-                        {human.moving.to.value()},
-                        human.moving.progress
-                    );
+            auto progress = transform.progress + ahead * transform.progress_per_second;
+            auto pos = Lerp_v2f({transform.pos}, {transform.to}, MIN(1.0f, progress));
 
-                sprite_ptr->pos = pos + v2f_half;
-            }
+            sprite_ptr->pos = pos + v2f_half;
         }
     }
 
@@ -1882,79 +1970,6 @@ void Render(Game& game, f32 dt, MCTX) {
     SANITIZE;
 }
 
-// NOTE: Game& game, v2i16 pos, Item_To_Build item
-On_Item_Built_function(Renderer_OnItemBuilt) {
-    UNUSED(item);
-
-    Assert(game.renderer != nullptr);
-
-    CTX_ALLOCATOR;
-
-    auto& renderer = *game.renderer;
-    auto& world    = game.world;
-    auto  gsize    = world.size;
-
-    // Тут рисуются дороги.
-    auto& roads_tilemap = renderer.tilemaps[renderer.element_tilemap_index];
-    // Тут рисуются флаги и здания.
-    auto& placeables_tilemap = renderer.tilemaps[renderer.element_tilemap_index + 1];
-
-    auto t = pos.y * gsize.x + pos.x;
-
-    auto& element_tile = world.element_tiles[t];
-
-    switch (element_tile.type) {
-    case Element_Tile_Type::Building:
-    case Element_Tile_Type::Road: {
-        placeables_tilemap.tiles[pos.y * gsize.x + pos.x] = 0;
-    } break;
-
-    case Element_Tile_Type::Flag: {
-        placeables_tilemap.tiles[pos.y * gsize.x + pos.x] = global_flag_starting_tile_id;
-    } break;
-
-    default:
-        INVALID_PATH;
-    }
-
-    if (element_tile.type != Element_Tile_Type::Building)
-        Assert(element_tile.building_id == Building_ID_Missing);
-
-    if (element_tile.type == Element_Tile_Type::Building)
-        Add_Building_Sprite(renderer, world, pos, element_tile.building_id, ctx);
-
-    if (element_tile.type == Element_Tile_Type::Flag)
-        Set_Flag_Tile(renderer, world, pos, ctx);
-
-    for (auto offset : v2i16_adjacent_offsets_including_0) {
-        auto new_pos = pos + offset;
-        if (!Pos_Is_In_Bounds(new_pos, gsize))
-            continue;
-
-        auto t = new_pos.y * gsize.x + new_pos.x;
-
-        auto& element_tile = world.element_tiles[t];
-
-        switch (element_tile.type) {
-        case Element_Tile_Type::Building:
-        case Element_Tile_Type::Flag:
-        case Element_Tile_Type::Road: {
-            auto  tex     = Get_Road_Texture_Number(world.element_tiles, new_pos, gsize);
-            auto& tile_id = roads_tilemap.tiles[t];
-            tile_id       = global_road_starting_tile_id + tex;
-            auto& texture_id = roads_tilemap.textures[t];
-            texture_id       = renderer.road_textures[tex];
-        } break;
-
-        case Element_Tile_Type::None:
-            break;
-
-        default:
-            INVALID_PATH;
-        }
-    }
-}
-
 // Game& game, const Human_ID& id, Human& human, MCTX
 On_Human_Created_function(Renderer_OnHumanCreated) {
     auto& renderer = *game.renderer;
@@ -1968,9 +1983,8 @@ On_Human_Created_function(Renderer_OnHumanCreated) {
     human_sprite.z        = 0;
 
     {
-        auto [pid, pvalue] = renderer.sprites.Add(ctx);
-        *pid               = id;
-        *pvalue            = human_sprite;
+        auto [_, pvalue] = renderer.sprites.Add(id.id, ctx);
+        *pvalue          = human_sprite;
     }
 }
 
@@ -1988,5 +2002,5 @@ On_Human_Removed_function(Renderer_OnHumanRemoved) {
 
     auto& renderer = *game.renderer;
 
-    renderer.sprites.Unstable_Remove(id);
+    renderer.sprites.Unstable_Remove(id.id);
 }
@@ -0,0 +1,414 @@
+// NOTE: Бенчмарки без рендера, ImGui и OpenGL.
+// Каждый бенчмарк печатает среднее время одной итерации.
+//
+// Использование:
+//     linux_benchmarks [name_filter]
+//
+// Без аргумента запускаются все бенчмарки,
+// иначе - только те, в названии которых есть `name_filter`.
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include "bf_base.h"
+#include "bf_game.h"
+
+// NOLINTBEGIN(bugprone-suspicious-include)
+#include "bf_game.cpp"
+#include "linux_memory.cpp"
+// NOLINTEND(bugprone-suspicious-include)
+
+static_assert(BF_SERVER && !BF_CLIENT);
+
+global_var const char* benchmarks_filter = nullptr;
+
+// NOTE: Сюда складываются результаты, чтобы компилятор не выкинул вычисления.
+global_var volatile i64 benchmarks_sink = 0;
+
+f64 Benchmark_Time() {
+    timespec now{};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (f64)now.tv_sec + (f64)now.tv_nsec / 1'000'000'000.0;
+}
+
+// Вызывает `func` `iterations` раз после одного прогревочного вызова.
+void Run_Benchmark(const char* name, i32 iterations, auto&& func) {
+    if (benchmarks_filter != nullptr && strstr(name, benchmarks_filter) == nullptr)
+        return;
+
+    func();
+
+    auto started_at = Benchmark_Time();
+    FOR_RANGE (i32, i, iterations) {
+        func();
+    }
+    auto elapsed = Benchmark_Time() - started_at;
+
+    printf("%-48s %12.3f us\n", name, elapsed * 1'000'000.0 / iterations);
+}
+
+//----------------------------------------------------------------------------------
+// Queues.
+//----------------------------------------------------------------------------------
+// NOTE: `Fixed_Size_Queue` до перехода на кольцевой буфер.
+// Оставлена только для сравнения.
+template <typename T>
+struct Memmove_Queue {
+    size_t memory_size = 0;
+    i32    count       = 0;
+    T*     base        = nullptr;
+
+    T* Enqueue() {
+        Assert(memory_size >= (count + 1) * sizeof(T));
+        auto result = base + count;
+        count++;
+        return result;
+    }
+
+    T Dequeue() {
+        Assert(base != nullptr);
+        Assert(count > 0);
+
+        T result = *base;
+        count--;
+        if (count > 0)
+            memmove((void*)base, (void*)(base + 1), sizeof(T) * count);
+
+        return result;
+    }
+};
+
+// NOTE: BFS по пустой карте из её центра, как в `Update_Graphs`.
+template <typename Queue_Type>
+i32 Grid_BFS(Queue_Type& queue, u8* visited, v2i16 gsize) {
+    memset(visited, 0, (size_t)gsize.x * gsize.y);
+
+    v2i16 start                          = gsize / (i16)2;
+    visited[start.y * gsize.x + start.x] = 1;
+    *queue.Enqueue()                     = start;
+
+    i32 visited_count = 0;
+    while (queue.count > 0) {
+        auto pos = queue.Dequeue();
+        visited_count++;
+
+        FOR_DIRECTION (dir) {
+            auto new_pos = pos + As_Offset(dir);
+            if (!Pos_Is_In_Bounds(new_pos, gsize))
+                continue;
+
+            auto& v = visited[new_pos.y * gsize.x + new_pos.x];
+            if (v)
+                continue;
+
+            v                = 1;
+            *queue.Enqueue() = new_pos;
+        }
+    }
+
+    return visited_count;
+}
+
+void Benchmark_Queues() {
+    char name[64];
+
+    for (i16 size : {64, 256, 1024}) {
+        v2i16 gsize       = {size, size};
+        auto  tiles_count = (u32)size * size;
+        auto  visited     = new u8[tiles_count];
+        auto  memory      = new v2i16[Ceil_To_Power_Of_2(tiles_count)];
+
+        auto iterations = MAX(1, (i32)(4'000'000 / tiles_count));
+
+        Fixed_Size_Queue<v2i16> ring_queue{};
+        ring_queue.max_count = Ceil_To_Power_Of_2(tiles_count);
+        ring_queue.base      = memory;
+
+        snprintf(name, sizeof(name), "bfs %dx%d Fixed_Size_Queue", size, size);
+        Run_Benchmark(name, iterations, [&]() {
+            ring_queue.count = 0;
+            ring_queue.head  = 0;
+            benchmarks_sink = benchmarks_sink + Grid_BFS(ring_queue, visited, gsize);
+        });
+
+        Memmove_Queue<v2i16> memmove_queue{};
+        memmove_queue.memory_size = sizeof(v2i16) * tiles_count;
+        memmove_queue.base        = memory;
+
+        snprintf(name, sizeof(name), "bfs %dx%d memmove queue", size, size);
+        Run_Benchmark(name, MAX(1, iterations / 16), [&]() {
+            memmove_queue.count = 0;
+            benchmarks_sink = benchmarks_sink + Grid_BFS(memmove_queue, visited, gsize);
+        });
+
+        delete[] memory;
+        delete[] visited;
+    }
+
+    // NOTE: Путь чувачка - `Bulk_Enqueue` всего пути и `Dequeue` по одному тайлу.
+    Context _ctx{};
+    auto    ctx = &_ctx;
+
+    for (i32 path_count : {16, 256, 4096}) {
+        Queue<v2i16> path{};
+
+        snprintf(name, sizeof(name), "human path %d tiles Queue", path_count);
+        Run_Benchmark(name, 1'000'000 / path_count, [&]() {
+            path.Reset();
+            auto tiles = path.Bulk_Enqueue(path_count, ctx);
+            FOR_RANGE (i32, i, path_count) {
+                tiles[i] = {(i16)i, 0};
+            }
+
+            while (path.count > 0)
+                benchmarks_sink = benchmarks_sink + path.Dequeue().x;
+        });
+
+        Deinit_Queue(path, ctx);
+
+        Memmove_Queue<v2i16> memmove_path{};
+        memmove_path.memory_size = sizeof(v2i16) * path_count;
+        memmove_path.base        = new v2i16[path_count];
+
+        snprintf(name, sizeof(name), "human path %d tiles memmove queue", path_count);
+        Run_Benchmark(name, 1'000'000 / path_count, [&]() {
+            memmove_path.count = 0;
+            FOR_RANGE (i32, i, path_count) {
+                *memmove_path.Enqueue() = {(i16)i, 0};
+            }
+
+            while (memmove_path.count > 0)
+                benchmarks_sink = benchmarks_sink + memmove_path.Dequeue().x;
+        });
+
+        delete[] memmove_path.base;
+
+        Path_Pool  pool{};
+        Human_Path encoded_path{};
+        auto       tiles = new v2i16[path_count];
+        FOR_RANGE (i32, i, path_count) {
+            tiles[i] = {(i16)i, 0};
+        }
+
+        snprintf(name, sizeof(name), "human path %d tiles Path_Pool", path_count);
+        Run_Benchmark(name, 1'000'000 / path_count, [&]() {
+            Free_Path(pool, encoded_path);
+            Encode_Path(pool, encoded_path, tiles, path_count, ctx);
+
+            while (encoded_path.count > 0) {
+                auto tile       = Dequeue_Path_Tile(pool, encoded_path);
+                benchmarks_sink = benchmarks_sink + tile.x;
+            }
+        });
+
+        delete[] tiles;
+        Deinit_Path_Pool(pool, ctx);
+    }
+}
+
+//----------------------------------------------------------------------------------
+// Graphs.
+//----------------------------------------------------------------------------------
+// NOTE: Сегмент-змейка по квадрату `size` x `size` с флагами на концах.
+// Такие длинные сегменты получаются, когда игрок тянет дорогу.
+void Benchmark_Graph_Data() {
+    char name[64];
+
+    Context _ctx{};
+    auto    ctx = &_ctx;
+
+    Arena trash_arena{};
+    trash_arena.size = Megabytes((size_t)16);
+    trash_arena.base = new u8[trash_arena.size];
+
+    for (i16 size : {8, 16, 32, 64}) {
+        Graph graph{};
+        graph.size  = {size, size};
+        graph.nodes = new u8[(size_t)size * size]();
+
+        v2i16 pos = {0, 0};
+        FOR_RANGE (i16, y, size) {
+            FOR_RANGE (i16, i, size - 1) {
+                auto dir = (y % 2 == 0) ? Direction::Right : Direction::Left;
+                Graph_Update(graph, pos, dir, true);
+                pos = pos + As_Offset(dir);
+                Graph_Update(graph, pos, Opposite(dir), true);
+            }
+
+            if (y == size - 1)
+                break;
+
+            Graph_Update(graph, pos, Direction::Up, true);
+            pos = pos + As_Offset(Direction::Up);
+            Graph_Update(graph, pos, Direction::Down, true);
+        }
+
+        v2i16 vertices[] = {{0, 0}, pos};
+
+        snprintf(name, sizeof(name), "Calculate_Graph_Data %d tiles", graph.nodes_count);
+        Run_Benchmark(name, MAX(1, 100'000 / (size * size)), [&]() {
+            Calculate_Graph_Data(graph, vertices, 2, trash_arena, ctx);
+            benchmarks_sink = benchmarks_sink + graph.data->center.x;
+            Deinit_Graph_Data(graph, ctx);
+        });
+
+        delete[] graph.nodes;
+    }
+
+    delete[] trash_arena.base;
+}
+
+//----------------------------------------------------------------------------------
+// Allocators.
+//----------------------------------------------------------------------------------
+// NOTE: Мелкие аллокации одного размера (узлы пути, вершины сегментов).
+// Половина освобождается через одну и аллоцируется снова,
+// чтобы `Bitmapped_Allocator` искал свободные блоки в дырявой битмапе.
+template <typename Allocator_Type>
+void Benchmark_Small_Allocations(
+    const char*     allocator_name,
+    Allocator_Type& allocator,
+    size_t          size,
+    i32             count
+) {
+    char name[64];
+    snprintf(name, sizeof(name), "%d x %d bytes %s", count, (i32)size, allocator_name);
+
+    Blk blks[255] = {};
+    Assert(count <= 255);
+
+    Run_Benchmark(name, 20'000, [&]() {
+        FOR_RANGE (i32, i, count) {
+            blks[i]           = allocator.Allocate(size);
+            *(u8*)blks[i].ptr = (u8)i;
+        }
+        for (i32 i = 0; i < count; i += 2)
+            allocator.Deallocate(blks[i]);
+        for (i32 i = 0; i < count; i += 2) {
+            blks[i]           = allocator.Allocate(size);
+            *(u8*)blks[i].ptr = (u8)i;
+        }
+
+        FOR_RANGE (i32, i, count) {
+            benchmarks_sink = benchmarks_sink + *(u8*)blks[i].ptr;
+            allocator.Deallocate(blks[i]);
+        }
+    });
+}
+
+void Benchmark_Allocators() {
+    Malloc_Allocator malloc_allocator{};
+
+    Bitmapped_Allocator<Malloc_Allocator, 16> bitmapped_16{};
+    Benchmark_Small_Allocations("Bitmapped_Allocator", bitmapped_16, 16, 63);
+    Benchmark_Small_Allocations("Malloc_Allocator", malloc_allocator, 16, 63);
+
+    Bitmapped_Allocator<Malloc_Allocator, 64> bitmapped_64{};
+    Benchmark_Small_Allocations("Bitmapped_Allocator", bitmapped_64, 64, 255);
+    Benchmark_Small_Allocations("Malloc_Allocator", malloc_allocator, 64, 255);
+}
+
+//----------------------------------------------------------------------------------
+// Pages.
+//----------------------------------------------------------------------------------
+// NOTE: Тайлы мира и рабочая память `Find_Path` в виртуальных аренах,
+// как у хоста, на обычных страницах и на transparent huge pages.
+// На больших картах BFS по тайлам упирается в промахи TLB.
+void Benchmark_Huge_Pages() {
+    char name[64];
+
+    Context _ctx{};
+    auto    ctx = &_ctx;
+
+    auto game        = std::make_unique<Game>();
+    auto editor_data = Default_Editor_Data();
+
+    const OS_Virtual_Memory* memories[] = {
+        &linux_virtual_memory,
+        &linux_huge_virtual_memory,
+    };
+    const char* memory_names[] = {"normal pages", "huge pages"};
+
+    for (i16 size : {512, 1024, 2048}) {
+        auto tiles_count = (i32)size * size;
+        auto iterations  = MAX(1, (i32)(16'000'000 / tiles_count));
+
+        FOR_RANGE (int, m, 2) {
+            Arena arena{};
+            Arena trash_arena{};
+            Reserve_Virtual_Arena(arena, *memories[m], Gigabytes((size_t)1), 0);
+            Reserve_Virtual_Arena(trash_arena, *memories[m], Gigabytes((size_t)1), 0);
+
+            auto  world_ = std::make_unique<World>();
+            auto& world  = *world_;
+            world.size   = {size, size};
+            world.terrain_tiles
+                = Allocate_Zeros_Array(arena, Terrain_Tile, tiles_count);
+            world.terrain_resources
+                = Allocate_Zeros_Array(arena, Terrain_Resource, tiles_count);
+            world.element_tiles
+                = Allocate_Zeros_Array(arena, Element_Tile, tiles_count);
+
+            snprintf(
+                name,
+                sizeof(name),
+                "Regenerate_Terrain_Tiles %dx%d %s",
+                size,
+                size,
+                memory_names[m]
+            );
+            Run_Benchmark(name, MAX(1, iterations / 8), [&]() {
+                Regenerate_Terrain_Tiles(
+                    *game, world, arena, trash_arena, 0, editor_data, ctx
+                );
+                benchmarks_sink = benchmarks_sink + world.terrain_tiles[0].height;
+            });
+
+            Path_Find_Workspace workspace{};
+            Init_Path_Find_Workspace(workspace, arena, tiles_count);
+
+            snprintf(
+                name, sizeof(name), "Find_Path %dx%d %s", size, size, memory_names[m]
+            );
+            Run_Benchmark(name, iterations, [&]() {
+                TEMP_USAGE(trash_arena);
+                auto result = Find_Path(
+                    workspace,
+                    trash_arena,
+                    world.size,
+                    world.terrain_tiles,
+                    world.element_tiles,
+                    {0, 0},
+                    {(i16)(size - 1), (i16)(size - 1)},
+                    true
+                );
+                Assert(result.success);
+                benchmarks_sink = benchmarks_sink + result.path_count;
+            });
+
+            Release_Virtual_Arena(trash_arena);
+            Release_Virtual_Arena(arena);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc > 2) {
+        fprintf(stderr, "Usage: %s [name_filter]\n", argv[0]);
+        return -1;
+    }
+
+    if (argc == 2)
+        benchmarks_filter = argv[1];
+
+    root_allocator = (Root_Allocator_Type*)malloc(sizeof(Root_Allocator_Type));
+    std::construct_at(root_allocator);
+
+    Benchmark_Queues();
+    Benchmark_Graph_Data();
+    Benchmark_Allocators();
+    Benchmark_Huge_Pages();
+
+    return 0;
+}
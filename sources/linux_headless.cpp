@@ -0,0 +1,334 @@
+// NOTE: Headless хост симуляции.
+// Гоняет `Update_World` без рендера, ImGui и OpenGL с максимально возможной частотой
+// тиков и выводит, сколько тиков в секунду удалось сделать.
+//
+// Использование:
+//     linux_headless <world_width> <world_height> <ticks> [flat|hierarchical]
+//                    [scalar|columns|timer_wheel] [pipelined] [huge_pages]
+//
+// Необязательные аргументы (в любом порядке) выбирают `Path_Find_Backend`
+// (по умолчанию flat) и `Human_Movement_Backend` (по умолчанию scalar).
+//
+// `huge_pages` кладёт память игры и её арены (в т.ч. тайлы мира)
+// на huge pages, если ядро их даёт (см. `Linux_Map_Game_Memory`).
+//
+// `pipelined` гоняет симуляцию в отдельном потоке с публикацией снапшота
+// каждый тик, а главный поток забирает снапшоты, как это делал бы рендер,
+// и проверяет их целостность (см. `Check_Render_Snapshots`).
+//
+// Ожидает `resources/gamelib.bin` в рабочей директории (как и win32 клиент).
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "bf_base.h"
+#include "bf_game.h"
+
+// NOLINTBEGIN(bugprone-suspicious-include)
+#include "bf_game.cpp"
+#include "bf_jobs.cpp"
+#include "linux_memory.cpp"
+// NOLINTEND(bugprone-suspicious-include)
+
+static_assert(BF_SERVER && !BF_CLIENT);
+
+global_var timespec headless_started_at = {};
+
+void* Linux_Open_File(const char* filename) noexcept {
+    auto file_handle = fopen(filename, "w");
+    Assert(file_handle != nullptr);
+    return file_handle;
+}
+
+void Linux_Write_To_File(void* file_handle, const char* text) noexcept {
+    fprintf((FILE*)file_handle, "%s\n", text);
+    fflush((FILE*)file_handle);
+}
+
+f64 Linux_Get_Time() noexcept {
+    timespec now{};
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    auto result = (f64)(now.tv_sec - headless_started_at.tv_sec)
+                  + (f64)(now.tv_nsec - headless_started_at.tv_nsec) / 1'000'000'000.0;
+    return result;
+}
+
+void Linux_Die() noexcept {
+    exit(-1);
+}
+
+// NOTE: Сетка дорог с флагами на пересечениях.
+// Каждый участок дороги между двумя флагами становится сегментом,
+// на который ратуша отправляет по транспортёру.
+//
+// Тайлы проставляются напрямую, а граф строится за один проход,
+// чтобы не платить за `Update_Tiles` на каждый тайл.
+void Build_Road_Grid(Game& game, i16 step, MCTX) {
+    auto& world = game.world;
+    auto  gsize = world.size;
+
+    FOR_RANGE (i16, y, gsize.y) {
+        FOR_RANGE (i16, x, gsize.x) {
+            auto& tile = *(world.element_tiles + y * gsize.x + x);
+            if (tile.type == Element_Tile_Type::Building)
+                continue;
+
+            if (x % step == 0 && y % step == 0)
+                tile.type = Element_Tile_Type::Flag;
+            else if (x % step == 0 || y % step == 0)
+                tile.type = Element_Tile_Type::Road;
+        }
+    }
+
+    Build_Graph_Segments(
+        world.entities,
+        world.vertex_segments,
+        world.segment_owners,
+        gsize,
+        world.element_tiles,
+        world.segments,
+        game.trash_arena,
+        game.threads_count,
+        [](Graph_Segments_To_Add&, Graph_Segments_To_Delete&, Context*) {},
+        ctx
+    );
+
+    for (auto [id, _] : Iter(&world.segments))
+        *world.segments_wo_humans.Enqueue(ctx) = id;
+}
+
+struct Snapshots_Check_Result {
+    i64 read_count   = {};
+    i64 errors_count = {};
+    u64 last_version = {};
+};
+
+// NOTE: Читатель снапшотов в режиме `pipelined` - то, что делал бы рендер
+// в своём потоке. Проверяет, что снапшоты приходят по порядку, что они целые
+// и что симуляция не пишет в снапшот, пока читатель его держит.
+//
+// Аллокатор не потокобезопасный, поэтому здесь только `std::vector`.
+Snapshots_Check_Result
+Check_Render_Snapshots(Render_Snapshots& snapshots, const std::atomic<bool>& done) {
+    Snapshots_Check_Result result{};
+
+    std::vector<Human_Render_Transform> copy;
+
+    while (true) {
+        // NOTE: Читаем до `Acquire_Render_Snapshot`, чтобы не потерять последний.
+        bool finished = done.load(std::memory_order_acquire);
+
+        if (!Acquire_Render_Snapshot(snapshots)) {
+            if (finished)
+                break;
+
+            std::this_thread::yield();
+            continue;
+        }
+
+        auto& snapshot = snapshots.buffers[snapshots.read];
+        result.read_count++;
+
+        if (snapshot.version <= result.last_version)
+            result.errors_count++;
+        result.last_version = snapshot.version;
+
+        FOR_RANGE (i32, i, snapshot.humans_count) {
+            auto& transform = snapshot.humans[i];
+
+            auto d = abs(transform.to.x - transform.pos.x)
+                     + abs(transform.to.y - transform.pos.y);
+            if (d > 1 || transform.progress < 0 || transform.progress > 1
+                || transform.progress_per_second <= 0)
+            {
+                result.errors_count++;
+            }
+        }
+
+        if (snapshot.humans_count > 0) {
+            auto size = sizeof(Human_Render_Transform) * snapshot.humans_count;
+            copy.assign(snapshot.humans, snapshot.humans + snapshot.humans_count);
+
+            // NOTE: Пока читатель держит снапшот, симуляция успевает сделать пару тиков.
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+
+            if (memcmp(copy.data(), snapshot.humans, size) != 0)
+                result.errors_count++;
+        }
+    }
+
+    return result;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        fprintf(
+            stderr,
+            "Usage: %s <world_width> <world_height> <ticks> [flat|hierarchical] "
+            "[scalar|columns|timer_wheel] [pipelined] [huge_pages]\n",
+            argv[0]
+        );
+        return -1;
+    }
+
+    auto world_width  = atoi(argv[1]);
+    auto world_height = atoi(argv[2]);
+    auto ticks        = atoll(argv[3]);
+
+    auto backend          = Path_Find_Backend::Flat;
+    auto movement_backend = Human_Movement_Backend::Scalar;
+    bool pipelined        = false;
+    bool huge_pages       = false;
+
+    for (int i = 4; i < argc; i++) {
+        if (strcmp(argv[i], "flat") == 0)
+            backend = Path_Find_Backend::Flat;
+        else if (strcmp(argv[i], "hierarchical") == 0)
+            backend = Path_Find_Backend::Hierarchical;
+        else if (strcmp(argv[i], "scalar") == 0)
+            movement_backend = Human_Movement_Backend::Scalar;
+        else if (strcmp(argv[i], "columns") == 0)
+            movement_backend = Human_Movement_Backend::Columns;
+        else if (strcmp(argv[i], "timer_wheel") == 0)
+            movement_backend = Human_Movement_Backend::Timer_Wheel;
+        else if (strcmp(argv[i], "pipelined") == 0)
+            pipelined = true;
+        else if (strcmp(argv[i], "huge_pages") == 0)
+            huge_pages = true;
+        else {
+            fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+            return -1;
+        }
+    }
+
+    // NOTE: `Regenerate_Element_Tiles` расставляет дороги до тайла {13, 9}.
+    if (world_width < 16 || world_height < 12 || world_width > 2048
+        || world_height > 2048 || ticks <= 0)
+    {
+        fprintf(stderr, "Invalid arguments. World must be from 16x12 to 2048x2048\n");
+        return -1;
+    }
+
+    Library_Integration_Data l{};
+    global_library_integration_data = &l;
+
+    l.Open_File     = Linux_Open_File;
+    l.Write_To_File = Linux_Write_To_File;
+    l.Get_Time      = Linux_Get_Time;
+    l.Die           = Linux_Die;
+
+    // NOTE: Арены, размер которых зависит от карты, растут сами,
+    // так что `root_arena` не нужно подгонять под размер мира.
+    l.virtual_memory = huge_pages ? &linux_huge_virtual_memory : &linux_virtual_memory;
+
+    clock_gettime(CLOCK_MONOTONIC, &headless_started_at);
+
+    auto page_backing = Linux_Page_Backing::Normal;
+
+    Arena root_arena{};
+    root_arena.debug_name = "root_arena";
+    root_arena.size       = Megabytes((size_t)64);
+    root_arena.base = Linux_Map_Game_Memory(root_arena.size, huge_pages, page_backing);
+
+    if (root_arena.base == nullptr) {
+        fprintf(stderr, "Could not allocate %zu bytes\n", root_arena.size);
+        return -1;
+    }
+
+    Context _ctx{};
+    auto    ctx = &_ctx;
+
+    Job_System jobs{};
+    Init_Job_System(
+        jobs, MAX(1u, std::thread::hardware_concurrency()), Megabytes((size_t)16), ctx
+    );
+    Set_Job_System(l, jobs);
+
+    auto& memory = *Allocate_For(root_arena, Game_Memory);
+    auto& game   = memory.game;
+
+    root_allocator = Allocate_For(root_arena, Root_Allocator_Type);
+    std::construct_at(root_allocator);
+
+    game.editor_data            = Default_Editor_Data();
+    game.editor_data.world_size = {(i16)world_width, (i16)world_height};
+    Initialize_Game(memory, root_arena, true, ctx);
+    game.world.path_find_backend = backend;
+    Set_Human_Movement_Backend(game.world, movement_backend);
+
+    auto build_started_at = Linux_Get_Time();
+    Build_Road_Grid(game, 4, ctx);
+    auto build_elapsed = Linux_Get_Time() - build_started_at;
+
+    // NOTE: Шаг симуляции фиксированный, но тики идут без ожидания.
+    game.clock   = Default_Simulation_Clock();
+    const f32 dt = Simulation_Tick_Duration(game.clock);
+
+    Snapshots_Check_Result check{};
+
+    auto started_at = Linux_Get_Time();
+    if (pipelined) {
+        game.render_snapshots = Allocate_For(game.arena, Render_Snapshots);
+        Init_Render_Snapshots(*game.render_snapshots);
+
+        // NOTE: Главный поток джобы не запускает, поэтому поток симуляции
+        // может быть воркером 0 вместо него.
+        std::atomic<bool> simulation_done = false;
+        std::thread       simulation([&]() {
+            FOR_RANGE (i64, i, ticks) {
+                TEMP_USAGE(game.trash_arena);
+                Update_World(game, dt, ctx);
+                Publish_World_Snapshot(game, ctx);
+            }
+            simulation_done.store(true, std::memory_order_release);
+        });
+
+        check = Check_Render_Snapshots(*game.render_snapshots, simulation_done);
+        simulation.join();
+    }
+    else {
+        FOR_RANGE (i64, i, ticks) {
+            TEMP_USAGE(game.trash_arena);
+            Update_World(game, dt, ctx);
+        }
+    }
+    auto elapsed = Linux_Get_Time() - started_at;
+
+    printf("world:            %dx%d\n", world_width, world_height);
+    printf(
+        "backend:          %s\n",
+        (backend == Path_Find_Backend::Flat) ? "flat" : "hierarchical"
+    );
+    const char* movement_backend_names[] = {"scalar", "columns", "timer_wheel"};
+    printf("movement:         %s\n", movement_backend_names[(int)movement_backend]);
+    printf("threads:          %u\n", game.threads_count);
+    printf("pages:            %s\n", Linux_Page_Backing_Name(page_backing));
+    printf("graph build time: %.3fs\n", build_elapsed);
+    printf("segments:         %d\n", game.world.segments.count);
+    printf("humans:           %d\n", game.world.humans.count);
+    printf("ticks:            %lld\n", (long long)ticks);
+    printf("simulated time:   %.2fs\n", (f64)ticks * dt);
+    printf("elapsed time:     %.3fs\n", elapsed);
+    printf("ticks per second: %.1f\n", (f64)ticks / elapsed);
+
+    if (pipelined) {
+        printf("snapshots read:   %lld\n", (long long)check.read_count);
+        printf("last version:     %llu\n", (unsigned long long)check.last_version);
+        printf("snapshot errors:  %lld\n", (long long)check.errors_count);
+
+        Deinit_Render_Snapshots(*game.render_snapshots, ctx);
+    }
+
+    Deinit_Job_System(jobs);
+
+    if (check.errors_count > 0 || (pipelined && check.last_version != (u64)ticks))
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,130 @@
+// NOTE: Виртуальная память для linux хостов (`linux_headless`, `linux_benchmarks`).
+// Подключается после `bf_game.cpp`.
+#include <sys/mman.h>
+
+// NOTE: Размер huge page на x86-64.
+#define LINUX_HUGE_PAGE_SIZE Megabytes((size_t)2)
+
+enum class Linux_Page_Backing {
+    Normal,
+    Transparent_Huge,  // NOTE: MADV_HUGEPAGE, huge pages собирает ядро.
+    Huge,              // NOTE: MAP_HUGETLB, заранее выделенные huge pages.
+};
+
+const char* Linux_Page_Backing_Name(Linux_Page_Backing backing) {
+    switch (backing) {
+    case Linux_Page_Backing::Normal:
+        return "normal";
+    case Linux_Page_Backing::Transparent_Huge:
+        return "transparent huge";
+    case Linux_Page_Backing::Huge:
+        return "huge (hugetlb)";
+    }
+    INVALID_PATH;
+    return "";
+}
+
+// NOTE: Зарезервированные страницы недоступны (PROT_NONE) и не считаются
+// в overcommit, пока их не закоммитят через mprotect.
+void* Linux_Reserve_Memory(size_t size) noexcept {
+    auto result = mmap(
+        nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0
+    );
+    return (result == MAP_FAILED) ? nullptr : result;
+}
+
+bool Linux_Commit_Memory(void* address, size_t size) noexcept {
+    return mprotect(address, size, PROT_READ | PROT_WRITE) == 0;
+}
+
+// NOTE: MADV_DONTNEED отдаёт страницы OS, при следующем доступе они будут нулями.
+void Linux_Decommit_Memory(void* address, size_t size) noexcept {
+    madvise(address, size, MADV_DONTNEED);
+    mprotect(address, size, PROT_NONE);
+}
+
+void Linux_Release_Memory(void* address, size_t size) noexcept {
+    munmap(address, size);
+}
+
+global_var const OS_Virtual_Memory linux_virtual_memory = {
+    Linux_Reserve_Memory,
+    Linux_Commit_Memory,
+    Linux_Decommit_Memory,
+    Linux_Release_Memory,
+};
+
+// NOTE: Ядро выдаёт transparent huge page только под 2 MB, доступные целиком,
+// а арены коммитят по 64 KB. Поэтому диапазон сразу доступен на запись,
+// commit ничего не делает (страницы и так появляются при первом обращении),
+// а decommit через MADV_DONTNEED отдаёт их OS.
+// `base` выровнен по huge page, иначе крайние 2 MB останутся обычными страницами.
+void* Linux_Reserve_Huge_Memory(size_t size) noexcept {
+    Assert(size % LINUX_HUGE_PAGE_SIZE == 0);
+
+    auto reserved_size = size + LINUX_HUGE_PAGE_SIZE;
+    auto reserved      = mmap(
+        nullptr,
+        reserved_size,
+        PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+        -1,
+        0
+    );
+    if (reserved == MAP_FAILED)
+        return nullptr;
+
+    auto base = Align_Forward((u8*)reserved, LINUX_HUGE_PAGE_SIZE);
+    auto head = (size_t)(base - (u8*)reserved);
+    auto tail = reserved_size - head - size;
+    if (head > 0)
+        munmap(reserved, head);
+    if (tail > 0)
+        munmap(base + size, tail);
+
+    madvise(base, size, MADV_HUGEPAGE);
+    return base;
+}
+
+bool Linux_Commit_Huge_Memory(void* /* address */, size_t /* size */) noexcept {
+    return true;
+}
+
+void Linux_Decommit_Huge_Memory(void* address, size_t size) noexcept {
+    madvise(address, size, MADV_DONTNEED);
+}
+
+global_var const OS_Virtual_Memory linux_huge_virtual_memory = {
+    Linux_Reserve_Huge_Memory,
+    Linux_Commit_Huge_Memory,
+    Linux_Decommit_Huge_Memory,
+    Linux_Release_Memory,
+};
+
+// NOTE: Блок памяти игры (из него нарезается `root_arena`).
+// С `huge_pages` сначала пробуем явные huge pages - их надо заранее выделить
+// (`/proc/sys/vm/nr_hugepages`), затем transparent huge pages.
+// Если ядро собрано без THP, madvise просто вернёт ошибку, и страницы будут обычными.
+u8* Linux_Map_Game_Memory(size_t size, bool huge_pages, Linux_Page_Backing& backing) {
+    backing = Linux_Page_Backing::Normal;
+
+    const auto prot  = PROT_READ | PROT_WRITE;
+    const auto flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+    if (huge_pages && size % LINUX_HUGE_PAGE_SIZE == 0) {
+        auto result = mmap(nullptr, size, prot, flags | MAP_HUGETLB, -1, 0);
+        if (result != MAP_FAILED) {
+            backing = Linux_Page_Backing::Huge;
+            return (u8*)result;
+        }
+    }
+
+    auto result = mmap(nullptr, size, prot, flags, -1, 0);
+    if (result == MAP_FAILED)
+        return nullptr;
+
+    if (huge_pages && madvise(result, size, MADV_HUGEPAGE) == 0)
+        backing = Linux_Page_Backing::Transparent_Huge;
+
+    return (u8*)result;
+}
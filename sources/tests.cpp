@@ -18,8 +18,13 @@
 
 // NOLINTBEGIN(bugprone-suspicious-include)
 #include "bf_game.cpp"
+#include "bf_jobs.cpp"
 // NOLINTEND(bugprone-suspicious-include)
 
+// NOTE: Построение графа в тестах идёт в несколько потоков,
+// чтобы проверять и многопоточный путь.
+#define TESTS_THREADS_COUNT 4
+
 //----------------------------------------------------------------------------------
 // Memory Setup.
 //----------------------------------------------------------------------------------
@@ -39,6 +44,20 @@ global_var Context _ctx(0, nullptr, nullptr, nullptr, nullptr, nullptr);
         root_allocator = nullptr;                                               \
     }
 
+// NOTE: Джоб система на `TESTS_THREADS_COUNT` воркеров, как у хоста.
+#define INITIALIZE_JOBS                                                         \
+    Job_System jobs{};                                                          \
+    Init_Job_System(jobs, TESTS_THREADS_COUNT, Megabytes((size_t)1), ctx);      \
+                                                                                \
+    Library_Integration_Data library_integration_data{};                        \
+    Set_Job_System(library_integration_data, jobs);                             \
+    global_library_integration_data = &library_integration_data;                \
+                                                                                \
+    defer {                                                                     \
+        Deinit_Job_System(jobs);                                                \
+        global_library_integration_data = nullptr;                              \
+    }
+
 global_var std::vector<u8*> virtual_allocations;
 global_var std::vector<void*> heap_allocations;
 
@@ -138,6 +157,241 @@ TEST_CASE ("Align_Forward") {
     CHECK(Align_Forward((u8*)(8UL), 8) == (u8*)8UL);
 }
 
+TEST_CASE ("Arena, alignment") {
+    u8    memory[512] = {};
+    Arena arena       = {};
+    arena.size        = sizeof(memory) - 1;
+    arena.base        = memory + 1;  // NOTE: Намеренно невыровненный base.
+
+    auto byte = Allocate_Array(arena, u8, 1);
+    CHECK(byte == arena.base);
+
+    {
+        TEMP_USAGE(arena);
+        auto used = arena.used;
+
+        auto value = Allocate_For(arena, u32);
+        CHECK((uintptr_t)value % alignof(u32) == 0);
+
+        auto line = Allocate_Cache_Aligned_Array(arena, u8, 3);
+        CHECK((uintptr_t)line % CACHE_LINE_ALIGNMENT == 0);
+
+        auto simd = Allocate_Zeros_SIMD_Aligned_Array(arena, f32, 8);
+        CHECK((uintptr_t)simd % SIMD_ALIGNMENT == 0);
+        CHECK(simd[7] == 0);
+
+        // NOTE: Padding перед `simd` остаётся занятым после Deallocate.
+        auto used_before_simd = (size_t)((u8*)simd - arena.base);
+        Deallocate_Array(arena, simd, f32, 8);
+        CHECK(arena.used == used_before_simd);
+        CHECK(arena.used > used);
+    }
+    CHECK(arena.used == 1);
+
+    auto doubles = Allocate_Array(arena, f64, 2);
+    CHECK((uintptr_t)doubles % alignof(f64) == 0);
+}
+
+TEST_CASE ("Arena, zero tracking") {
+    u8    memory[256];
+    Arena arena = {};
+    arena.size  = sizeof(memory);
+    arena.base  = memory;
+
+    // NOTE: Про содержимое новой арены ничего не известно.
+    memset(memory, 0xCD, sizeof(memory));
+    CHECK(Allocate_Zeros_Array(arena, u8, 16)[15] == 0);
+
+    Reset_Arena(arena);
+    CHECK(arena.zeroed_size == arena.size);
+    CHECK(memory[255] == 0);
+
+    {
+        TEMP_USAGE(arena);
+        memset(Allocate_Array(arena, u8, 100), 0xAB, 100);
+        CHECK(arena.zeroed_size == 156);
+    }
+    CHECK(arena.zeroed_size == 156);
+
+    // NOTE: Обнуляется только то, куда писали. Хвост намеренно "портим",
+    // чтобы убедиться, что его не трогают.
+    memory[200] = 0xEE;
+    auto values = Allocate_Zeros_Array(arena, u8, 120);
+    CHECK(values[99] == 0);
+    CHECK(values[100] == 0);
+    CHECK(memory[200] == 0xEE);
+
+    Reset_Arena(arena);
+    CHECK(memory[50] == 0);
+    CHECK(memory[119] == 0);
+    CHECK(memory[200] == 0xEE);
+}
+
+// NOTE: Поддельная виртуальная память поверх обычного буфера.
+// Decommit заполняет страницы мусором, чтобы проверить, что их снова не читают.
+#define TESTS_VIRTUAL_MEMORY_SIZE (16 * ARENA_COMMIT_GRANULARITY)
+
+alignas(ARENA_COMMIT_GRANULARITY) global_var u8
+    tests_virtual_memory[TESTS_VIRTUAL_MEMORY_SIZE];
+global_var size_t tests_virtual_memory_committed = 0;
+
+void* Tests_Reserve_Memory(size_t size) noexcept {
+    Assert(size <= TESTS_VIRTUAL_MEMORY_SIZE);
+    return tests_virtual_memory;
+}
+
+bool Tests_Commit_Memory(void* address, size_t size) noexcept {
+    Assert((u8*)address == tests_virtual_memory + tests_virtual_memory_committed);
+    memset(address, 0, size);
+    tests_virtual_memory_committed += size;
+    return true;
+}
+
+void Tests_Decommit_Memory(void* address, size_t size) noexcept {
+    Assert((u8*)address + size == tests_virtual_memory + tests_virtual_memory_committed);
+    memset(address, 0xCD, size);
+    tests_virtual_memory_committed -= size;
+}
+
+void Tests_Release_Memory(void* address, size_t size) noexcept {
+    Assert((u8*)address == tests_virtual_memory);
+    Assert(size <= TESTS_VIRTUAL_MEMORY_SIZE);
+    tests_virtual_memory_committed = 0;
+}
+
+TEST_CASE ("Arena, virtual") {
+    const OS_Virtual_Memory virtual_memory = {
+        Tests_Reserve_Memory,
+        Tests_Commit_Memory,
+        Tests_Decommit_Memory,
+        Tests_Release_Memory,
+    };
+
+    const auto G = ARENA_COMMIT_GRANULARITY;
+
+    Arena arena = {};
+    Reserve_Virtual_Arena(arena, virtual_memory, TESTS_VIRTUAL_MEMORY_SIZE, G);
+    CHECK(arena.committed == 0);
+
+    // NOTE: Память коммитится кусками по мере роста `used`.
+    Allocate_Array(arena, u8, 1);
+    CHECK(arena.committed == G);
+    Allocate_Array(arena, u8, G - 1);
+    CHECK(arena.committed == G);
+    Allocate_Array(arena, u8, 1);
+    CHECK(arena.committed == 2 * G);
+
+    // NOTE: TEMP_USAGE не отдаёт память - это делает только `Trim_Arena`.
+    {
+        TEMP_USAGE(arena);
+        auto big = Allocate_Zeros_Array(arena, u8, 10 * G);
+        CHECK(big[10 * G - 1] == 0);
+        CHECK(arena.committed == 12 * G);
+    }
+    CHECK(arena.committed == 12 * G);
+    CHECK(tests_virtual_memory_committed == 12 * G);
+
+    // NOTE: `used` занимает 2 куска - их `Trim_Arena` оставляет.
+    Trim_Arena(arena);
+    CHECK(arena.committed == 2 * G);
+    CHECK(tests_virtual_memory_committed == 2 * G);
+
+    Reset_Arena(arena);
+    CHECK(arena.used == 0);
+    CHECK(arena.committed == G);
+
+    // NOTE: После сброса память арены снова нулевая, включая перекоммиченную.
+    auto all = Allocate_Array(arena, u8, 4 * G);
+    FOR_RANGE (size_t, i, 4 * G) {
+        if (all[i] != 0) {
+            CHECK(all[i] == 0);
+            break;
+        }
+    }
+
+    auto name = Text_Format_To_Arena(arena, "trash_arena_%d", 3);
+    CHECK(strcmp(name, "trash_arena_3") == 0);
+
+    Release_Virtual_Arena(arena);
+    CHECK(arena.base == nullptr);
+    CHECK(tests_virtual_memory_committed == 0);
+}
+
+// bf_memory.cpp
+//----------------------------------------------------------------------------------
+TEST_CASE ("Bitmapped_Allocator") {
+    // NOTE: 128 блоков по 32 байта, последний - bookkeeping.
+    const size_t B      = 32;
+    const size_t BLOCKS = 127;
+
+    using Allocator_Type = Bitmapped_Allocator<Stack_Allocator<4096>, B>;
+    auto  allocator_     = std::make_unique<Allocator_Type>();
+    auto& allocator      = *allocator_;
+
+    Blk blks[BLOCKS] = {};
+    FOR_RANGE (size_t, i, BLOCKS) {
+        blks[i] = allocator.Allocate(B);
+        REQUIRE(blks[i].ptr != nullptr);
+        CHECK(allocator.Owns(blks[i]));
+        if (i > 0)
+            CHECK((u8*)blks[i].ptr == (u8*)blks[i - 1].ptr + B);
+    }
+    CHECK(allocator.Allocate(1).ptr == nullptr);
+    CHECK(allocator.Occupied_Blocks_Count() == BLOCKS);
+
+    // NOTE: Через блок - одиночные влезают, двойные нет.
+    for (size_t i = 0; i < BLOCKS; i += 2)
+        allocator.Deallocate(blks[i]);
+    CHECK(allocator.Allocate(B + 1).ptr == nullptr);
+
+    auto single = allocator.Allocate(B);
+    CHECK(single.ptr == blks[0].ptr);
+    allocator.Deallocate(single);
+
+    // NOTE: Отрезок через границу u64 слова битмапы.
+    for (size_t i = 59; i < 68; i += 2)
+        allocator.Deallocate(blks[i]);
+    auto run = allocator.Allocate(B * 10);
+    CHECK(run.ptr == blks[58].ptr);
+    CHECK(allocator.Sanity_Check());
+
+    // NOTE: Свободны 58..68 - 11 блоков.
+    allocator.Deallocate(run);
+    CHECK(allocator.Allocate(B * 12).ptr == nullptr);
+    CHECK(allocator.Allocate(B * 11).ptr == blks[58].ptr);
+
+    allocator.Deallocate_All();
+    CHECK(allocator.Occupied_Blocks_Count() == 0);
+
+    auto all = allocator.Allocate(B * BLOCKS);
+    CHECK(all.ptr == blks[0].ptr);
+    CHECK(allocator.Allocate(1).ptr == nullptr);
+    allocator.Deallocate(all);
+
+    // NOTE: Случайные аллокации не должны пересекаться.
+    std::vector<Blk> live;
+    FOR_RANGE (int, step, 10000) {
+        if (!live.empty() && (rand() % 2 == 0)) {
+            auto i   = rand() % live.size();
+            auto blk = live[i];
+            FOR_RANGE (size_t, j, blk.length) {
+                REQUIRE(((u8*)blk.ptr)[j] == (u8)(size_t)blk.ptr);
+            }
+            allocator.Deallocate(blk);
+            live[i] = live.back();
+            live.pop_back();
+            continue;
+        }
+
+        auto blk = allocator.Allocate(1 + rand() % (4 * B));
+        if (blk.ptr != nullptr) {
+            memset(blk.ptr, (u8)(size_t)blk.ptr, blk.length);
+            live.push_back(blk);
+        }
+    }
+    CHECK(allocator.Sanity_Check());
+}
+
 TEST_CASE ("Opposite") {
     CHECK(Opposite(Direction::Right) == Direction::Left);
     CHECK(Opposite(Direction::Up) == Direction::Down);
@@ -172,14 +426,78 @@ std::tuple<Building_ID, Building*> Global_Make_Building(
     auto building        = Allocate_Zeros_For(trash_arena, Building);
     building->scriptable = sb;
     last_entity_id++;
-    return {(Building_ID)last_entity_id, building};
+    return {Building_ID{Make_Entity_ID(last_entity_id, 1)}, building};
+}
+
+// NOTE: Сверяем связи сегментов, индекс вершин
+// и владельцев клеток с полным перебором.
+void Check_Segment_Links(
+    Sparse_Array<Graph_Segment_ID, Graph_Segment>& segments,
+    Vertex_Segments_Index&                         vertex_segments,
+    const Graph_Segment_ID*                        segment_owners,
+    v2i16                                          gsize
+) {
+    u32 vertices_count = 0;
+    u32 edges_count    = 0;
+    for (auto [id1, segment1_p] : Iter(&segments)) {
+        auto& segment1 = *segment1_p;
+        auto& graph    = segment1.graph;
+
+        FOR_RANGE (i16, y, graph.size.y) {
+            FOR_RANGE (i16, x, graph.size.x) {
+                auto node = graph.nodes[y * graph.size.x + x];
+                auto pos  = graph.offset + v2i16(x, y);
+
+                FOR_DIRECTION (dir) {
+                    if (!Graph_Node_Has(node, dir))
+                        continue;
+
+                    auto tile_index = pos.y * gsize.x + pos.x;
+                    CHECK(segment_owners[4 * tile_index + (u8)dir] == id1);
+                    edges_count++;
+                }
+            }
+        }
+
+        FOR_RANGE (i32, i, segment1.vertices_count) {
+            auto entry = Find_Vertex_Segments(vertex_segments, segment1.vertices[i]);
+            REQUIRE(entry != nullptr);
+            CHECK(Array_Find(entry->segments, entry->count, id1) >= 0);
+            vertices_count++;
+        }
+
+        for (auto [id2, segment2_p] : Iter(&segments)) {
+            if (id1 == id2)
+                continue;
+
+            bool linked = segment1.linked_segments.Index_Of(id2) != -1;
+            CHECK(linked == Have_Some_Of_The_Same_Vertices(segment1, *segment2_p));
+        }
+    }
+
+    // NOTE: В индексе нет лишних записей.
+    u32 indexed_count = 0;
+    FOR_RANGE (u32, i, vertex_segments.max_count) {
+        indexed_count += vertex_segments.slots[i].count;
+    }
+    CHECK(indexed_count == vertices_count);
+
+    // NOTE: Владельцы проставлены только у рёбер живых сегментов.
+    u32 owned_count = 0;
+    FOR_RANGE (i32, i, 4 * gsize.x * gsize.y) {
+        owned_count += segment_owners[i] != Graph_Segment_ID_Missing;
+    }
+    CHECK(owned_count == edges_count);
 }
 
 int Process_Segments(
-    Entity_ID&                                      last_entity_id,
+    Entity_Slots&                                   entities,
+    Vertex_Segments_Index&                          vertex_segments,
     v2i&                                            gsize,
     Element_Tile*&                                  element_tiles,
+    Graph_Segment_ID*&                              segment_owners,
     Sparse_Array<Graph_Segment_ID, Graph_Segment>*& segments,
+    Graph_Trace_Workspace&                          graph_trace,
     Arena&                                          trash_arena,
     Building_ID&                                    building_sawmill_id,
     Building*&                                      building_sawmill,
@@ -198,11 +516,18 @@ int Process_Segments(
     auto tiles_count = gsize.x * gsize.y;
     element_tiles    = Allocate_Zeros_Array(trash_arena, Element_Tile, tiles_count);
 
+    segment_owners = Allocate_Array(trash_arena, Graph_Segment_ID, 4 * tiles_count);
+    FOR_RANGE (int, i, 4 * tiles_count) {
+        segment_owners[i] = Graph_Segment_ID_Missing;
+    }
+
     {
         using t  = Sparse_Array<Graph_Segment_ID, Graph_Segment>;
         segments = Allocate_Zeros_For(trash_arena, t);
     }
 
+    Init_Graph_Trace_Workspace(graph_trace, trash_arena, tiles_count);
+
     auto tiles         = Allocate_Zeros_Array(trash_arena, Element_Tile, tiles_count);
     auto Make_Building = [&](Building_Type type, v2i pos) {
         return Global_Make_Building(element_tiles, trash_arena, type, pos);
@@ -261,11 +586,14 @@ int Process_Segments(
 
     // NOTE: Counting segments.
     Build_Graph_Segments(
-        last_entity_id,
+        entities,
+        vertex_segments,
+        segment_owners,
         gsize,
         element_tiles,
         *segments,
         trash_arena,
+        TESTS_THREADS_COUNT,
         [](Graph_Segments_To_Add&, Graph_Segments_To_Delete&, Context*) {},
         ctx
     );
@@ -274,6 +602,8 @@ int Process_Segments(
     for (auto _ : Iter(segments))
         segments_count++;
 
+    Check_Segment_Links(*segments, vertex_segments, segment_owners, gsize);
+
     SANITIZE;
 
     return segments_count;
@@ -282,10 +612,13 @@ int Process_Segments(
 #define Process_Segments_Macro(...)                       \
     std::vector<const char*> _strings = {__VA_ARGS__};    \
     auto(segments_count)              = Process_Segments( \
-        last_entity_id,                      \
+        entities,                            \
+        vertex_segments,                     \
         gsize,                               \
         element_tiles,                       \
+        segment_owners,                      \
         segments,                            \
+        graph_trace,                         \
         trash_arena,                         \
         building_sawmill_id,                 \
         building_sawmill,                    \
@@ -298,31 +631,54 @@ int Process_Segments(
     auto [added_segments_count, removed_segments_count] = Update_Tiles(         \
         gsize,                                                                  \
         element_tiles,                                                          \
+        segment_owners,                                                         \
         segments,                                                               \
+        graph_trace,                                                            \
         trash_arena,                                                            \
+        TESTS_THREADS_COUNT,                                                    \
         (updated_tiles),                                                        \
-        [&segments, &trash_arena, &last_entity_id](                             \
-            Graph_Segments_To_Add&    segments_to_add,                          \
-            Graph_Segments_To_Delete& segments_to_delete,                       \
-            MCTX                                                                \
-        ) {                                                                     \
+        [&segments,                                                             \
+         &trash_arena,                                                          \
+         &entities,                                                             \
+         &vertex_segments,                                                      \
+         &segment_owners,                                                       \
+         &gsize](Graph_Segments_To_Add&    segments_to_add,                     \
+                Graph_Segments_To_Delete& segments_to_delete,                   \
+                MCTX) {                                                         \
             CTX_ALLOCATOR;                                                      \
                                                                                 \
             FOR_RANGE (u32, i, segments_to_delete.count) {                      \
                 auto [id, segment_ptr] = segments_to_delete.items[i];           \
                 auto& segment          = *segment_ptr;                          \
                                                                                 \
+                FOR_RANGE (i32, k, segment.vertices_count) {                    \
+                    Remove_Vertex_Segment(                                      \
+                        vertex_segments, segment.vertices[k], id                \
+                    );                                                          \
+                }                                                               \
+                Set_Segment_Owner(                                              \
+                    segment_owners,                                             \
+                    gsize,                                                      \
+                    segment,                                                    \
+                    id,                                                         \
+                    Graph_Segment_ID_Missing                                    \
+                );                                                              \
                 FREE(segment.vertices, sizeof(v2i16) * segment.vertices_count); \
                 FREE(                                                           \
                     segment.graph.nodes,                                        \
                     sizeof(u8) * segment.graph.nodes_allocation_count           \
                 );                                                              \
+                Deinit_Graph_Data(segment.graph, ctx);                          \
                 segments->Unstable_Remove(id);                                  \
+                Destroy_Entity(entities, id.id, ctx);                           \
             }                                                                   \
                                                                                 \
             FOR_RANGE (u32, i, segments_to_add.count) {                         \
                 Add_And_Link_Segment(                                           \
-                    last_entity_id,                                             \
+                    entities,                                                   \
+                    vertex_segments,                                            \
+                    segment_owners,                                             \
+                    gsize,                                                      \
                     *segments,                                                  \
                     segments_to_add.items[i],                                   \
                     trash_arena,                                                \
@@ -333,7 +689,8 @@ int Process_Segments(
             SANITIZE;                                                           \
         },                                                                      \
         ctx                                                                     \
-    );
+    );                                                                          \
+    Check_Segment_Links(*segments, vertex_segments, segment_owners, gsize);
 
 #define Test_Declare_Updated_Tiles(...)                                            \
     Updated_Tiles updated_tiles{};                                                 \
@@ -399,6 +756,7 @@ TEST_CASE ("Bit operations") {
 
 TEST_CASE ("Update_Tiles") {
     INITIALIZE_CTX;
+    INITIALIZE_JOBS;
 
     SYSTEM_INFO system_info;
     GetSystemInfo(&system_info);
@@ -408,16 +766,20 @@ TEST_CASE ("Update_Tiles") {
     trash_arena.size = trash_size;
     trash_arena.base = new u8[trash_size];
 
-    auto          last_entity_id      = (Entity_ID)0;
-    Building*     building_sawmill    = nullptr;
-    Building_ID   building_sawmill_id = Building_ID_Missing;
-    v2i           gsize               = -v2i_one;
-    Element_Tile* element_tiles       = nullptr;
+    Entity_Slots          entities            = {};
+    Vertex_Segments_Index vertex_segments     = {};
+    Building*             building_sawmill    = nullptr;
+    Building_ID           building_sawmill_id = Building_ID_Missing;
+    v2i                   gsize               = -v2i_one;
+    Element_Tile*         element_tiles       = nullptr;
+    Graph_Segment_ID*     segment_owners      = nullptr;
 
     Sparse_Array<Graph_Segment_ID, Graph_Segment> segments_{};
 
     auto segments = &segments_;
 
+    Graph_Trace_Workspace graph_trace{};
+
     auto Make_Building = [&element_tiles, &trash_arena](Building_Type type, v2i pos) {
         return Global_Make_Building(element_tiles, trash_arena, type, pos);
     };
@@ -905,6 +1267,53 @@ TEST_CASE ("Update_Tiles") {
         CHECK(removed_segments_count == 1);
     }
 
+    SUBCASE("Test_Graph_Data") {
+        Process_Segments_Macro(
+            "..F...",  //
+            "..r...",
+            "FrrrrF"
+        );
+        REQUIRE(segments_count == 1);
+
+        auto& segment = *segments->base;
+        auto& data    = Assert_Deref(segment.graph.data);
+        CHECK(data.center == v2i16(2, 0));
+        REQUIRE(data.vertices_count == 3);
+
+        auto n = segment.graph.nodes_count;
+        REQUIRE(n == 8);
+
+        FOR_RANGE (u16, vertex, data.vertices_count) {
+            auto vertex_pos = segment.vertices[vertex] - segment.graph.offset;
+            auto dist       = data.dist + vertex * n;
+            auto prev       = data.prev + vertex * n;
+
+            FOR_RANGE (u16, i, n) {
+                auto pos = data.node_index_2_pos[i];
+
+                // NOTE: Граф - дерево, так что расстояние - манхэттенское
+                // через перекрёсток (2, 0), если клетки на разных ветках.
+                auto expected = abs(pos.x - vertex_pos.x) + abs(pos.y - vertex_pos.y);
+                if (pos.y != vertex_pos.y && pos.x != vertex_pos.x) {
+                    expected = abs(pos.x - 2) + abs(vertex_pos.x - 2)  //
+                               + pos.y + vertex_pos.y;
+                }
+                CHECK(dist[i] == expected);
+
+                // NOTE: По `prev` доходим до вершины ровно за `dist` шагов.
+                i16 node  = (i16)i;
+                int steps = 0;
+                while (dist[node] > 0) {
+                    CHECK(dist[prev[node]] == dist[node] - 1);
+                    node = prev[node];
+                    steps++;
+                }
+                CHECK(steps == dist[i]);
+                CHECK(data.node_index_2_pos[node] == vertex_pos);
+            }
+        }
+    }
+
     SUBCASE("Test_BuildingPlaced_1") {
         Process_Segments_Macro(
             ".B",  //
@@ -1134,10 +1543,737 @@ TEST_CASE ("Update_Tiles") {
         }
     }
 
+    Deinit_Graph_Trace_Workspace(graph_trace, ctx);
     delete[] trash_arena.base;
     Free_Allocations();
 }
 
+TEST_CASE ("Build_Graph_Segments, threads") {
+    INITIALIZE_CTX;
+    INITIALIZE_JOBS;
+
+    Arena trash_arena{};
+    auto  trash_size = Megabytes((size_t)8);
+    trash_arena.size = trash_size;
+    trash_arena.base = new u8[trash_size];
+
+    const v2i16 gsize{61, 47};
+    const auto  tiles_count = gsize.x * gsize.y;
+
+    auto element_tiles = Allocate_Zeros_Array(trash_arena, Element_Tile, tiles_count);
+
+    // NOTE: Сетка дорог с флагами на перекрёстках,
+    // случайными разрывами, флагами и зданиями.
+    u32  seed   = 12345;
+    auto Random = [&seed]() {
+        seed = seed * 1664525 + 1013904223;
+        return (seed >> 16) % 100;
+    };
+
+    FOR_RANGE (i16, y, gsize.y) {
+        FOR_RANGE (i16, x, gsize.x) {
+            auto& tile = WORLD_PTR_OFFSET(element_tiles, v2i16(x, y));
+            auto  r    = Random();
+
+            if (x % 4 == 0 && y % 4 == 0)
+                tile.type = Element_Tile_Type::Flag;
+            else if (x % 4 == 0 || y % 4 == 0) {
+                if (r < 15)
+                    tile.type = Element_Tile_Type::None;
+                else if (r < 25)
+                    tile.type = Element_Tile_Type::Flag;
+                else
+                    tile.type = Element_Tile_Type::Road;
+            }
+            else if (r < 5)
+                tile.type = Element_Tile_Type::Building;
+            else if (r < 15)
+                tile.type = Element_Tile_Type::Road;
+        }
+    }
+
+    struct Built_Graph {
+        Entity_Slots          entities        = {};
+        Vertex_Segments_Index vertex_segments = {};
+        Graph_Segment_ID*     segment_owners  = {};
+
+        Sparse_Array<Graph_Segment_ID, Graph_Segment> segments = {};
+    };
+
+    auto Build = [&](Built_Graph& built, u32 threads_count) {
+        built.segment_owners
+            = Allocate_Array(trash_arena, Graph_Segment_ID, 4 * tiles_count);
+        FOR_RANGE (int, i, 4 * tiles_count) {
+            built.segment_owners[i] = Graph_Segment_ID_Missing;
+        }
+
+        Build_Graph_Segments(
+            built.entities,
+            built.vertex_segments,
+            built.segment_owners,
+            gsize,
+            element_tiles,
+            built.segments,
+            trash_arena,
+            threads_count,
+            [](Graph_Segments_To_Add&, Graph_Segments_To_Delete&, Context*) {},
+            ctx
+        );
+
+        Check_Segment_Links(
+            built.segments, built.vertex_segments, built.segment_owners, gsize
+        );
+    };
+
+    Built_Graph single{};
+    Built_Graph multi{};
+    Build(single, 1);
+    Build(multi, TESTS_THREADS_COUNT);
+
+    REQUIRE(single.segments.count > 100);
+    REQUIRE(single.segments.count == multi.segments.count);
+
+    CHECK(
+        memcmp(
+            single.segment_owners,
+            multi.segment_owners,
+            sizeof(Graph_Segment_ID) * 4 * tiles_count
+        )
+        == 0
+    );
+
+    FOR_RANGE (i32, i, single.segments.count) {
+        CHECK(single.segments.ids[i] == multi.segments.ids[i]);
+
+        auto& s1 = single.segments.base[i];
+        auto& s2 = multi.segments.base[i];
+
+        REQUIRE(s1.vertices_count == s2.vertices_count);
+        CHECK(memcmp(s1.vertices, s2.vertices, sizeof(v2i16) * s1.vertices_count) == 0);
+
+        auto& g1 = s1.graph;
+        auto& g2 = s2.graph;
+        REQUIRE(g1.size == g2.size);
+        CHECK(g1.offset == g2.offset);
+        REQUIRE(g1.nodes_count == g2.nodes_count);
+        CHECK(memcmp(g1.nodes, g2.nodes, g1.size.x * g1.size.y) == 0);
+
+        auto& d1    = *g1.data;
+        auto& d2    = *g2.data;
+        auto  cells = (size_t)d1.vertices_count * g1.nodes_count;
+        CHECK(d1.center == d2.center);
+        CHECK(memcmp(d1.dist, d2.dist, sizeof(i16) * cells) == 0);
+        CHECK(memcmp(d1.prev, d2.prev, sizeof(i16) * cells) == 0);
+
+        REQUIRE(s1.linked_segments.count == s2.linked_segments.count);
+        FOR_RANGE (i32, k, s1.linked_segments.count) {
+            CHECK(s1.linked_segments.base[k] == s2.linked_segments.base[k]);
+        }
+    }
+
+    delete[] trash_arena.base;
+    Free_Allocations();
+}
+
+TEST_CASE ("Job_System") {
+    INITIALIZE_CTX;
+    INITIALIZE_JOBS;
+
+    auto& l = library_integration_data;
+    REQUIRE(l.jobs_workers_count == TESTS_THREADS_COUNT);
+
+    const u32 count = 10000;
+
+    struct Test_Data {
+        std::atomic<u32> hits[count]   = {};
+        std::atomic<u32> bad_contexts  = {};
+        std::atomic<u32> early_started = {};
+        Job_Counter*     first         = {};
+    };
+    auto data_ = std::make_unique<Test_Data>();
+    auto data  = data_.get();
+
+    SUBCASE ("Every index is processed exactly once") {
+        Job_Counter counter{};
+        l.Jobs_Submit(
+            l.jobs,
+            [](void* data, u32 begin, u32 end, Context* ctx) noexcept {
+                auto& d = *(Test_Data*)data;
+                if (ctx->thread_index >= TESTS_THREADS_COUNT
+                    || ctx->scratch_arena == nullptr)
+                    d.bad_contexts++;
+
+                for (auto i = begin; i < end; i++)
+                    d.hits[i]++;
+            },
+            data,
+            count,
+            16,
+            &counter,
+            nullptr
+        );
+        l.Jobs_Wait(l.jobs, &counter);
+
+        CHECK(counter.value.load() == 0);
+        CHECK(data->bad_contexts.load() == 0);
+        FOR_RANGE (u32, i, count) {
+            CHECK(data->hits[i].load() == 1);
+        }
+    }
+
+    SUBCASE ("Dependent job starts after its dependency") {
+        Job_Counter first{};
+        Job_Counter second{};
+        data->first = &first;
+
+        l.Jobs_Submit(
+            l.jobs,
+            [](void* data, u32 begin, u32 end, Context*) noexcept {
+                auto& d = *(Test_Data*)data;
+                for (auto i = begin; i < end; i++)
+                    d.hits[i]++;
+            },
+            data,
+            count,
+            64,
+            &first,
+            nullptr
+        );
+        l.Jobs_Submit(
+            l.jobs,
+            [](void* data, u32, u32, Context*) noexcept {
+                auto& d = *(Test_Data*)data;
+                if (d.first->value.load() != 0)
+                    d.early_started++;
+            },
+            data,
+            4,
+            1,
+            &second,
+            &first
+        );
+        l.Jobs_Wait(l.jobs, &second);
+        l.Jobs_Wait(l.jobs, &first);
+
+        CHECK(data->early_started.load() == 0);
+    }
+
+    SUBCASE ("Parallel_For") {
+        Parallel_For(
+            TESTS_THREADS_COUNT,
+            count,
+            [data](Context* worker_ctx, u32 i) {
+                if (worker_ctx->thread_index >= TESTS_THREADS_COUNT
+                    || worker_ctx->scratch_arena == nullptr)
+                    data->bad_contexts++;
+                data->hits[i]++;
+            },
+            ctx
+        );
+
+        CHECK(data->bad_contexts.load() == 0);
+        FOR_RANGE (u32, i, count) {
+            CHECK(data->hits[i].load() == 1);
+        }
+    }
+}
+
+TEST_CASE ("Advance_Simulation_Clock") {
+    auto clock = Default_Simulation_Clock();
+    REQUIRE(clock.ticks_per_second == 60);
+
+    SUBCASE ("Ticks do not depend on frame rate") {
+        auto clock_30  = clock;
+        auto clock_144 = clock;
+
+        u32 ticks_30  = 0;
+        u32 ticks_144 = 0;
+        FOR_RANGE (i32, i, 30 * 10) {
+            ticks_30 += Advance_Simulation_Clock(clock_30, 1.0f / 30.0f);
+        }
+        FOR_RANGE (i32, i, 144 * 10) {
+            ticks_144 += Advance_Simulation_Clock(clock_144, 1.0f / 144.0f);
+            CHECK(clock_144.alpha >= 0.0f);
+            CHECK(clock_144.alpha < 1.0f);
+        }
+
+        // NOTE: 10 секунд по 60 тиков, с точностью до накопленной ошибки f32.
+        CHECK(ticks_30 >= 599);
+        CHECK(ticks_30 <= 600);
+        CHECK(ticks_144 >= 599);
+        CHECK(ticks_144 <= 600);
+        CHECK(clock_144.ticks == ticks_144);
+    }
+
+    SUBCASE ("Slow frame catches up at most max_ticks_per_frame") {
+        CHECK(Advance_Simulation_Clock(clock, 1.0f) == clock.max_ticks_per_frame);
+        CHECK(clock.accumulator < 1.0f);
+        CHECK(Advance_Simulation_Clock(clock, 1.0f / 60.0f) <= 1);
+    }
+
+    SUBCASE ("Speed multiplies ticks per frame") {
+        clock.speed = 4;
+
+        u32 ticks = 0;
+        FOR_RANGE (i32, i, 60) {
+            ticks += Advance_Simulation_Clock(clock, 1.0f / 60.0f);
+        }
+        CHECK(ticks >= 239);
+        CHECK(ticks <= 240);
+
+        CHECK(Advance_Simulation_Clock(clock, 1.0f) == clock.max_ticks_per_frame * 4);
+    }
+}
+
+TEST_CASE ("Advance_Human_Movement") {
+    INITIALIZE_CTX;
+
+    // NOTE: Количество не кратно 4 - часть чувачков попадает в скалярный хвост.
+    const i32 count    = 23;
+    const f32 dt       = 1.0f / 60.0f;
+    const f32 duration = 0.37f;
+
+    Human_Movement_Columns columns{};
+
+    f32  elapsed[count]  = {};
+    f32  progress[count] = {};
+    bool moving[count]   = {};
+
+    FOR_RANGE (i32, i, count) {
+        Human human{};
+        human.moving.elapsed  = (f32)i * 0.013f;
+        human.moving.progress = MIN(1.0f, human.moving.elapsed / duration);
+        if (i % 3 != 0)
+            human.moving.to = v2i16{1, 1};
+
+        Add_Human_Movement(columns, human, ctx);
+
+        elapsed[i]  = human.moving.elapsed;
+        progress[i] = human.moving.progress;
+        moving[i]   = human.moving.to.has_value();
+    }
+    REQUIRE(columns.count == count);
+
+    FOR_RANGE (i32, tick, 200) {
+        Advance_Human_Movement(columns, 0, count, dt, duration);
+
+        FOR_RANGE (i32, i, count) {
+            // NOTE: Скалярная арифметика `Update_Human_Moving_Component`.
+            bool crossed = false;
+            if (moving[i]) {
+                elapsed[i] += dt;
+                if (elapsed[i] > duration) {
+                    elapsed[i] -= duration;
+                    crossed = true;
+                }
+                progress[i] = MIN(1.0f, elapsed[i] / duration);
+            }
+
+            CHECK(columns.elapsed[i] == elapsed[i]);
+            CHECK(columns.progress[i] == progress[i]);
+            CHECK((columns.crossed[i] != 0) == crossed);
+        }
+    }
+
+    SUBCASE ("Remove_Human_Movement mirrors Sparse_Array::Unstable_Remove") {
+        Remove_Human_Movement(columns, 2);
+        REQUIRE(columns.count == count - 1);
+        CHECK(columns.elapsed[2] == elapsed[count - 1]);
+        CHECK(columns.progress[2] == progress[count - 1]);
+        CHECK((columns.moving[2] != 0) == moving[count - 1]);
+
+        Remove_Human_Movement(columns, columns.count - 1);
+        REQUIRE(columns.count == count - 2);
+        CHECK(columns.elapsed[columns.count - 1] == elapsed[count - 3]);
+    }
+
+    Deinit_Human_Movement_Columns(columns, ctx);
+}
+
+TEST_CASE ("Human_Timer_Wheel") {
+    INITIALIZE_CTX;
+
+    Human_Timer_Wheel wheel{};
+
+    // NOTE: Начинаем недалеко от границы блоков нескольких уровней.
+    wheel.now = 4000;
+
+    // NOTE: Последний таймер дальше, чем покрывают все уровни колеса.
+    const u64 deltas[] = {1, 2, 63, 64, 65, 95, 96, 4095, 4096, 4097, 300000, 17000000};
+    const i32 count    = sizeof(deltas) / sizeof(deltas[0]);
+
+    FOR_RANGE (i32, i, count) {
+        Add_Human_Timer(wheel, Human_ID{(u32)i + 1}, wheel.now + deltas[i], ctx);
+    }
+
+    // NOTE: Два таймера на один тик.
+    Add_Human_Timer(wheel, Human_ID{(u32)count + 1}, wheel.now + 64, ctx);
+
+    u64 expected[count + 1] = {};
+    FOR_RANGE (i32, i, count) {
+        expected[i] = wheel.now + deltas[i];
+    }
+    expected[count] = wheel.now + 64;
+
+    i32 fired[count + 1] = {};
+    while (wheel.now < expected[count - 1]) {
+        auto timer = Step_Human_Timer_Wheel(wheel);
+        while (timer != 0) {
+            auto [next, id, tick] = wheel.timers[timer];
+            Free_Human_Timer(wheel, timer);
+            timer = next;
+
+            auto i = (i32)id.id - 1;
+            CHECK(tick == wheel.now);
+            CHECK(expected[i] == wheel.now);
+            fired[i]++;
+        }
+    }
+
+    FOR_RANGE (i32, i, count + 1) {
+        CHECK(fired[i] == 1);
+    }
+
+    SUBCASE ("Freed timers are reused") {
+        auto old_count = wheel.count;
+        Add_Human_Timer(wheel, Human_ID{1}, wheel.now + 10, ctx);
+        CHECK(wheel.count == old_count);
+    }
+
+    Deinit_Human_Timer_Wheel(wheel, ctx);
+}
+
+TEST_CASE ("Update_Humans_Parallel") {
+    INITIALIZE_CTX;
+    INITIALIZE_JOBS;
+
+    // NOTE: `resources/gamelib.bin` в тестах нет. Библиотеку из ратуши
+    // и одного ресурса собираем в памяти - симуляции этого хватает.
+    // Ратуша без задержки выпускает по чувачку за тик.
+    flatbuffers::FlatBufferBuilder builder{};
+    std::vector<flatbuffers::Offset<BFGame::Building>> lib_buildings = {
+        BFGame::CreateBuildingDirect(
+            builder, "city_hall", BFGame::Building_Type_City_Hall, 0, 0.0f
+        ),
+    };
+    std::vector<flatbuffers::Offset<BFGame::Resource>> lib_resources = {
+        BFGame::CreateResourceDirect(builder, "planks"),
+    };
+    BFGame::FinishGame_LibraryBuffer(
+        builder, BFGame::CreateGame_LibraryDirect(builder, &lib_buildings, &lib_resources)
+    );
+    auto gamelib = BFGame::GetGame_Library(builder.GetBufferPointer());
+
+    Scriptable_Resource scriptable_resource{};
+    scriptable_resource.code = "planks";
+
+    // NOTE: Сетка дорог, как в `linux_headless`. Сегментов больше,
+    // чем `HUMANS_PARALLEL_MIN_COUNT`, так что чувачков хватит на параллельный путь.
+    const v2i16 gsize       = {64, 64};
+    const i16   grid_step   = 4;
+    const i32   ticks_count = 900;
+
+    const size_t root_size = Megabytes((size_t)32);
+
+    struct Run {
+        u8*          root_base = {};
+        Arena        root      = {};
+        Game_Memory* memory    = {};
+    };
+
+    auto Simulate = [&](Run& run, u32 threads_count, Human_Movement_Backend backend) {
+        run.root_base       = new u8[root_size]();
+        run.root.debug_name = "root_arena";
+        run.root.size       = root_size;
+        run.root.base       = run.root_base;
+
+        run.memory = Allocate_For(run.root, Game_Memory);
+        auto& game = run.memory->game;
+
+        game.editor_data            = Default_Editor_Data();
+        game.editor_data.world_size = gsize;
+
+        // NOTE: Инициализируем как после перезагрузки DLL, чтобы `Initialize_Game`
+        // взял уже загруженную библиотеку, а не читал её с диска.
+        game.gamelib                    = gamelib;
+        game.scriptable_resources       = &scriptable_resource;
+        game.scriptable_resources_count = 1;
+        Initialize_Game(*run.memory, run.root, false, ctx);
+        Set_Human_Movement_Backend(game.world, backend);
+
+        game.threads_count = threads_count;
+
+        auto& world = game.world;
+        FOR_RANGE (i16, y, gsize.y) {
+            FOR_RANGE (i16, x, gsize.x) {
+                auto& tile = *(world.element_tiles + y * gsize.x + x);
+                if (tile.type == Element_Tile_Type::Building)
+                    continue;
+
+                if (x % grid_step == 0 && y % grid_step == 0)
+                    tile.type = Element_Tile_Type::Flag;
+                else if (x % grid_step == 0 || y % grid_step == 0)
+                    tile.type = Element_Tile_Type::Road;
+            }
+        }
+
+        Build_Graph_Segments(
+            world.entities,
+            world.vertex_segments,
+            world.segment_owners,
+            gsize,
+            world.element_tiles,
+            world.segments,
+            game.trash_arena,
+            game.threads_count,
+            [](Graph_Segments_To_Add&, Graph_Segments_To_Delete&, Context*) {},
+            ctx
+        );
+        REQUIRE(world.segments.count > HUMANS_PARALLEL_MIN_COUNT);
+
+        for (auto [id, _] : Iter(&world.segments))
+            *world.segments_wo_humans.Enqueue(ctx) = id;
+
+        game.clock   = Default_Simulation_Clock();
+        const f32 dt = Simulation_Tick_Duration(game.clock);
+        FOR_RANGE (i32, i, ticks_count) {
+            TEMP_USAGE(game.trash_arena);
+            Update_World(game, dt, ctx);
+        }
+    };
+
+    Human_Movement_Backend backends[] = {
+        Human_Movement_Backend::Scalar,
+        Human_Movement_Backend::Columns,
+        Human_Movement_Backend::Timer_Wheel,
+    };
+    for (auto backend : backends) {
+        Run serial{};
+        Run parallel{};
+        defer {
+            delete[] serial.root_base;
+            delete[] parallel.root_base;
+        };
+
+        Simulate(serial, 1, backend);
+        Simulate(parallel, TESTS_THREADS_COUNT, backend);
+
+        auto& a = serial.memory->game.world;
+        auto& b = parallel.memory->game.world;
+
+        REQUIRE(a.humans.count >= HUMANS_PARALLEL_MIN_COUNT);
+        REQUIRE(a.humans.count == b.humans.count);
+        FOR_RANGE (i32, i, a.humans.count) {
+            CHECK(a.humans.ids[i] == b.humans.ids[i]);
+
+            auto& ha = a.humans.base[i];
+            auto& hb = b.humans.base[i];
+            CHECK(ha.moving.pos == hb.moving.pos);
+            CHECK(ha.moving.elapsed == hb.moving.elapsed);
+            CHECK(ha.moving.progress == hb.moving.progress);
+            CHECK(ha.moving.from == hb.moving.from);
+            CHECK(ha.moving.to == hb.moving.to);
+            CHECK(ha.moving.departed_at == hb.moving.departed_at);
+            CHECK(ha.moving.arrives_at == hb.moving.arrives_at);
+            CHECK(ha.player_id == hb.player_id);
+            CHECK(ha.type == hb.type);
+            CHECK(ha.state == hb.state);
+            CHECK(ha.state_moving_in_the_world == hb.state_moving_in_the_world);
+            CHECK(ha.segment_id == hb.segment_id);
+            CHECK(ha.building_id == hb.building_id);
+
+            auto path_a = ha.moving.path;
+            auto path_b = hb.moving.path;
+            REQUIRE(path_a.count == path_b.count);
+            while (path_a.count > 0) {
+                CHECK(
+                    Dequeue_Path_Tile(a.human_paths, path_a)
+                    == Dequeue_Path_Tile(b.human_paths, path_b)
+                );
+            }
+        }
+
+        REQUIRE(a.segments.count == b.segments.count);
+        FOR_RANGE (i32, i, a.segments.count) {
+            auto& sa = a.segments.base[i];
+            auto& sb = b.segments.base[i];
+            CHECK(a.segments.ids[i] == b.segments.ids[i]);
+            CHECK(sa.assigned_human_id == sb.assigned_human_id);
+        }
+
+        REQUIRE(a.segments_wo_humans.count == b.segments_wo_humans.count);
+        FOR_RANGE (i32, i, a.segments_wo_humans.count) {
+            CHECK(a.segments_wo_humans.At(i) == b.segments_wo_humans.At(i));
+        }
+        CHECK(a.humans_going_to_city_hall.count == b.humans_going_to_city_hall.count);
+        CHECK(a.humans_to_remove.count == b.humans_to_remove.count);
+
+        auto& wa = a.human_timers;
+        auto& wb = b.human_timers;
+        CHECK(wa.now == wb.now);
+        CHECK(wa.remainder == wb.remainder);
+        CHECK(wa.count == wb.count);
+        FOR_RANGE (i32, level, HUMAN_TIMER_WHEEL_LEVELS) {
+            FOR_RANGE (i32, slot, HUMAN_TIMER_WHEEL_SLOTS) {
+                auto timer_a = wa.slots[level][slot];
+                auto timer_b = wb.slots[level][slot];
+                while (timer_a != 0 && timer_b != 0) {
+                    CHECK(wa.timers[timer_a].id == wb.timers[timer_b].id);
+                    CHECK(wa.timers[timer_a].tick == wb.timers[timer_b].tick);
+                    timer_a = wa.timers[timer_a].next;
+                    timer_b = wb.timers[timer_b].next;
+                }
+                CHECK(timer_a == 0);
+                CHECK(timer_b == 0);
+            }
+        }
+    }
+}
+
+TEST_CASE ("Render_Snapshots") {
+    INITIALIZE_CTX;
+
+    Render_Snapshots snapshots{};
+    Init_Render_Snapshots(snapshots);
+
+    // NOTE: Писатель публикует снапшоты в своём потоке, читатель забирает их в этом.
+    // Читатель пропускает часть снапшотов, но должен увидеть все помеченные клетки.
+    const i32 versions = 20000;
+    const i32 width    = 64;
+
+    std::atomic<bool> done = false;
+    std::thread       writer([&]() {
+        FOR_RANGE (i32, v, versions) {
+            auto& snapshot = snapshots.buffers[snapshots.write];
+            Reserve_Render_Snapshot_Humans(snapshot, 8, ctx);
+
+            snapshot.humans_count = v % 8;
+            FOR_RANGE (i32, i, snapshot.humans_count) {
+                snapshot.humans[i]          = {};
+                snapshot.humans[i].progress = (f32)snapshot.version;
+            }
+
+            if (v % 3 == 0) {
+                Render_Dirty_Tile tile{};
+                tile.pos = {(i16)(v / 3 % width), (i16)(v / 3 / width)};
+                Add_Render_Snapshot_Dirty_Tile(snapshots, tile, ctx);
+            }
+
+            Publish_Render_Snapshot(snapshots, ctx);
+        }
+        done.store(true, std::memory_order_release);
+    });
+
+    std::vector<bool> seen((versions + 2) / 3, false);
+
+    u64 last_version = 0;
+    i32 read_count   = 0;
+    i32 errors_count = 0;
+    while (true) {
+        bool finished = done.load(std::memory_order_acquire);
+        if (!Acquire_Render_Snapshot(snapshots)) {
+            if (finished)
+                break;
+
+            std::this_thread::yield();
+            continue;
+        }
+
+        auto& snapshot = snapshots.buffers[snapshots.read];
+        read_count++;
+
+        if (snapshot.version <= last_version)
+            errors_count++;
+        last_version = snapshot.version;
+
+        FOR_RANGE (i32, i, snapshot.humans_count) {
+            if (snapshot.humans[i].progress != (f32)snapshot.version)
+                errors_count++;
+        }
+
+        // NOTE: Клетки, перенесённые из непрочитанного снапшота, идут раньше новых.
+        i32 previous = -1;
+        FOR_RANGE (i32, i, snapshot.dirty_tiles_count) {
+            auto pos   = snapshot.dirty_tiles[i].pos;
+            auto index = pos.y * width + pos.x;
+            if (index <= previous)
+                errors_count++;
+
+            previous    = index;
+            seen[index] = true;
+        }
+    }
+
+    writer.join();
+
+    CHECK(read_count > 0);
+    CHECK(errors_count == 0);
+    CHECK(last_version == versions);
+    CHECK(std::find(seen.begin(), seen.end(), false) == seen.end());
+
+    Deinit_Render_Snapshots(snapshots, ctx);
+}
+
+TEST_CASE ("Path_Pool") {
+    INITIALIZE_CTX;
+
+    Path_Pool pool{};
+
+    // NOTE: Змейка - шаги во все 4 стороны, путь длиннее одного блока.
+    const i32 count = PATH_BLOCK_STEPS * 3 + 5;
+    v2i16     tiles[count];
+    tiles[0] = {10, 10};
+    FOR_RANGE (i32, i, count - 1) {
+        v2i16 offsets[] = {{1, 0}, {0, 1}, {1, 0}, {0, -1}, {-1, 0}, {0, 1}};
+        tiles[i + 1]    = tiles[i] + offsets[(i / 3) % 6];
+    }
+
+    Human_Path path{};
+    Encode_Path(pool, path, tiles, count, ctx);
+    REQUIRE(path.count == count);
+
+    SUBCASE ("Tiles are read back in order") {
+        FOR_RANGE (i32, i, count) {
+            CHECK(Dequeue_Path_Tile(pool, path) == tiles[i]);
+        }
+        CHECK(path.count == 0);
+    }
+
+    SUBCASE ("Cursor copy does not affect the path") {
+        auto cursor = path;
+        FOR_RANGE (i32, i, count / 2) {
+            Dequeue_Path_Tile(pool, cursor);
+        }
+
+        CHECK(path.count == count);
+        CHECK(Dequeue_Path_Tile(pool, path) == tiles[0]);
+    }
+
+    SUBCASE ("Freed blocks are reused") {
+        auto used_count = pool.count;
+        Free_Path(pool, path);
+        CHECK(path.count == 0);
+        CHECK(path.first == 0);
+
+        Encode_Path(pool, path, tiles, count, ctx);
+        CHECK(pool.count == used_count);
+
+        FOR_RANGE (i32, i, count) {
+            CHECK(Dequeue_Path_Tile(pool, path) == tiles[i]);
+        }
+    }
+
+    SUBCASE ("Single tile path has no blocks") {
+        Free_Path(pool, path);
+        Encode_Path(pool, path, tiles, 1, ctx);
+        CHECK(path.first == 0);
+        CHECK(Dequeue_Path_Tile(pool, path) == tiles[0]);
+        CHECK(path.count == 0);
+    }
+
+    Deinit_Path_Pool(pool, ctx);
+}
+
 TEST_CASE ("Queue") {
     INITIALIZE_CTX;
 
@@ -1230,9 +2366,296 @@ TEST_CASE ("Queue") {
         REQUIRE(queue.count == 0);
     }
 
+    SUBCASE("Wraps around") {
+        FOR_RANGE (int, i, 6) {
+            *queue.Enqueue(ctx) = i;
+        }
+        FOR_RANGE (int, i, 5) {
+            CHECK(queue.Dequeue() == i);
+        }
+
+        // NOTE: Хвост переходит через конец буфера без реаллокации.
+        FOR_RANGE (int, i, 7) {
+            *queue.Enqueue(ctx) = 6 + i;
+        }
+        REQUIRE(queue.max_count == 8);
+        REQUIRE(queue.count == 8);
+        CHECK(queue.Index_Of(5) == 0);
+        CHECK(queue.Index_Of(12) == 7);
+        CHECK(queue.Index_Of(13) == -1);
+
+        // NOTE: Реаллокация сохраняет порядок.
+        *queue.Enqueue(ctx) = 13;
+        REQUIRE(queue.max_count == 16);
+        FOR_RANGE (int, i, 9) {
+            CHECK(queue.Dequeue() == 5 + i);
+        }
+        REQUIRE(queue.count == 0);
+    }
+
+    SUBCASE("Bulk_Enqueue returns contiguous slots") {
+        FOR_RANGE (int, i, 6) {
+            *queue.Enqueue(ctx) = i;
+        }
+        FOR_RANGE (int, i, 4) {
+            CHECK(queue.Dequeue() == i);
+        }
+
+        int numbers[] = {6, 7, 8, 9};
+        memcpy(queue.Bulk_Enqueue(4, ctx), numbers, sizeof(numbers));
+        REQUIRE(queue.max_count == 8);
+        REQUIRE(queue.count == 6);
+
+        FOR_RANGE (int, i, 6) {
+            CHECK(queue.Dequeue() == 4 + i);
+        }
+    }
+
+    SUBCASE("Remove_At") {
+        FOR_RANGE (int, i, 6) {
+            *queue.Enqueue(ctx) = i;
+        }
+        FOR_RANGE (int, i, 4) {
+            queue.Dequeue();
+        }
+        FOR_RANGE (int, i, 5) {
+            *queue.Enqueue(ctx) = 6 + i;
+        }
+        // NOTE: 4 5 6 7 8 9 10, хвост перешёл через конец буфера.
+        REQUIRE(queue.count == 7);
+
+        queue.Remove_At(1);
+        queue.Remove_At(3);
+        queue.Remove_At(3);
+        queue.Remove_At(0);
+
+        REQUIRE(queue.count == 3);
+        CHECK(queue.Dequeue() == 6);
+        CHECK(queue.Dequeue() == 7);
+        CHECK(queue.Dequeue() == 10);
+    }
+
     Free_Allocations();
 }
 
+TEST_CASE ("Fixed_Size_Queue") {
+    int queue_memory[4];
+
+    Fixed_Size_Queue<int> queue{};
+    queue.max_count = 4;
+    queue.base      = queue_memory;
+
+    int next_enqueued = 0;
+    int next_dequeued = 0;
+    FOR_RANGE (int, i, 10) {
+        while (queue.count < 3)
+            *queue.Enqueue() = next_enqueued++;
+
+        CHECK(queue.Dequeue() == next_dequeued++);
+        CHECK(queue.Dequeue() == next_dequeued++);
+    }
+
+    while (queue.count > 0)
+        CHECK(queue.Dequeue() == next_dequeued++);
+
+    CHECK(next_dequeued == next_enqueued);
+}
+
+TEST_CASE ("Sparse_Array") {
+    INITIALIZE_CTX;
+
+    Sparse_Array<Entity_ID, int> array{};
+
+    // NOTE: Старшие биты - поколение, индекс строится по младшим.
+    const auto mask = Make_Entity_ID(0, 3);
+    FOR_RANGE (u32, i, 100) {
+        auto [id_p, value_p] = array.Add((i + 1) | mask, ctx);
+        *value_p             = (int)i;
+    }
+    REQUIRE(array.count == 100);
+
+    CHECK(*array.Find(1 | mask) == 0);
+    CHECK(*array.Find(100 | mask) == 99);
+    CHECK(array.Find(101 | mask) == nullptr);
+    CHECK(array.Find(100'000 | mask) == nullptr);
+    // NOTE: Индекс совпадает, поколение - нет.
+    CHECK_FALSE(array.Contains(Make_Entity_ID(1, 2)));
+
+    SUBCASE("Unstable_Remove moves the last element") {
+        array.Unstable_Remove(1 | mask);
+        CHECK(array.count == 99);
+        CHECK_FALSE(array.Contains(1 | mask));
+        CHECK(array.ids[0] == (100 | mask));
+        CHECK(*array.Find(100 | mask) == 99);
+
+        array.Unstable_Remove(100 | mask);
+        CHECK_FALSE(array.Contains(100 | mask));
+        CHECK(*array.Find(99 | mask) == 98);
+
+        FOR_RANGE (u32, i, 98) {
+            CHECK(*array.Find((i + 2) | mask) == (int)i + 1);
+        }
+
+        // NOTE: Повторное добавление удалённого id.
+        auto [_, value_p] = array.Add(1 | mask, ctx);
+        *value_p          = -1;
+        CHECK(*array.Find(1 | mask) == -1);
+    }
+
+    SUBCASE("Reset leaves no stale entries") {
+        array.Reset();
+        CHECK_FALSE(array.Contains(1 | mask));
+        CHECK_FALSE(array.Contains(50 | mask));
+
+        auto [_, value_p] = array.Add(50 | mask, ctx);
+        *value_p          = 7;
+        CHECK(*array.Find(50 | mask) == 7);
+        CHECK_FALSE(array.Contains(1 | mask));
+    }
+
+    Sparse_Array_Of_Ids<Entity_ID> ids{};
+    ids.Add(3, ctx);
+    ids.Add(1, ctx);
+    ids.Add(2, ctx);
+    ids.Unstable_Remove(3);
+    CHECK(ids.count == 2);
+    CHECK(ids.Contains(1));
+    CHECK(ids.Contains(2));
+    CHECK_FALSE(ids.Contains(3));
+    CHECK(ids.Pop() == 1);
+    CHECK_FALSE(ids.Contains(1));
+
+    Deinit_Sparse_Array(array, ctx);
+    Deinit_Sparse_Array_Of_Ids(ids, ctx);
+    Free_Allocations();
+}
+
+TEST_CASE ("Entity_Slots") {
+    INITIALIZE_CTX;
+
+    Entity_Slots entities{};
+
+    auto first = Next_Human_ID(entities, ctx);
+    CHECK(first != Human_ID{});
+    CHECK(Entity_Is_Alive(entities, first.id));
+    CHECK_FALSE(Entity_Is_Alive(entities, Entity_ID{}));
+    CHECK_FALSE(Entity_Is_Alive(entities, Entity_ID_Missing));
+
+    auto segment = Next_Graph_Segment_ID(entities, ctx);
+    CHECK(Entity_Index(segment.id) != Entity_Index(first.id));
+
+    Destroy_Entity(entities, first.id, ctx);
+    CHECK_FALSE(Entity_Is_Alive(entities, first.id));
+    CHECK(Entity_Is_Alive(entities, segment.id));
+
+    // NOTE: Слоты переиспользуются, только когда свободных накопится достаточно.
+    auto second = Next_Human_ID(entities, ctx);
+    CHECK(Entity_Index(second.id) != Entity_Index(first.id));
+    Destroy_Entity(entities, second.id, ctx);
+
+    while (entities.free.count < ENTITY_SLOTS_MIN_FREE)
+        Destroy_Entity(entities, Next_Human_ID(entities, ctx).id, ctx);
+
+    auto reused = Next_Human_ID(entities, ctx);
+    CHECK(Entity_Index(reused.id) == Entity_Index(first.id));
+    CHECK(Entity_Generation(reused.id) == Entity_Generation(first.id) + 1);
+    CHECK(Entity_Is_Alive(entities, reused.id));
+    CHECK_FALSE(Entity_Is_Alive(entities, first.id));
+
+    // NOTE: Протухший хендл не находится в `Sparse_Array`.
+    Sparse_Array<Human_ID, int> humans{};
+    *std::get<1>(humans.Add(reused, ctx)) = 42;
+    CHECK(humans.Find(first) == nullptr);
+    CHECK(*humans.Find(reused) == 42);
+
+    // NOTE: Поколение переполняется, пропуская 0.
+    auto index = Entity_Index(reused.id);
+    FOR_RANGE (i32, i, 1 << ENTITY_GENERATION_BITS) {
+        auto id = Make_Entity_ID(index, entities.generations[index]);
+        Destroy_Entity(entities, id, ctx);
+        CHECK(entities.generations[index] != 0);
+    }
+
+    Deinit_Sparse_Array(humans, ctx);
+    Deinit_Entity_Slots(entities, ctx);
+    Free_Allocations();
+}
+
+TEST_CASE ("Fixed_Size_Binary_Heap") {
+    int heap_memory[16];
+
+    Fixed_Size_Binary_Heap<int> heap{};
+    heap.memory_size = sizeof(heap_memory);
+    heap.base        = heap_memory;
+
+    int numbers[] = {5, 3, 9, 1, 7, 3, 8, 2, 6, 4, 0};
+    for (auto number : numbers)
+        heap.Push(number);
+
+    REQUIRE(heap.count == 11);
+    CHECK(heap.Pop() == 0);
+    CHECK(heap.Pop() == 1);
+    CHECK(heap.Pop() == 2);
+    CHECK(heap.Pop() == 3);
+    CHECK(heap.Pop() == 3);
+
+    heap.Push(-1);
+    CHECK(heap.Pop() == -1);
+    CHECK(heap.Pop() == 4);
+    CHECK(heap.Pop() == 5);
+    CHECK(heap.Pop() == 6);
+    CHECK(heap.Pop() == 7);
+    CHECK(heap.Pop() == 8);
+    CHECK(heap.Pop() == 9);
+    CHECK(heap.count == 0);
+}
+
+TEST_CASE ("Indexed_Binary_Heap") {
+    struct Node {
+        i32 key = {};
+        u32 id  = {};
+
+        bool operator<(const Node& other) const {
+            return key < other.key;
+        }
+    };
+
+    const i32 count = 8;
+
+    Node heap_memory[count];
+    i32  positions[count];
+
+    Indexed_Binary_Heap<Node> heap{};
+    heap.max_count = count;
+    heap.base      = heap_memory;
+    heap.positions = positions;
+
+    i32 keys[count] = {50, 30, 90, 10, 70, 80, 20, 60};
+    FOR_RANGE (i32, i, count) {
+        heap.Push({keys[i], (u32)i});
+    }
+    REQUIRE(heap.count == count);
+
+    // NOTE: Уменьшаем ключи у узлов из середины и с конца кучи.
+    heap.Decrease({5, 2});
+    heap.Decrease({25, 7});
+    heap.Decrease({10, 4});
+
+    CHECK(heap.Pop().id == 2);
+    auto node = heap.Pop();
+    CHECK(node.key == 10);
+    CHECK(node.id != 2);
+    CHECK(heap.Pop().key == 10);
+    CHECK(heap.Pop().id == 6);
+
+    heap.Decrease({1, 5});
+    CHECK(heap.Pop().id == 5);
+    CHECK(heap.Pop().id == 7);
+    CHECK(heap.Pop().id == 1);
+    CHECK(heap.Pop().id == 0);
+    CHECK(heap.count == 0);
+}
+
 TEST_CASE ("Array functions") {
     const auto max_count = 10;
     int        arr_arr[max_count];
@@ -1253,6 +2676,10 @@ TEST_CASE ("Array functions") {
     CHECK(*(arr + 2) == 3);
     CHECK(*(arr + 3) == 4);
     CHECK(*(arr + 4) == 5);
+
+    CHECK(Array_Find(arr, count, 1) == 0);
+    CHECK(Array_Find(arr, count, 4) == 3);
+    CHECK(Array_Find(arr, count, 6) == -1);
 }
 
 TEST_CASE ("Longest_Meaningful_Path") {
@@ -1267,6 +2694,483 @@ TEST_CASE ("Longest_Meaningful_Path") {
     CHECK(Longest_Meaningful_Path({5, 5}) == 17);
 }
 
+TEST_CASE ("Find_Path") {
+    Arena trash_arena{};
+    auto  trash_size = Megabytes((size_t)1);
+    trash_arena.size = trash_size;
+    trash_arena.base = new u8[trash_size];
+    defer {
+        delete[] trash_arena.base;
+    };
+
+    const v2i16  gsize = {8, 3};
+    Terrain_Tile terrain_tiles[8 * 3]{};
+    Element_Tile element_tiles[8 * 3]{};
+
+    Arena workspace_arena{};
+    auto  workspace_size = Kilobytes((size_t)64);
+    workspace_arena.size = workspace_size;
+    workspace_arena.base = new u8[workspace_size];
+    defer {
+        delete[] workspace_arena.base;
+    };
+
+    Path_Find_Workspace workspace{};
+    Init_Path_Find_Workspace(workspace, workspace_arena, gsize.x * gsize.y);
+
+    auto Path_Cost = [&](Path_Find_Result& result) {
+        i32 cost = 0;
+        FOR_RANGE (i32, i, result.path_count - 1) {
+            auto pos  = result.path[i + 1];
+            auto prev = result.path[i];
+            CHECK(abs(pos.x - prev.x) + abs(pos.y - prev.y) == 1);
+
+            cost += Path_Tile_Cost(
+                WORLD_PTR_OFFSET(terrain_tiles, pos), WORLD_PTR_OFFSET(element_tiles, pos)
+            );
+        }
+        return cost;
+    };
+
+    SUBCASE("Same tile") {
+        auto result = Find_Path(
+            workspace,
+            trash_arena,
+            gsize,
+            terrain_tiles,
+            element_tiles,
+            {1, 1},
+            {1, 1},
+            true
+        );
+        CHECK(result.success);
+        CHECK(result.path_count == 0);
+    }
+
+    SUBCASE("Straight line") {
+        auto result = Find_Path(
+            workspace,
+            trash_arena,
+            gsize,
+            terrain_tiles,
+            element_tiles,
+            {0, 1},
+            {4, 1},
+            true
+        );
+        REQUIRE(result.success);
+        REQUIRE(result.path_count == 5);
+        CHECK(result.path[0] == v2i16(0, 1));
+        CHECK(result.path[4] == v2i16(4, 1));
+        CHECK(Path_Cost(result) == 4 * PATH_COST_DEFAULT);
+    }
+
+    SUBCASE("Prefers roads") {
+        // ........
+        // rrrrrrrr
+        // S......D
+        FOR_RANGE (i16, x, gsize.x) {
+            WORLD_PTR_OFFSET(element_tiles, v2i16(x, 1)).type = Element_Tile_Type::Road;
+        }
+
+        auto result = Find_Path(
+            workspace,
+            trash_arena,
+            gsize,
+            terrain_tiles,
+            element_tiles,
+            {0, 0},
+            {7, 0},
+            true
+        );
+        REQUIRE(result.success);
+        CHECK(result.path_count == 10);
+        CHECK(Path_Cost(result) == PATH_COST_ROAD * 8 + PATH_COST_DEFAULT);
+    }
+
+    SUBCASE("Goes around cliffs") {
+        // .....
+        // S.c.D
+        // ..c..
+        WORLD_PTR_OFFSET(terrain_tiles, v2i16(2, 0)).is_cliff = true;
+        WORLD_PTR_OFFSET(terrain_tiles, v2i16(2, 1)).is_cliff = true;
+
+        auto result = Find_Path(
+            workspace,
+            trash_arena,
+            gsize,
+            terrain_tiles,
+            element_tiles,
+            {0, 1},
+            {4, 1},
+            true
+        );
+        REQUIRE(result.success);
+        CHECK(result.path_count == 7);
+        CHECK(Path_Cost(result) == 6 * PATH_COST_DEFAULT);
+    }
+
+    SUBCASE("Avoids harvestable resources") {
+        // .....
+        // .....
+        // S.R.D
+        WORLD_PTR_OFFSET(terrain_tiles, v2i16(2, 0)).resource_amount = 1;
+
+        auto result = Find_Path(
+            workspace,
+            trash_arena,
+            gsize,
+            terrain_tiles,
+            element_tiles,
+            {0, 0},
+            {4, 0},
+            true
+        );
+        REQUIRE(result.success);
+        CHECK(result.path_count == 7);
+
+        auto result_through = Find_Path(
+            workspace,
+            trash_arena,
+            gsize,
+            terrain_tiles,
+            element_tiles,
+            {0, 0},
+            {4, 0},
+            false
+        );
+        REQUIRE(result_through.success);
+        CHECK(result_through.path_count == 5);
+    }
+
+    SUBCASE("Workspace is reused between queries") {
+        FOR_RANGE (int, i, 3) {
+            auto result = Find_Path(
+                workspace,
+                trash_arena,
+                gsize,
+                terrain_tiles,
+                element_tiles,
+                {0, 0},
+                {7, 2},
+                true
+            );
+            REQUIRE(result.success);
+            CHECK(result.path_count == 10);
+            trash_arena.used = 0;
+        }
+
+        // NOTE: Переполнение счётчика поколений.
+        workspace.generation = u32_max - 3;
+        FOR_RANGE (int, i, 3) {
+            auto result = Find_Path(
+                workspace,
+                trash_arena,
+                gsize,
+                terrain_tiles,
+                element_tiles,
+                {7, 2},
+                {0, 0},
+                true
+            );
+            REQUIRE(result.success);
+            CHECK(result.path_count == 10);
+            CHECK(result.path[0] == v2i16(7, 2));
+            CHECK(result.path[9] == v2i16(0, 0));
+            trash_arena.used = 0;
+        }
+        CHECK(workspace.generation < 10);
+    }
+
+    SUBCASE("Unreachable") {
+        // .R...
+        // .R...
+        // SR..D
+        FOR_RANGE (i16, y, gsize.y) {
+            WORLD_PTR_OFFSET(terrain_tiles, v2i16(1, y)).resource_amount = 1;
+        }
+
+        auto result = Find_Path(
+            workspace,
+            trash_arena,
+            gsize,
+            terrain_tiles,
+            element_tiles,
+            {0, 0},
+            {4, 0},
+            true
+        );
+        CHECK_FALSE(result.success);
+    }
+}
+
+TEST_CASE ("Flow_Field") {
+    Arena trash_arena{};
+    auto  trash_size = Megabytes((size_t)1);
+    trash_arena.size = trash_size;
+    trash_arena.base = new u8[trash_size];
+    defer {
+        delete[] trash_arena.base;
+    };
+
+    const v2i16  gsize = {8, 3};
+    Terrain_Tile terrain_tiles[8 * 3]{};
+    Element_Tile element_tiles[8 * 3]{};
+
+    Arena workspace_arena{};
+    auto  workspace_size = Kilobytes((size_t)64);
+    workspace_arena.size = workspace_size;
+    workspace_arena.base = new u8[workspace_size];
+    defer {
+        delete[] workspace_arena.base;
+    };
+
+    Path_Find_Workspace workspace{};
+    Init_Path_Find_Workspace(workspace, workspace_arena, gsize.x * gsize.y);
+
+    Flow_Field field{};
+    Init_Flow_Field(field, workspace_arena, gsize.x * gsize.y);
+
+    auto Path_Cost = [&](Path_Find_Result& result) {
+        i32 cost = 0;
+        FOR_RANGE (i32, i, result.path_count - 1) {
+            auto pos  = result.path[i + 1];
+            auto prev = result.path[i];
+            CHECK(abs(pos.x - prev.x) + abs(pos.y - prev.y) == 1);
+
+            cost += Path_Tile_Cost(
+                WORLD_PTR_OFFSET(terrain_tiles, pos), WORLD_PTR_OFFSET(element_tiles, pos)
+            );
+        }
+        return cost;
+    };
+
+    // ........
+    // .RRRRRR.
+    // ..C..R.D
+    FOR_RANGE (i16, x, 6) {
+        WORLD_PTR_OFFSET(element_tiles, v2i16(x + 1, 1)).type = Element_Tile_Type::Road;
+    }
+    WORLD_PTR_OFFSET(element_tiles, v2i16(5, 0)).type = Element_Tile_Type::Road;
+    WORLD_PTR_OFFSET(terrain_tiles, v2i16(2, 0)).is_cliff = true;
+
+    SUBCASE("Matches Find_Path costs") {
+        v2i16 destination = {7, 0};
+        Build_Flow_Field(
+            field, workspace, gsize, terrain_tiles, element_tiles, &destination, 1
+        );
+
+        FOR_RANGE (i16, y, gsize.y) {
+            FOR_RANGE (i16, x, gsize.x) {
+                v2i16 source = {x, y};
+
+                auto expected = Find_Path(
+                    workspace,
+                    trash_arena,
+                    gsize,
+                    terrain_tiles,
+                    element_tiles,
+                    source,
+                    destination,
+                    true
+                );
+                auto result = Flow_Field_Path(field, trash_arena, gsize, source);
+
+                REQUIRE(result.success == expected.success);
+                CHECK(result.path_count == expected.path_count);
+                CHECK(WORLD_PTR_OFFSET(field.dist, source) == Path_Cost(expected));
+                CHECK(Path_Cost(result) == Path_Cost(expected));
+
+                if (result.path_count > 0) {
+                    CHECK(result.path[0] == source);
+                    CHECK(result.path[result.path_count - 1] == destination);
+                }
+            }
+        }
+    }
+
+    SUBCASE("Nearest of several sources") {
+        v2i16 sources[] = {{0, 0}, {7, 2}};
+        Build_Flow_Field(
+            field, workspace, gsize, terrain_tiles, element_tiles, sources, 2
+        );
+
+        auto result = Flow_Field_Path(field, trash_arena, gsize, {1, 0});
+        REQUIRE(result.success);
+        CHECK(result.path_count == 2);
+        CHECK(result.path[1] == v2i16(0, 0));
+
+        result = Flow_Field_Path(field, trash_arena, gsize, {6, 1});
+        REQUIRE(result.success);
+        CHECK(result.path[result.path_count - 1] == v2i16(7, 2));
+
+        result = Flow_Field_Path(field, trash_arena, gsize, {7, 2});
+        CHECK(result.success);
+        CHECK(result.path_count == 0);
+    }
+
+    SUBCASE("Unreachable") {
+        // .R......
+        // .R......
+        // SR.....D
+        FOR_RANGE (i16, y, gsize.y) {
+            WORLD_PTR_OFFSET(terrain_tiles, v2i16(1, y)).resource_amount = 1;
+        }
+
+        v2i16 destination = {7, 0};
+        Build_Flow_Field(
+            field, workspace, gsize, terrain_tiles, element_tiles, &destination, 1
+        );
+
+        CHECK_FALSE(Flow_Field_Path(field, trash_arena, gsize, {0, 0}).success);
+        CHECK_FALSE(Flow_Field_Path(field, trash_arena, gsize, {0, 2}).success);
+
+        // NOTE: С тайла с ресурсом уйти можно, зайти на него - нельзя.
+        CHECK(Flow_Field_Path(field, trash_arena, gsize, {1, 0}).success);
+    }
+}
+
+TEST_CASE ("Find_Path_Hierarchical") {
+    Arena trash_arena{};
+    auto  trash_size = Megabytes((size_t)1);
+    trash_arena.size = trash_size;
+    trash_arena.base = new u8[trash_size];
+    defer {
+        delete[] trash_arena.base;
+    };
+
+    Arena arena{};
+    auto  arena_size = Megabytes((size_t)2);
+    arena.size       = arena_size;
+    arena.base       = new u8[arena_size];
+    defer {
+        delete[] arena.base;
+    };
+
+    // NOTE: Размеры не кратны `PATH_CLUSTER_SIZE`.
+    const v2i16 gsize       = {40, 35};
+    const i32   tiles_count = gsize.x * gsize.y;
+
+    auto terrain_tiles = Allocate_Zeros_Array(arena, Terrain_Tile, tiles_count);
+    auto element_tiles = Allocate_Zeros_Array(arena, Element_Tile, tiles_count);
+
+    srand(42);
+    FOR_RANGE (i32, i, tiles_count) {
+        auto value = frand();
+        if (value < 0.2f)
+            terrain_tiles[i].resource_amount = 1;
+        else if (value < 0.3f)
+            terrain_tiles[i].is_cliff = true;
+        else if (value < 0.5f)
+            element_tiles[i].type = Element_Tile_Type::Road;
+    }
+
+    Path_Find_Workspace workspace{};
+    Init_Path_Find_Workspace(workspace, arena, tiles_count);
+
+    Path_Hierarchy hierarchy{};
+    Init_Path_Hierarchy(hierarchy, arena, gsize);
+
+    auto Check_Path = [&](Path_Find_Result& result, v2i16 source, v2i16 destination) {
+        i32 cost = 0;
+        if (result.path_count == 0)
+            return cost;
+
+        CHECK(result.path[0] == source);
+        CHECK(result.path[result.path_count - 1] == destination);
+
+        FOR_RANGE (i32, i, result.path_count - 1) {
+            auto pos  = result.path[i + 1];
+            auto prev = result.path[i];
+            CHECK(abs(pos.x - prev.x) + abs(pos.y - prev.y) == 1);
+            CHECK(WORLD_PTR_OFFSET(terrain_tiles, pos).resource_amount == 0);
+
+            cost += Path_Tile_Cost(
+                WORLD_PTR_OFFSET(terrain_tiles, pos), WORLD_PTR_OFFSET(element_tiles, pos)
+            );
+        }
+        return cost;
+    };
+
+    auto Check_Against_Flat_Search = [&]() {
+        FOR_RANGE (i32, i, 300) {
+            TEMP_USAGE(trash_arena);
+
+            v2i16 source      = {rand() % gsize.x, rand() % gsize.y};
+            v2i16 destination = {rand() % gsize.x, rand() % gsize.y};
+
+            auto expected = Find_Path(
+                workspace,
+                trash_arena,
+                gsize,
+                terrain_tiles,
+                element_tiles,
+                source,
+                destination,
+                true
+            );
+            auto result = Find_Path_Hierarchical(
+                hierarchy,
+                workspace,
+                trash_arena,
+                gsize,
+                terrain_tiles,
+                element_tiles,
+                source,
+                destination
+            );
+
+            REQUIRE(result.success == expected.success);
+            if (!result.success)
+                continue;
+
+            auto expected_cost = Check_Path(expected, source, destination);
+            auto cost          = Check_Path(result, source, destination);
+            CHECK(cost >= expected_cost);
+        }
+    };
+
+    SUBCASE("Matches flat search reachability") {
+        Check_Against_Flat_Search();
+    }
+
+    SUBCASE("Incremental cluster updates") {
+        Check_Against_Flat_Search();
+
+        // NOTE: Меняем тайлы на границах и внутри кластеров.
+        v2i16 changed[] = {{15, 3}, {16, 3}, {5, 15}, {5, 16}, {15, 15}, {30, 20}};
+        for (auto pos : changed) {
+            auto& terrain_tile           = WORLD_PTR_OFFSET(terrain_tiles, pos);
+            terrain_tile.resource_amount = (terrain_tile.resource_amount > 0) ? 0 : 1;
+            Mark_Path_Clusters_Dirty(hierarchy, pos);
+        }
+
+        Check_Against_Flat_Search();
+
+        // NOTE: Обновлённые кластеры совпадают с посчитанными с нуля.
+        Path_Hierarchy fresh{};
+        Init_Path_Hierarchy(fresh, arena, gsize);
+        Update_Path_Hierarchy(fresh, workspace, gsize, terrain_tiles, element_tiles);
+
+        auto clusters_count = fresh.clusters_size.x * fresh.clusters_size.y;
+        FOR_RANGE (i32, i, clusters_count) {
+            auto& a = hierarchy.clusters[i];
+            auto& b = fresh.clusters[i];
+            REQUIRE(a.nodes_count == b.nodes_count);
+
+            FOR_RANGE (i32, k, a.nodes_count) {
+                CHECK(a.nodes[k].pos == b.nodes[k].pos);
+                CHECK(a.nodes[k].exits == b.nodes[k].exits);
+
+                FOR_RANGE (i32, j, a.nodes_count) {
+                    auto index = k * PATH_CLUSTER_MAX_NODES + j;
+                    CHECK(a.costs[index] == b.costs[index]);
+                }
+            }
+        }
+    }
+}
+
 TEST_CASE ("Rect_Copy") {
     u8 dest[5] = {0};
 
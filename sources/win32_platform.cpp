@@ -6,6 +6,7 @@
 #    define WIN32_LEAN_AND_MEAN
 #endif
 
+#include <bit>
 #include <cmath>
 #include <iostream>
 #include <source_location>
@@ -36,6 +37,7 @@ global_var Library_Integration_Data* global_library_integration_data = {};
 #include "bf_file.cpp"
 #include "bf_log.cpp"
 #include "bf_memory.cpp"
+#include "bf_jobs.cpp"
 
 #include "bfc_opengl.cpp"
 // NOLINTEND(bugprone-suspicious-include)
@@ -451,6 +453,30 @@ void Win32_Die() noexcept {
     exit(-1);
 }
 
+void* Win32_Reserve_Memory(size_t size) noexcept {
+    return VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+bool Win32_Commit_Memory(void* address, size_t size) noexcept {
+    return VirtualAlloc(address, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+}
+
+void Win32_Decommit_Memory(void* address, size_t size) noexcept {
+    VirtualFree(address, size, MEM_DECOMMIT);
+}
+
+// NOTE: MEM_RELEASE освобождает весь зарезервированный диапазон, size должен быть 0.
+void Win32_Release_Memory(void* address, size_t /* size */) noexcept {
+    VirtualFree(address, 0, MEM_RELEASE);
+}
+
+global_var const OS_Virtual_Memory win32_virtual_memory = {
+    Win32_Reserve_Memory,
+    Win32_Commit_Memory,
+    Win32_Decommit_Memory,
+    Win32_Release_Memory,
+};
+
 struct Window_Info : public Equatable<Window_Info> {
     i32 width;
     i32 height;
@@ -835,6 +861,8 @@ static int WinMain(
     global_library_integration_data->Get_Time      = Win32_Get_Time;
     global_library_integration_data->Die           = Win32_Die;
 
+    global_library_integration_data->virtual_memory = &win32_virtual_memory;
+
     initial_game_memory_arena.size = Megabytes(64LL);
     initial_game_memory_arena.base = (u8*)VirtualAlloc(
         nullptr,
@@ -853,6 +881,13 @@ static int WinMain(
     SET_LOGGER;
     CTX_LOGGER;
 
+    // NOTE: Воркеры джоб системы принадлежат хосту и переживают перезагрузку DLL.
+    Job_System jobs{};
+    Init_Job_System(
+        jobs, MAX(1u, std::thread::hardware_concurrency()), Megabytes((size_t)16), ctx
+    );
+    Set_Job_System(*global_library_integration_data, jobs);
+
     perf_counter_frequency  = Win32Frequency();
     perf_counter_started_at = Win32Clock();
 
@@ -1267,6 +1302,8 @@ static int WinMain(
     if (xaudio)
         xaudio->Release();
 
+    Deinit_Job_System(jobs);
+
     return 0;
 }
 // NOLINTEND(clang-analyzer-core.StackAddressEscape)